@@ -0,0 +1,27 @@
+# - Try to find Zstandard
+# Once done this will define
+#  ZSTD_FOUND - System has zstd
+#  ZSTD_INCLUDE_DIRS - The zstd include directories
+#  ZSTD_LIBRARIES - The libraries needed to use zstd
+
+find_package(PkgConfig)
+if (PKG_CONFIG_FOUND)
+  pkg_check_modules(PC_ZSTD QUIET libzstd)
+endif()
+
+find_path(ZSTD_INCLUDE_DIR zstd.h
+          PATHS ${PC_ZSTD_INCLUDEDIR} ${PC_ZSTD_INCLUDE_DIRS})
+
+find_library(ZSTD_LIBRARY NAMES zstd
+  HINTS ${PC_ZSTD_LIBDIR} ${PC_ZSTD_LIBRARY_DIRS})
+
+set(ZSTD_LIBRARIES ${ZSTD_LIBRARY})
+set(ZSTD_INCLUDE_DIRS ${ZSTD_INCLUDE_DIR})
+
+include(FindPackageHandleStandardArgs)
+# handle the QUIETLY and REQUIRED arguments and set ZSTD_FOUND to TRUE
+# if all listed variables are TRUE
+find_package_handle_standard_args(Zstd DEFAULT_MSG
+  ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
+
+mark_as_advanced(ZSTD_INCLUDE_DIR ZSTD_LIBRARY)
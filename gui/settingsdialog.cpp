@@ -58,6 +58,8 @@ core::Settings SettingsDialog::settings() const
             result.approximation(core::Approximation::kNone);
         } else if (ui->rareEvent->isChecked()) {
             result.approximation(core::Approximation::kRareEvent);
+        } else if (ui->bonferroni->isChecked()) {
+            result.approximation(core::Approximation::kBonferroni);
         } else {
             GUI_ASSERT(ui->mcub->isChecked(), result);
             result.approximation(core::Approximation::kMcub);
@@ -102,6 +104,9 @@ void SettingsDialog::setupState(const core::Settings &initSettings)
     case core::Approximation::kMcub:
         ui->mcub->setChecked(true);
         break;
+    case core::Approximation::kBonferroni:
+        ui->bonferroni->setChecked(true);
+        break;
     }
 }
 
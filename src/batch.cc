@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the batch analysis with parallel workers.
+
+#include "batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <unordered_set>
+
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/exception/get_error_info.hpp>
+#include <boost/filesystem.hpp>
+
+#include "error.h"
+#include "initializer.h"
+#include "logger.h"
+#include "project.h"
+#include "reporter.h"
+#include "risk_analysis.h"
+
+namespace fs = boost::filesystem;
+
+namespace scram {
+
+Batch::Batch(int num_workers, bool allow_extern)
+    : num_workers_(num_workers), allow_extern_(allow_extern) {
+  if (num_workers_ < 1) {
+    SCRAM_THROW(SettingsError("The number of batch workers must be positive."))
+        << errinfo_value(std::to_string(num_workers_));
+  }
+}
+
+int Batch::Run(const std::vector<std::string>& project_files,
+               const std::string& output_dir, bool indent,
+               xml::Compression compression) {
+  TIMER(DEBUG1, "Running the batch of projects");
+  std::string extension = ".xml";
+  if (compression != xml::Compression::kNone)
+    extension += compression == xml::Compression::kGzip ? ".gz" : ".zst";
+  std::vector<std::string> report_files;
+  std::unordered_set<std::string> report_names;
+  for (const std::string& project_file : project_files) {
+    std::string name = fs::path(project_file).stem().string();
+    if (!report_names.insert(name).second) {
+      SCRAM_THROW(IOError("Duplicate report names for projects."))
+          << boost::errinfo_file_name(project_file);
+    }
+    report_files.push_back(
+        (fs::path(output_dir) / (name + extension)).string());
+  }
+
+  std::atomic<int> next_project(0);
+  std::atomic<int> num_failures(0);
+  auto work = [&] {
+    for (int i = next_project++; i < project_files.size();
+         i = next_project++) {
+      try {
+        Analyze(project_files[i], report_files[i], indent, compression);
+      } catch (const Error& err) {
+        const auto* file = boost::get_error_info<boost::errinfo_file_name>(err);
+        LOG(ERROR) << "Project " << project_files[i]
+                   << " has failed: " << err.what()
+                   << (file ? " (" + *file + ")" : "");
+        ++num_failures;
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  int num_threads = std::min<std::size_t>(num_workers_, project_files.size());
+  for (int i = 1; i < num_threads; ++i)
+    workers.emplace_back(work);
+  work();  // The calling thread is one of the workers.
+  for (std::thread& worker : workers)
+    worker.join();
+
+  LOG(DEBUG2) << "Shared input documents: " << documents_.size();
+  return num_failures;
+}
+
+void Batch::Analyze(const std::string& project_file,
+                    const std::string& report_file, bool indent,
+                    xml::Compression compression) {
+  LOG(INFO) << "Running project: " << project_file;
+  Project project(project_file);
+  std::unique_ptr<mef::Model> model =
+      mef::Initializer(project.input_files(), project.settings(),
+                       allow_extern_, nullptr, &documents_)
+          .model();
+  core::RiskAnalysis analysis(model.get(), project.settings());
+  analysis.Analyze();
+  Reporter().Report(analysis, report_file, indent, compression);
+  LOG(INFO) << "Finished project: " << project_file;
+}
+
+}  // namespace scram
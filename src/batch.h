@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Batch analysis of many projects with shared input documents.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "xml.h"
+#include "xml_stream.h"
+
+namespace scram {
+
+/// Runner of independent projects in parallel worker threads.
+/// The input files common to the projects (e.g., a base model with overlays)
+/// are parsed and validated only once.
+class Batch {
+ public:
+  /// @param[in] num_workers  The number of parallel worker threads.
+  /// @param[in] allow_extern  Allow external libraries in the models.
+  ///
+  /// @throws SettingsError  The number of workers is not positive.
+  explicit Batch(int num_workers, bool allow_extern = false);
+
+  /// Analyzes the projects and writes one report per project.
+  /// The reports are named after the project files,
+  /// e.g., "path/to/plant.xml" is reported into "output_dir/plant.xml".
+  /// The failures of projects are logged
+  /// without stopping the analysis of the other projects.
+  ///
+  /// @param[in] project_files  The project files with the configurations.
+  /// @param[in] output_dir  The existing directory for the reports.
+  /// @param[in] indent  The indentation of the reports.
+  /// @param[in] compression  The compression of the reports.
+  ///
+  /// @returns The number of failed projects.
+  ///
+  /// @throws IOError  The project files have the same names.
+  int Run(const std::vector<std::string>& project_files,
+          const std::string& output_dir, bool indent = true,
+          xml::Compression compression = xml::Compression::kNone);
+
+  /// @returns The documents shared by the projects.
+  const xml::DocumentCache& documents() const { return documents_; }
+
+ private:
+  /// Analyzes a single project.
+  ///
+  /// @param[in] project_file  The project file with the configurations.
+  /// @param[in] report_file  The destination of the report.
+  /// @param[in] indent  The indentation of the report.
+  /// @param[in] compression  The compression of the report.
+  ///
+  /// @throws Error  The project has failed.
+  void Analyze(const std::string& project_file, const std::string& report_file,
+               bool indent, xml::Compression compression);
+
+  int num_workers_;  ///< The number of worker threads.
+  bool allow_extern_;  ///< Permission for external libraries.
+  xml::DocumentCache documents_;  ///< The input documents of the projects.
+};
+
+}  // namespace scram
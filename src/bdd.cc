@@ -63,15 +63,17 @@ Bdd::Bdd(const Pdag* graph, const Settings& settings)
     root_ = ConvertGraph(graph->root(), &gates);
     root_.complement ^= graph->complement();
   }
-  ClearMarks(false);
-  TestStructure(root_.vertex);
+  TestStructure(root_.vertex, Ite::NewMark());
   LOG(DEBUG4) << "# of BDD vertices created: " << function_id_ - 1;
   LOG(DEBUG4) << "# of entries in unique table: " << unique_table_.size();
   LOG(DEBUG4) << "# of entries in AND table: " << and_table_.size();
   LOG(DEBUG4) << "# of entries in OR table: " << or_table_.size();
-  ClearMarks(false);
-  LOG(DEBUG4) << "# of ITE in BDD: " << CountIteNodes(root_.vertex);
-  ClearMarks(false);
+  LOG(DEBUG4) << "AND table hits/misses: " << and_table_.hits() << "/"
+              << and_table_.misses();
+  LOG(DEBUG4) << "OR table hits/misses: " << or_table_.hits() << "/"
+              << or_table_.misses();
+  LOG(DEBUG4) << "# of ITE in BDD: "
+              << CountIteNodes(root_.vertex, Ite::NewMark());
   if (coherent_) {  // Clear tables if no more calculations are expected.
     Freeze();
   } else {  // To be used by ZBDD for prime implicant calculations.
@@ -79,8 +81,42 @@ Bdd::Bdd(const Pdag* graph, const Settings& settings)
   }
 }
 
+Bdd::Bdd(const Settings& settings)
+    : kSettings_(settings),
+      coherent_(true),
+      kOne_(new Terminal<Ite>(true)),
+      function_id_(2) {}
+
 Bdd::~Bdd() noexcept = default;
 
+Bdd::Function Bdd::AddFunction(
+    const Pdag* graph,
+    const Pdag::IndexMap<std::pair<int, int>>& variables) noexcept {
+  assert(!root_ && "The BDD is not shared.");
+  coherent_ &= graph->coherent();
+  Function result;
+  if (graph->IsTrivial()) {
+    const Gate& top_gate = graph->root();
+    assert(top_gate.args().size() == 1);
+    assert(top_gate.args<Gate>().empty());
+    int child = *top_gate.args().begin();
+    if (top_gate.constant()) {
+      result = {child < 0, kOne_};
+    } else {
+      auto [index, order] =
+          variables[top_gate.args<Variable>().begin()->second.index()];
+      result = {child < 0, FindOrAddVertex(index, kOne_, kOne_, true, order)};
+      index_to_order_.emplace(index, order);
+    }
+  } else {
+    std::unordered_map<int, std::pair<Function, int>> gates;
+    result = ConvertGraph(graph->root(), &gates, &variables);
+  }
+  result.complement ^= graph->complement();
+  TestStructure(result.vertex, Ite::NewMark());
+  return result;
+}
+
 void Bdd::Analyze(const Pdag* graph) noexcept {
   zbdd_ = std::make_unique<Zbdd>(this, kSettings_);
   zbdd_->Analyze(graph);
@@ -134,7 +170,8 @@ ItePtr Bdd::FindOrAddVertex(const Gate& gate, const VertexPtr& high,
 
 Bdd::Function Bdd::ConvertGraph(
     const Gate& gate,
-    std::unordered_map<int, std::pair<Function, int>>* gates) noexcept {
+    std::unordered_map<int, std::pair<Function, int>>* gates,
+    const Pdag::IndexMap<std::pair<int, int>>* variables) noexcept {
   assert(!gate.constant() && "Unexpected constant gate!");
   Function result;  // For the NRVO, due to memoization.
   // Memoization check.
@@ -148,14 +185,16 @@ Bdd::Function Bdd::ConvertGraph(
   }
   std::vector<Function> args;
   for (const Gate::ConstArg<Variable>& arg : gate.args<Variable>()) {
+    auto [index, order] = variables
+                              ? (*variables)[arg.second.index()]
+                              : std::pair(arg.second.index(), arg.second.order());
     args.push_back(
-        {arg.first < 0, FindOrAddVertex(arg.second.index(), kOne_, kOne_, true,
-                                        arg.second.order())});
-    index_to_order_.emplace(arg.second.index(), arg.second.order());
+        {arg.first < 0, FindOrAddVertex(index, kOne_, kOne_, true, order)});
+    index_to_order_.emplace(index, order);
   }
   for (const Gate::ConstArg<Gate>& arg : gate.args<Gate>()) {
-    Function res = ConvertGraph(arg.second, gates);
-    if (arg.second.module()) {
+    Function res = ConvertGraph(arg.second, gates, variables);
+    if (arg.second.module() && !variables) {
       args.push_back(
           {arg.first < 0, FindOrAddVertex(arg.second, kOne_, kOne_, true)});
     } else {
@@ -175,10 +214,12 @@ Bdd::Function Bdd::ConvertGraph(
     result = Apply(gate.type(), result.vertex, it->vertex, result.complement,
                    it->complement);
   }
-  ClearTables();
   assert(result.vertex);
-  if (gate.module())
-    modules_.emplace(gate.index(), result);
+  if (!variables) {  // The shared computation tables outlive the graph.
+    ClearTables();
+    if (gate.module())
+      modules_.emplace(gate.index(), result);
+  }
   if (gate.parents().size() > 1)
     gates->insert({gate.index(), {result, 1}});
   return result;
@@ -313,43 +354,29 @@ Bdd::Function Bdd::CalculateConsensus(const ItePtr& ite,
                      ite->complement_edge() ^ complement);
 }
 
-int Bdd::CountIteNodes(const VertexPtr& vertex) noexcept {
+int Bdd::CountIteNodes(const VertexPtr& vertex, int mark) noexcept {
   if (vertex->terminal())
     return 0;
   Ite& ite = Ite::Ref(vertex);
-  if (ite.mark())
+  if (ite.mark() == mark)
     return 0;
-  ite.mark(true);
+  ite.mark(mark);
   int in_module = 0;
   if (ite.module()) {
     const Function& module = modules_.find(ite.index())->second;
-    in_module = CountIteNodes(module.vertex);
+    in_module = CountIteNodes(module.vertex, mark);
   }
-  return 1 + in_module + CountIteNodes(ite.high()) + CountIteNodes(ite.low());
+  return 1 + in_module + CountIteNodes(ite.high(), mark) +
+         CountIteNodes(ite.low(), mark);
 }
 
-void Bdd::ClearMarks(const VertexPtr& vertex, bool mark) noexcept {
+void Bdd::TestStructure(const VertexPtr& vertex, int mark) noexcept {
   if (vertex->terminal())
     return;
   Ite& ite = Ite::Ref(vertex);
   if (ite.mark() == mark)
     return;
   ite.mark(mark);
-  if (ite.module()) {
-    const Function& res = modules_.find(ite.index())->second;
-    ClearMarks(res.vertex, mark);
-  }
-  ClearMarks(ite.high(), mark);
-  ClearMarks(ite.low(), mark);
-}
-
-void Bdd::TestStructure(const VertexPtr& vertex) noexcept {
-  if (vertex->terminal())
-    return;
-  Ite& ite = Ite::Ref(vertex);
-  if (ite.mark())
-    return;
-  ite.mark(true);
   assert(ite.index() && "Illegal index for a node.");
   assert(ite.order() && "Improper order for nodes.");
   assert(ite.high() && ite.low() && "Malformed node high/low pointers.");
@@ -364,10 +391,10 @@ void Bdd::TestStructure(const VertexPtr& vertex) noexcept {
   if (ite.module()) {
     const Function& res = modules_.find(ite.index())->second;
     assert(!res.vertex->terminal() && "Terminal modules must be removed.");
-    TestStructure(res.vertex);
+    TestStructure(res.vertex, mark);
   }
-  TestStructure(ite.high());
-  TestStructure(ite.low());
+  TestStructure(ite.high(), mark);
+  TestStructure(ite.low(), mark);
 }
 
 }  // namespace scram::core
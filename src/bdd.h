@@ -21,9 +21,12 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 
 #include <algorithm>
+#include <atomic>
 #include <forward_list>
+#include <limits>
 #include <memory>
 #include <unordered_map>
 #include <utility>
@@ -259,9 +262,9 @@ class NonTerminal : public Vertex<T>, public IntrusivePtrCast<T> {
         low_(low),
         order_(order),
         index_(index),
+        mark_(0),
         module_(false),
-        coherent_(false),
-        mark_(false) {}
+        coherent_(false) {}
 
   /// @returns The index of this vertex.
   int index() const { return index_; }
@@ -295,13 +298,27 @@ class NonTerminal : public Vertex<T>, public IntrusivePtrCast<T> {
   /// @returns (0/False/else/right) branch vertex.
   const VertexPtr& low() const { return low_; }
 
-  /// @returns The mark of this vertex.
-  bool mark() const { return mark_; }
+  /// Provides a new unique traversal mark (epoch) for vertices.
+  /// A vertex is visited by a traversal
+  /// if its mark is equal to the traversal mark;
+  /// hence, no clearing of vertex marks is required for new traversals.
+  ///
+  /// @returns A mark unique across all graphs with this vertex type,
+  ///          so that traversals can cross module graphs.
+  static int NewMark() noexcept {
+    static std::atomic<int> epoch(0);
+    int mark = ++epoch;
+    assert(mark > 0 && "Traversal mark overflow.");
+    return mark;
+  }
+
+  /// @returns The traversal mark of this vertex.
+  int mark() const { return mark_; }
 
   /// Marks this vertex.
   ///
-  /// @param[in] flag  A flag with the meaning for the user of marks.
-  void mark(bool flag) { mark_ = flag; }
+  /// @param[in] epoch  The mark of the current traversal.
+  void mark(int epoch) { mark_ = epoch; }
 
  protected:
   ~NonTerminal() = default;
@@ -311,9 +328,9 @@ class NonTerminal : public Vertex<T>, public IntrusivePtrCast<T> {
   VertexPtr low_;  ///< O (False/else) branch in the Shannon decomposition.
   int order_;  ///< Order of the variable.
   int index_;  ///< Index of the variable.
+  int mark_;  ///< Traversal mark (epoch).
   bool module_;  ///< Mark for module variables.
   bool coherent_;  ///< Mark for coherence.
-  bool mark_;  ///< Traversal mark.
 };
 
 /// Representation of non-terminal if-then-else vertices in BDD graphs.
@@ -555,8 +572,16 @@ class UniqueTable {
 /// The implementation of the table
 /// is very much coupled with the BDD use cases.
 ///
+/// The table grows with the number of entries
+/// only up to its maximum capacity.
+/// Beyond the maximum capacity,
+/// the table works as a direct-mapped computed table
+/// with a bounded memory footprint.
+///
 /// @tparam V  The type of the value/result of BDD Apply.
 ///            The type must provide swap(), reset(), and operator bool().
+/// @tparam K  The key type with compact unique ids of the arguments.
+/// @tparam Hash  The hash functor for the keys.
 ///
 /// @note The API is designed after STL maps as drop-in replacement for BDD.
 ///       This approach allows performance testing with the baseline.
@@ -564,13 +589,13 @@ class UniqueTable {
 ///
 /// @warning The behavior is very different from standard maps.
 ///          References can easily be invalidated upon rehashing or insertion.
-template <class V>
+template <class V, class K = std::pair<int, int>, class Hash = boost::hash<K>>
 class CacheTable {
  public:
   /// Public typedefs similar to the standard maps.
   ///
   /// @{
-  using key_type = std::pair<int, int>;
+  using key_type = K;
   using mapped_type = V;
   using value_type = std::pair<key_type, mapped_type>;
   using container_type = std::vector<value_type>;
@@ -580,15 +605,28 @@ class CacheTable {
   /// Constructor with average expectations for computations.
   ///
   /// @param[in] init_capacity
-  explicit CacheTable(int init_capacity = 1000)
+  /// @param[in] max_capacity  The limit on the number of buckets.
+  explicit CacheTable(int init_capacity = 1000,
+                      int max_capacity = std::numeric_limits<int>::max())
       : size_(0),
         max_load_factor_(0.75),
+        max_capacity_(std::max(init_capacity, max_capacity)),
+        hits_(0),
+        misses_(0),
         table_(core::GetPrimeNumber(init_capacity)) {}
 
   /// @returns The number of entires in the table.
   int size() const { return size_; }
 
+  /// @returns The number of successful lookups.
+  std::int64_t hits() const { return hits_; }
+
+  /// @returns The number of failed lookups.
+  std::int64_t misses() const { return misses_; }
+
   /// Removes all entries from the table.
+  ///
+  /// @note The lookup statistics are kept for the whole lifetime.
   void clear() {
     for (value_type& entry : table_) {
       if (entry.second)
@@ -611,7 +649,8 @@ class CacheTable {
     }
     if (n <= size_)
       return;
-    Rehash(core::GetPrimeNumber(n / max_load_factor_ + 1));
+    Rehash(core::GetPrimeNumber(std::min<double>(n / max_load_factor_ + 1,
+                                                 max_capacity_)));
   }
 
   /// Searches for existing entry.
@@ -621,10 +660,13 @@ class CacheTable {
   /// @returns Iterator pointing to the found entry.
   /// @returns end() if no entry with the given key is found.
   iterator find(const key_type& key) {
-    int index = boost::hash_value(key) % table_.size();
+    int index = Hash()(key) % table_.size();
     value_type& entry = table_[index];
-    if (!entry.second || entry.first != key)
+    if (!entry.second || entry.first != key) {
+      ++misses_;
       return table_.end();
+    }
+    ++hits_;
     return table_.begin() + index;
   }
 
@@ -642,10 +684,13 @@ class CacheTable {
   void emplace(const key_type& key, const mapped_type& value) {
     assert(value && "Empty computation results!");
 
-    if (size_ >= (max_load_factor_ * table_.size()))
-      Rehash(core::GetPrimeNumber(table_.size() * 2));
+    if (size_ >= (max_load_factor_ * table_.size()) &&
+        table_.size() < max_capacity_) {
+      Rehash(core::GetPrimeNumber(
+          std::min<std::size_t>(table_.size() * 2, max_capacity_)));
+    }
 
-    int index = boost::hash_value(key) % table_.size();
+    int index = Hash()(key) % table_.size();
     value_type& entry = table_[index];
     if (!entry.second)
       ++size_;
@@ -663,7 +708,7 @@ class CacheTable {
     for (value_type& entry : table_) {
       if (!entry.second)
         continue;
-      int new_index = boost::hash_value(entry.first) % new_table.size();
+      int new_index = Hash()(entry.first) % new_table.size();
       value_type& new_entry = new_table[new_index];
       new_entry.first = entry.first;
       if (!new_entry.second)
@@ -676,6 +721,9 @@ class CacheTable {
 
   int size_;  ///< The total number of elements in the table.
   double max_load_factor_;  ///< The limit on (size / capacity) ratio.
+  std::size_t max_capacity_;  ///< The limit on the container size.
+  std::int64_t hits_;  ///< The number of successful lookups.
+  std::int64_t misses_;  ///< The number of failed lookups.
   std::vector<value_type> table_;  ///< The main container.
 };
 
@@ -737,9 +785,31 @@ class Bdd : private boost::noncopyable {
   /// @note BDD construction may take considerable time.
   Bdd(const Pdag* graph, const Settings& settings);
 
+  /// Constructs a BDD manager without the root function
+  /// to host functions of several PDAGs over common variables.
+  /// The functions share the unique table and computation tables.
+  ///
+  /// @param[in] settings  The analysis settings.
+  explicit Bdd(const Settings& settings);
+
   /// To handle incomplete ZBDD type with unique pointers.
   ~Bdd() noexcept;
 
+  /// Converts a PDAG into a new function in the shared BDD.
+  /// Modules are converted in place without proxy vertices
+  /// because module indices are not shared among PDAGs.
+  ///
+  /// @param[in] graph  Preprocessed and partially normalized PDAG.
+  /// @param[in] variables  The shared index and order of each PDAG variable.
+  ///
+  /// @returns The BDD function of the PDAG.
+  ///
+  /// @pre The BDD is constructed without the root function.
+  /// @pre The shared variable orders are consistent among all the PDAGs.
+  Function AddFunction(
+      const Pdag* graph,
+      const Pdag::IndexMap<std::pair<int, int>>& variables) noexcept;
+
   /// @returns The root function of the ROBDD.
   const Function& root() const { return root_; }
 
@@ -754,16 +824,6 @@ class Bdd : private boost::noncopyable {
   /// @returns true if the BDD has been constructed from a coherent PDAG.
   bool coherent() const { return coherent_; }
 
-  /// Helper function to clear and set vertex marks.
-  ///
-  /// @param[in] mark  Desired mark for BDD vertices.
-  ///
-  /// @note Marks will propagate to modules as well.
-  ///
-  /// @warning If the graph is discontinuously and partially marked,
-  ///          this function will not help with the mess.
-  void ClearMarks(bool mark) { ClearMarks(root_.vertex, mark); }
-
   /// Runs the Qualitative analysis
   /// with the representation of a PDAG as ROBDD.
   ///
@@ -834,13 +894,15 @@ class Bdd : private boost::noncopyable {
   ///
   /// @param[in] gate  The root or current parent gate of the graph.
   /// @param[in,out] gates  Processed gates with use counts.
+  /// @param[in] variables  The optional shared indices and orders of variables.
   ///
   /// @returns The BDD function representing the gate.
   ///
   /// @pre The memoization container is not used outside of this function.
   Function ConvertGraph(
       const Gate& gate,
-      std::unordered_map<int, std::pair<Function, int>>* gates) noexcept;
+      std::unordered_map<int, std::pair<Function, int>>* gates,
+      const Pdag::IndexMap<std::pair<int, int>>* variables = nullptr) noexcept;
 
   /// Computes minimum and maximum ids for keys in computation tables.
   ///
@@ -921,27 +983,17 @@ class Bdd : private boost::noncopyable {
   /// Counts the number of if-then-else nodes.
   ///
   /// @param[in] vertex  The starting root vertex of BDD.
+  /// @param[in] mark  The new traversal mark.
   ///
   /// @returns The number of ITE nodes in the BDD.
-  ///
-  /// @pre Non-terminal node marks are clear (false).
-  int CountIteNodes(const VertexPtr& vertex) noexcept;
-
-  /// Clears marks of vertices in BDD graph.
-  ///
-  /// @param[in] vertex  The starting root vertex of the graph.
-  /// @param[in] mark  The desired mark for the vertices.
-  ///
-  /// @note Marks will propagate to modules as well.
-  void ClearMarks(const VertexPtr& vertex, bool mark) noexcept;
+  int CountIteNodes(const VertexPtr& vertex, int mark) noexcept;
 
   /// Checks BDD graphs for errors in the structure.
   /// Errors are assertions that fail at runtime.
   ///
   /// @param[in] vertex  The root vertex of BDD.
-  ///
-  /// @pre Non-terminal node marks are clear (false).
-  void TestStructure(const VertexPtr& vertex) noexcept;
+  /// @param[in] mark  The new traversal mark.
+  void TestStructure(const VertexPtr& vertex, int mark) noexcept;
 
   /// Clears all memoization tables.
   void ClearTables() noexcept {
@@ -19,6 +19,8 @@
 
 #include "event_tree_analysis.h"
 
+#include <boost/range/algorithm.hpp>
+
 #include "expression/numerical.h"
 #include "ext/find_iterator.h"
 #include "instruction.h"
@@ -27,54 +29,68 @@ namespace scram::core {
 
 EventTreeAnalysis::EventTreeAnalysis(
     const mef::InitiatingEvent& initiating_event, const Settings& settings,
-    mef::Context* context)
+    mef::Context* context,
+    const std::unordered_set<const mef::HouseEvent*>* parameters)
     : Analysis(settings),
       initiating_event_(initiating_event),
-      context_(context) {}
-
-namespace {  // The model cloning functions.
+      context_(context),
+      parameters_(parameters) {}
 
-/// Clones the formula by applying the set-instructions.
-///
-/// @param[in] formula  The formula to be deep-cloned.
-/// @param[in] set_instructions  The set instructions to change arguments.
-/// @param[in] clones  The storage container for newly created clones.
-///
-/// @returns The deep-copy of the argument formula with new (changed) arguments.
-std::unique_ptr<mef::Formula>
-Clone(const mef::Formula& formula,
-      const std::unordered_map<std::string, bool>& set_instructions,
-      std::vector<std::unique_ptr<mef::Event>>* clones) noexcept {
+mef::FormulaPtr EventTreeAnalysis::Clone(
+    const mef::Formula& formula, const SetInstructions* set_instructions,
+    CloneTable* clones) noexcept {
   struct {
     mef::Formula::ArgEvent operator()(mef::BasicEvent* arg) { return arg; }
     mef::Formula::ArgEvent operator()(mef::HouseEvent* arg) {
-      if (auto it = ext::find(set_house, arg->id())) {
-        if (it->second == arg->state())
+      bool is_parameter = analysis->parameters_ &&
+                          analysis->parameters_->count(arg);
+      if (auto it = ext::find(*set_house, arg->id())) {
+        if (it->second == arg->state() && !is_parameter)
           return arg;
-        auto clone = std::make_unique<mef::HouseEvent>(
-            arg->name(), "__clone__." + arg->id(),
-            mef::RoleSpecifier::kPrivate);
-        clone->state(it->second);
-        auto* ptr = clone.get();
-        event_register->emplace_back(std::move(clone));
+        mef::HouseEvent*& ptr = table->house_events[{arg, it->second}];
+        if (!ptr) {
+          auto clone = std::make_unique<mef::HouseEvent>(
+              arg->name(), "__clone__." + arg->id(),
+              mef::RoleSpecifier::kPrivate);
+          clone->state(it->second);
+          ptr = clone.get();
+          analysis->events_.emplace_back(std::move(clone));
+        }
+        return ptr;
+      }
+      if (is_parameter) {
+        mef::BasicEvent*& ptr = table->proxies[arg];
+        if (!ptr) {
+          auto proxy = std::make_unique<mef::BasicEvent>(
+              arg->name(), "__parameter__." + arg->id(),
+              mef::RoleSpecifier::kPrivate);
+          ptr = proxy.get();
+          analysis->proxies_.emplace(ptr, arg);
+          analysis->events_.emplace_back(std::move(proxy));
+        }
         return ptr;
       }
       return arg;
     }
     mef::Formula::ArgEvent operator()(mef::Gate* arg) {
-      if (set_house.empty())
+      if (set_house->empty() && !analysis->parameters_)
         return arg;
-      auto clone = std::make_unique<mef::Gate>(
-          arg->name(), "__clone__." + arg->id(), mef::RoleSpecifier::kPrivate);
-      clone->formula(Clone(arg->formula(), set_house, event_register));
-      auto* ptr = clone.get();
-      event_register->emplace_back(std::move(clone));
+      mef::Gate*& ptr = table->gates[{arg, set_house}];
+      if (!ptr) {
+        auto clone = std::make_unique<mef::Gate>(
+            arg->name(), "__clone__." + arg->id(),
+            mef::RoleSpecifier::kPrivate);
+        clone->formula(analysis->Clone(arg->formula(), set_house, table));
+        ptr = clone.get();
+        analysis->events_.emplace_back(std::move(clone));
+      }
       return ptr;
     }
 
-    const std::unordered_map<std::string, bool>& set_house;
-    std::vector<std::unique_ptr<mef::Event>>* event_register;
-  } cloner{set_instructions, clones};
+    const SetInstructions* set_house;
+    CloneTable* table;
+    EventTreeAnalysis* analysis;
+  } cloner{set_instructions, clones, this};
 
   mef::Formula::ArgSet arg_set;
   for (const mef::Formula::Arg& arg : formula.args())
@@ -85,14 +101,22 @@ Clone(const mef::Formula& formula,
       formula.max_number());
 }
 
-}  // namespace
+namespace {
 
-EventTreeAnalysis::PathCollector::PathCollector(const PathCollector& other)
-    : expressions(other.expressions), set_instructions(other.set_instructions) {
-  for (const mef::FormulaPtr& formula : other.formulas)
-    formulas.push_back(std::make_unique<mef::Formula>(*formula));
+/// @param[in] head  The head of the persistent list of path values.
+///
+/// @returns The values in the order of collection along the path.
+template <class PathList>
+auto Unroll(const std::shared_ptr<const PathList>& head) {
+  std::vector<decltype(head->value)> values;
+  for (const PathList* node = head.get(); node; node = node->next.get())
+    values.push_back(node->value);
+  boost::reverse(values);
+  return values;
 }
 
+}  // namespace
+
 void EventTreeAnalysis::Analyze() noexcept {
   assert(initiating_event_.event_tree());
   int formula_id = 0;  // Enumeration of collected formulas turned into gates.
@@ -113,22 +137,27 @@ void EventTreeAnalysis::Analyze() noexcept {
     auto gate = std::make_unique<mef::Gate>("__" + sequence.first->name());
     std::vector<mef::FormulaPtr> gate_formulas;
     std::vector<mef::Expression*> arg_expressions;
-    for (PathCollector& path_collector : sequence.second) {
-      if (path_collector.formulas.size() == 1) {
-        gate_formulas.push_back(std::move(path_collector.formulas.front()));
-      } else if (path_collector.formulas.size() > 1) {
+    for (const PathCollector& path_collector : sequence.second) {
+      std::vector<const mef::Formula*> formulas =
+          Unroll(path_collector.formulas);
+      if (formulas.size() == 1) {
+        gate_formulas.push_back(
+            std::make_unique<mef::Formula>(*formulas.front()));
+      } else if (formulas.size() > 1) {
         mef::Formula::ArgSet arg_set;
-        for (mef::FormulaPtr& arg_formula : path_collector.formulas)
-          arg_set.Add(make_gate(std::move(arg_formula)));
+        for (const mef::Formula* arg_formula : formulas)
+          arg_set.Add(make_gate(std::make_unique<mef::Formula>(*arg_formula)));
 
         gate_formulas.push_back(
             std::make_unique<mef::Formula>(mef::kAnd, std::move(arg_set)));
       }
-      if (path_collector.expressions.size() == 1) {
-        arg_expressions.push_back(path_collector.expressions.front());
-      } else if (path_collector.expressions.size() > 1) {
+      std::vector<mef::Expression*> expressions =
+          Unroll(path_collector.expressions);
+      if (expressions.size() == 1) {
+        arg_expressions.push_back(expressions.front());
+      } else if (expressions.size() > 1) {
         expressions_.push_back(
-            std::make_unique<mef::Mul>(std::move(path_collector.expressions)));
+            std::make_unique<mef::Mul>(std::move(expressions)));
         arg_expressions.push_back(expressions_.back().get());
       }
     }
@@ -173,8 +202,13 @@ void EventTreeAnalysis::CollectSequences(const mef::Branch& initial_state,
       explicit Visitor(Collector* collector) : collector_(*collector) {}
 
       void Visit(const mef::SetHouseEvent* house_event) override {
-        collector_.path_collector_.set_instructions[house_event->name()] =
-            house_event->state();
+        const SetInstructions*& path_state =
+            collector_.path_collector_.set_instructions;
+        SetInstructions state = *path_state;
+        state[house_event->name()] = house_event->state();
+        path_state =
+            &*collector_.result_->set_instructions.insert(std::move(state))
+                  .first;
       }
 
       void Visit(const mef::Link* link) override {
@@ -186,17 +220,23 @@ void EventTreeAnalysis::CollectSequences(const mef::Branch& initial_state,
       }
 
       void Visit(const mef::CollectFormula* collect_formula) override {
-        // clang-format off
-        collector_.path_collector_.formulas.push_back(
-            core::Clone(collect_formula->formula(),
-                        collector_.path_collector_.set_instructions,
-                        collector_.clones_));
-        // clang-format on
+        PathCollector& path = collector_.path_collector_;
+        SequenceCollector* result = collector_.result_;
+        mef::FormulaPtr& formula =
+            result->formulas[{&collect_formula->formula(),
+                              path.set_instructions}];
+        if (!formula) {
+          formula = collector_.analysis_->Clone(
+              collect_formula->formula(), path.set_instructions,
+              &result->clones);
+        }
+        PathList<const mef::Formula*>::Push(formula.get(), &path.formulas);
       }
 
       void Visit(const mef::CollectExpression* collect_expression) override {
-        collector_.path_collector_.expressions.push_back(
-            &collect_expression->expression());
+        PathList<mef::Expression*>::Push(
+            &collect_expression->expression(),
+            &collector_.path_collector_.expressions);
       }
 
       bool is_linked() const { return is_linked_; }
@@ -211,7 +251,7 @@ void EventTreeAnalysis::CollectSequences(const mef::Branch& initial_state,
       for (const mef::Instruction* instruction : sequence->instructions())
         instruction->Accept(&visitor);
       if (!visitor.is_linked())
-        result_->sequences[sequence].push_back(std::move(path_collector_));
+        result_->sequences[sequence].push_back(path_collector_);
     }
 
     void operator()(const mef::Fork* fork) const {
@@ -237,12 +277,14 @@ void EventTreeAnalysis::CollectSequences(const mef::Branch& initial_state,
     }
 
     SequenceCollector* result_;
-    std::vector<std::unique_ptr<mef::Event>>* clones_;
+    EventTreeAnalysis* analysis_;
     PathCollector path_collector_;
   };
   context_->functional_events.clear();
   context_->initiating_event = initiating_event_.name();
-  Collector{result, &events_}(&initial_state);  // NOLINT(whitespace/braces)
+  PathCollector path_collector;
+  path_collector.set_instructions = &*result->set_instructions.emplace().first;
+  Collector{result, this, std::move(path_collector)}(&initial_state);  // NOLINT
 }
 
 }  // namespace scram::core
@@ -19,9 +19,13 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "analysis.h"
@@ -47,10 +51,15 @@ class EventTreeAnalysis : public Analysis {
   /// @param[in] initiating_event  The unique initiating event.
   /// @param[in] settings  The analysis settings.
   /// @param[in] context  The context to communicate with test-events.
+  /// @param[in] parameters  The optional house events
+  ///                        to be kept as variables in the formulas.
   ///
   /// @pre The initiating event has its event tree.
-  EventTreeAnalysis(const mef::InitiatingEvent& initiating_event,
-                    const Settings& settings, mef::Context* context);
+  /// @pre The parameters outlive the analysis.
+  EventTreeAnalysis(
+      const mef::InitiatingEvent& initiating_event, const Settings& settings,
+      mef::Context* context,
+      const std::unordered_set<const mef::HouseEvent*>* parameters = nullptr);
 
   /// Analyzes an event tree given the initiating event.
   void Analyze() noexcept;
@@ -66,14 +75,58 @@ class EventTreeAnalysis : public Analysis {
   std::vector<Result>& sequences() { return sequences_; }
   /// @}
 
+  /// @returns The basic events standing for the parameter house events
+  ///          in the collected formulas.
+  const std::unordered_map<const mef::BasicEvent*, const mef::HouseEvent*>&
+  proxies() const {
+    return proxies_;
+  }
+
  private:
+  /// House-event states set by the instructions along a path.
+  using SetInstructions = std::map<std::string, bool>;
+
+  /// Hash-consed clones of model events under set-instructions.
+  struct CloneTable {
+    /// Gate clones by the original gate and the interned instructions.
+    std::map<std::pair<const mef::Gate*, const SetInstructions*>, mef::Gate*>
+        gates;
+    /// House-event clones by the original house event and the new state.
+    std::map<std::pair<const mef::HouseEvent*, bool>, mef::HouseEvent*>
+        house_events;
+    /// Basic-event proxies of the parameter house events.
+    std::map<const mef::HouseEvent*, mef::BasicEvent*> proxies;
+  };
+
+  /// Persistent list of values collected along a path.
+  /// The collected values are shared with the paths forked afterwards.
+  ///
+  /// @tparam T  The type of collected values.
+  template <typename T>
+  struct PathList {
+    /// Prepends a value to a shared list.
+    ///
+    /// @param[in] value  The newly collected value.
+    /// @param[in,out] head  The head of the list to be updated.
+    static void Push(T value, std::shared_ptr<const PathList>* head) {
+      *head = std::make_shared<const PathList>(
+          PathList{std::move(value), std::move(*head)});
+    }
+
+    T value;  ///< The last collected value.
+    std::shared_ptr<const PathList> next;  ///< The values collected before.
+  };
+
   /// Expressions and formulas collected in an event tree path.
+  /// The collector is cheap to copy at forks
+  /// because its state is immutable and shared among the paths.
   struct PathCollector {
-    PathCollector() = default;
-    PathCollector(const PathCollector&);  ///< Must deep copy formulas.
-    std::vector<mef::Expression*> expressions;  ///< Multiplication arguments.
-    std::vector<mef::FormulaPtr> formulas;  ///< AND connective formulas.
-    std::unordered_map<std::string, bool> set_instructions;  ///< House events.
+    /// Multiplication arguments.
+    std::shared_ptr<const PathList<mef::Expression*>> expressions;
+    /// AND connective formulas.
+    std::shared_ptr<const PathList<const mef::Formula*>> formulas;
+    /// Interned house-event states.
+    const SetInstructions* set_instructions = nullptr;
   };
 
   /// Walks the event tree paths and collects sequences.
@@ -83,8 +136,28 @@ class EventTreeAnalysis : public Analysis {
     /// Sequences with collected paths.
     std::unordered_map<const mef::Sequence*, std::vector<PathCollector>>
         sequences;
+    std::set<SetInstructions> set_instructions;  ///< Interned path states.
+    /// Collected formulas by the original formula and the path state.
+    std::map<std::pair<const mef::Formula*, const SetInstructions*>,
+             mef::FormulaPtr>
+        formulas;
+    CloneTable clones;  ///< Clones of events under the path states.
   };
 
+  /// Clones the formula by applying the set-instructions.
+  /// The clones of events are created once per house-event state.
+  /// The parameter house events not set by the instructions
+  /// are replaced with their basic-event proxies.
+  ///
+  /// @param[in] formula  The formula to be cloned.
+  /// @param[in] set_instructions  The interned set instructions.
+  /// @param[in,out] clones  The table of already created clones.
+  ///
+  /// @returns The copy of the argument formula with new (changed) arguments.
+  mef::FormulaPtr Clone(const mef::Formula& formula,
+                        const SetInstructions* set_instructions,
+                        CloneTable* clones) noexcept;
+
   /// Walks the branch and collects sequences with expressions if any.
   ///
   /// @param[in] initial_state  The branch to start the traversal.
@@ -100,6 +173,10 @@ class EventTreeAnalysis : public Analysis {
   std::vector<std::unique_ptr<mef::Expression>> expressions_;
   std::vector<std::unique_ptr<mef::Event>> events_;  ///< Newly created events.
   mef::Context* context_;  ///< The communication channel with test-events.
+  /// The house events to be kept as variables.
+  const std::unordered_set<const mef::HouseEvent*>* parameters_;
+  /// The proxies of the parameter house events.
+  std::unordered_map<const mef::BasicEvent*, const mef::HouseEvent*> proxies_;
 };
 
 }  // namespace scram::core
@@ -0,0 +1,413 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the columnar result export.
+
+#include "exporter.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <limits>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/exception/errinfo_errno.hpp>
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/exception/errinfo_file_open_mode.hpp>
+
+#include "error.h"
+#include "event.h"
+#include "logger.h"
+
+namespace scram {
+
+namespace {
+
+const char kMagic[] = "SCRAMCOL";  ///< The file header and footer signature.
+const int kMagicSize = sizeof(kMagic) - 1;
+const int kHeaderSize = 64;  ///< The header size in bytes.
+const int kColumnAlignment = 64;  ///< The alignment of column data.
+const std::uint32_t kByteOrderMark = 0x01020304;
+
+/// The column type of the element type.
+/// Unsupported element types fail to compile.
+/// @{
+template <typename T>
+constexpr Exporter::ColumnType kColumnTypeOf = [] {
+  static_assert(sizeof(T) == 0, "Unsupported column element type.");
+  return Exporter::kUint8;
+}();
+template <>
+constexpr Exporter::ColumnType kColumnTypeOf<std::uint8_t> = Exporter::kUint8;
+template <>
+constexpr Exporter::ColumnType kColumnTypeOf<std::int32_t> = Exporter::kInt32;
+template <>
+constexpr Exporter::ColumnType kColumnTypeOf<std::int64_t> = Exporter::kInt64;
+template <>
+constexpr Exporter::ColumnType kColumnTypeOf<double> = Exporter::kFloat64;
+/// @}
+
+/// Sequential writer of the columnar file.
+class ColumnFile {
+ public:
+  /// Writes the file header.
+  ///
+  /// @param[out] out  The destination stream.
+  ///
+  /// @throws IOError  The write operation has failed.
+  explicit ColumnFile(std::FILE* out) : out_(out), offset_(0) {
+    char header[kHeaderSize] = {};
+    std::memcpy(header, kMagic, kMagicSize);
+    std::memcpy(header + kMagicSize, &Exporter::kVersion, 4);
+    std::memcpy(header + kMagicSize + 4, &kByteOrderMark, 4);
+    Put(header, kHeaderSize);
+  }
+
+  /// Writes a column with its data aligned.
+  ///
+  /// @tparam T  The element type with a corresponding column type.
+  ///
+  /// @param[in] name  The unique name of the column.
+  /// @param[in] values  The column data.
+  ///
+  /// @throws IOError  The write operation has failed.
+  template <typename T>
+  void Write(std::string name, const std::vector<T>& values) {
+    Pad(kColumnAlignment);
+    directory_.push_back(
+        {std::move(name), offset_, values.size(), kColumnTypeOf<T>});
+    Put(values.data(), values.size() * sizeof(T));
+  }
+
+  /// Writes a string column as offsets and data columns.
+  ///
+  /// @param[in] name  The unique name of the column.
+  /// @param[in] strings  The column values.
+  ///
+  /// @throws IOError  The write operation has failed.
+  void Write(const std::string& name, const std::vector<std::string>& strings) {
+    std::vector<std::int64_t> offsets = {0};
+    std::vector<std::uint8_t> data;
+    for (const std::string& value : strings) {
+      data.insert(data.end(), value.begin(), value.end());
+      offsets.push_back(data.size());
+    }
+    Write(name + ".offsets", offsets);
+    Write(name + ".data", data);
+  }
+
+  /// Writes the directory and footer.
+  ///
+  /// @throws IOError  The write operation has failed.
+  void Close() {
+    Pad(8);
+    std::uint64_t directory_offset = offset_;
+    PutInt<std::uint64_t>(directory_.size());
+    for (const Entry& entry : directory_) {
+      PutInt<std::uint64_t>(entry.offset);
+      PutInt<std::uint64_t>(entry.length);
+      PutInt<std::uint32_t>(entry.type);
+      PutInt<std::uint32_t>(entry.name.size());
+      Put(entry.name.data(), entry.name.size());
+      Pad(8);
+    }
+    PutInt<std::uint64_t>(directory_offset);
+    Put(kMagic, kMagicSize);
+  }
+
+ private:
+  /// The directory entry of a column.
+  struct Entry {
+    std::string name;  ///< The unique name.
+    std::uint64_t offset;  ///< The offset of the data from the file start.
+    std::uint64_t length;  ///< The number of elements.
+    Exporter::ColumnType type;  ///< The element type.
+  };
+
+  /// Writes raw bytes into the stream.
+  void Put(const void* data, std::size_t size) {
+    if (size && std::fwrite(data, 1, size, out_) != size) {
+      SCRAM_THROW(IOError("Cannot write the columnar export."))
+          << boost::errinfo_errno(errno);
+    }
+    offset_ += size;
+  }
+
+  /// Writes an integer in the host byte order.
+  template <typename T>
+  void PutInt(T value) {
+    Put(&value, sizeof(value));
+  }
+
+  /// Pads the stream with zeros up to the alignment.
+  void Pad(int alignment) {
+    static const char zeros[kColumnAlignment] = {};
+    if (int remainder = offset_ % alignment)
+      Put(zeros, alignment - remainder);
+  }
+
+  std::FILE* out_;  ///< The destination stream.
+  std::uint64_t offset_;  ///< The current offset in the stream.
+  std::vector<Entry> directory_;  ///< The written columns.
+};
+
+/// Appends the current size of the values as the next CSR offset.
+template <typename T>
+void PushOffset(const std::vector<T>& values,
+                std::vector<std::int64_t>* offsets) {
+  offsets->push_back(values.size());
+}
+
+}  // namespace
+
+void Exporter::Export(const core::RiskAnalysis& risk_an, std::FILE* out) {
+  TIMER(DEBUG1, "Exporting analysis results");
+  const double kNan = std::numeric_limits<double>::quiet_NaN();
+
+  std::vector<std::string> event_names;
+  std::unordered_map<const mef::BasicEvent*, std::int32_t> event_indices;
+  auto get_index = [&event_names,
+                    &event_indices](const mef::BasicEvent& event) {
+    auto [it, inserted] = event_indices.emplace(&event, event_names.size());
+    if (inserted)
+      event_names.push_back(event.id());
+    return it->second;
+  };
+
+  std::vector<std::string> result_names;
+  std::vector<std::string> result_initiating_events;
+  std::vector<std::string> result_alignments;
+  std::vector<std::string> result_phases;
+  std::vector<double> result_probabilities;
+
+  std::vector<std::int64_t> product_result_offsets = {0};
+  std::vector<std::int64_t> literal_offsets = {0};
+  std::vector<std::int32_t> product_events;
+  std::vector<std::uint8_t> product_complements;
+  std::vector<double> product_probabilities;
+
+  std::vector<std::int64_t> importance_result_offsets = {0};
+  std::vector<std::int32_t> importance_events;
+  std::vector<std::int32_t> occurrences;
+  std::vector<double> mifs, cifs, difs, raws, rrws;
+
+  std::vector<std::int64_t> p_time_result_offsets = {0};
+  std::vector<double> times;
+  std::vector<double> time_values;
+
+  std::vector<double> pfd_avgs;
+  std::vector<double> pfh_avgs;
+  std::vector<double> pfd_fractions;
+  std::vector<double> pfh_fractions;
+
+  std::vector<double> means;
+  std::vector<double> sigmas;
+  std::vector<std::int64_t> sample_result_offsets = {0};
+  std::vector<double> samples;
+
+  std::vector<std::string> sequence_names;
+  std::vector<std::string> sequence_initiating_events;
+  std::vector<std::string> sequence_alignments;
+  std::vector<std::string> sequence_phases;
+  std::vector<double> sequence_probabilities;
+
+  for (const core::RiskAnalysis::Result& result : risk_an.results()) {
+    struct {
+      void operator()(const mef::Gate* gate) {
+        names.push_back(gate->id());
+        initiating_events.emplace_back();
+      }
+      void operator()(const std::pair<const mef::InitiatingEvent&,
+                                      const mef::Sequence&>& sequence) {
+        names.push_back(sequence.second.name());
+        initiating_events.push_back(sequence.first.name());
+      }
+      std::vector<std::string>& names;
+      std::vector<std::string>& initiating_events;
+    } extractor{result_names, result_initiating_events};
+    std::visit(extractor, result.id.target);
+    result_alignments.push_back(
+        result.id.context ? result.id.context->alignment.name() : "");
+    result_phases.push_back(
+        result.id.context ? result.id.context->phase.name() : "");
+
+    const core::ProbabilityAnalysis* prob_analysis =
+        result.probability_analysis.get();
+    result_probabilities.push_back(prob_analysis ? prob_analysis->p_total()
+                                                 : kNan);
+
+    if (const core::FaultTreeAnalysis* fta = result.fault_tree_analysis.get()) {
+      auto add_product = [&](const core::Product& product) {
+        for (const core::Literal& literal : product) {
+          product_events.push_back(get_index(literal.event));
+          product_complements.push_back(literal.complement);
+        }
+        PushOffset(product_events, &literal_offsets);
+        product_probabilities.push_back(prob_analysis ? product.p() : kNan);
+      };
+      if (int k = fta->settings().top_products(); k && prob_analysis) {
+        for (const core::Product& product : fta->products().top(k))
+          add_product(product);
+      } else {
+        for (const core::Product& product : fta->products())
+          add_product(product);
+      }
+    }
+    PushOffset(product_probabilities, &product_result_offsets);
+
+    if (result.importance_analysis) {
+      for (const core::ImportanceRecord& entry :
+           result.importance_analysis->importance()) {
+        importance_events.push_back(get_index(entry.event));
+        occurrences.push_back(entry.factors.occurrence);
+        mifs.push_back(entry.factors.mif);
+        cifs.push_back(entry.factors.cif);
+        difs.push_back(entry.factors.dif);
+        raws.push_back(entry.factors.raw);
+        rrws.push_back(entry.factors.rrw);
+      }
+    }
+    PushOffset(importance_events, &importance_result_offsets);
+
+    if (prob_analysis) {
+      for (const std::pair<double, double>& p_vs_time :
+           prob_analysis->p_time()) {
+        times.push_back(p_vs_time.second);
+        time_values.push_back(p_vs_time.first);
+      }
+    }
+    PushOffset(times, &p_time_result_offsets);
+
+    if (prob_analysis && prob_analysis->settings().safety_integrity_levels()) {
+      const core::Sil& sil = prob_analysis->sil();
+      pfd_avgs.push_back(sil.pfd_avg);
+      pfh_avgs.push_back(sil.pfh_avg);
+      for (const auto& bin : sil.pfd_fractions)
+        pfd_fractions.push_back(bin.second);
+      for (const auto& bin : sil.pfh_fractions)
+        pfh_fractions.push_back(bin.second);
+    } else {
+      pfd_avgs.push_back(kNan);
+      pfh_avgs.push_back(kNan);
+      pfd_fractions.insert(
+          pfd_fractions.end(),
+          std::tuple_size_v<decltype(core::Sil::pfd_fractions)>, kNan);
+      pfh_fractions.insert(
+          pfh_fractions.end(),
+          std::tuple_size_v<decltype(core::Sil::pfh_fractions)>, kNan);
+    }
+
+    if (const auto* uncert_analysis = result.uncertainty_analysis.get()) {
+      means.push_back(uncert_analysis->mean());
+      sigmas.push_back(uncert_analysis->sigma());
+      samples.insert(samples.end(), uncert_analysis->samples().begin(),
+                     uncert_analysis->samples().end());
+    } else {
+      means.push_back(kNan);
+      sigmas.push_back(kNan);
+    }
+    PushOffset(samples, &sample_result_offsets);
+  }
+
+  // The sequences quantified in a shared BDD have no results of their own.
+  for (const core::RiskAnalysis::EtaResult& eta_result :
+       risk_an.event_tree_results()) {
+    const core::EventTreeAnalysis& eta = *eta_result.event_tree_analysis;
+    for (const core::EventTreeAnalysis::Result& result : eta.sequences()) {
+      sequence_names.push_back(result.sequence.name());
+      sequence_initiating_events.push_back(eta.initiating_event().name());
+      sequence_alignments.push_back(
+          eta_result.context ? eta_result.context->alignment.name() : "");
+      sequence_phases.push_back(
+          eta_result.context ? eta_result.context->phase.name() : "");
+      sequence_probabilities.push_back(result.p_sequence);
+    }
+  }
+
+  ColumnFile file(out);
+  file.Write("events.name", event_names);
+
+  file.Write("results.name", result_names);
+  file.Write("results.initiating_event", result_initiating_events);
+  file.Write("results.alignment", result_alignments);
+  file.Write("results.phase", result_phases);
+  file.Write("results.probability", result_probabilities);
+
+  file.Write("products.result_offsets", product_result_offsets);
+  file.Write("products.literal_offsets", literal_offsets);
+  file.Write("products.event", product_events);
+  file.Write("products.complement", product_complements);
+  file.Write("products.probability", product_probabilities);
+
+  file.Write("importance.result_offsets", importance_result_offsets);
+  file.Write("importance.event", importance_events);
+  file.Write("importance.occurrence", occurrences);
+  file.Write("importance.mif", mifs);
+  file.Write("importance.cif", cifs);
+  file.Write("importance.dif", difs);
+  file.Write("importance.raw", raws);
+  file.Write("importance.rrw", rrws);
+
+  file.Write("p_time.result_offsets", p_time_result_offsets);
+  file.Write("p_time.time", times);
+  file.Write("p_time.value", time_values);
+
+  file.Write("sil.pfd_avg", pfd_avgs);
+  file.Write("sil.pfh_avg", pfh_avgs);
+  file.Write("sil.pfd_fractions", pfd_fractions);
+  file.Write("sil.pfh_fractions", pfh_fractions);
+
+  file.Write("uncertainty.mean", means);
+  file.Write("uncertainty.sigma", sigmas);
+  file.Write("samples.result_offsets", sample_result_offsets);
+  file.Write("samples.value", samples);
+
+  file.Write("sequences.name", sequence_names);
+  file.Write("sequences.initiating_event", sequence_initiating_events);
+  file.Write("sequences.alignment", sequence_alignments);
+  file.Write("sequences.phase", sequence_phases);
+  file.Write("sequences.probability", sequence_probabilities);
+  file.Close();
+
+  if (std::fflush(out)) {
+    SCRAM_THROW(IOError("Cannot write the columnar export."))
+        << boost::errinfo_errno(errno);
+  }
+}
+
+void Exporter::Export(const core::RiskAnalysis& risk_an,
+                      const std::string& file) {
+  const char* mode = "wb";
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> fp(
+      std::fopen(file.c_str(), mode), &std::fclose);
+  try {
+    if (!fp) {
+      SCRAM_THROW(IOError("Cannot open the output file for export."))
+          << boost::errinfo_errno(errno) << boost::errinfo_file_open_mode(mode);
+    }
+    Export(risk_an, fp.get());
+  } catch (IOError& err) {
+    err << boost::errinfo_file_name(file);
+    throw;
+  }
+}
+
+}  // namespace scram
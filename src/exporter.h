@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Exporter of results in a columnar binary format.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include <string>
+
+#include "risk_analysis.h"
+
+namespace scram {
+
+/// Exporter of analysis results as named flat arrays (columns)
+/// for zero-copy loading into analytics tools.
+///
+/// The file layout (all integers in the host byte order):
+///
+///   - Header (64 bytes): the "SCRAMCOL" magic, u32 format version,
+///     u32 byte-order mark 0x01020304, zero padding.
+///   - Column data, each column starting at a 64-byte aligned offset.
+///   - Directory: u64 number of columns, and per column:
+///     u64 offset, u64 number of elements, u32 type, u32 name length,
+///     and the UTF-8 name padded with zeros to 8 bytes.
+///   - Footer (16 bytes): u64 directory offset and the "SCRAMCOL" magic.
+///
+/// The column types are ColumnType values.
+/// String columns are stored as two columns,
+/// "<name>.offsets" (int64, size + 1) and "<name>.data" (uint8).
+/// Variable-length groups (e.g., products of a result)
+/// are stored in the CSR style with "*_offsets" (int64, size + 1) columns.
+class Exporter {
+ public:
+  /// The format version.
+  static constexpr std::uint32_t kVersion = 1;
+
+  /// The element types of columns.
+  enum ColumnType : std::uint32_t {
+    kUint8 = 0,
+    kInt32 = 1,
+    kInt64 = 2,
+    kFloat64 = 3
+  };
+
+  /// Exports the results of risk analysis.
+  ///
+  /// @param[in] risk_an  Risk analysis with results.
+  /// @param[out] out  The destination stream open in binary mode.
+  ///
+  /// @throws IOError  The write operation has failed.
+  void Export(const core::RiskAnalysis& risk_an, std::FILE* out);
+
+  /// A convenience function to export the results into a file.
+  /// This function overwrites the file.
+  ///
+  /// @param[in] risk_an  Risk analysis with results.
+  /// @param[out] file  The output destination.
+  ///
+  /// @throws IOError  The output file is not accessible,
+  ///                  or the write operation has failed.
+  void Export(const core::RiskAnalysis& risk_an, const std::string& file);
+};
+
+}  // namespace scram
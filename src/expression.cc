@@ -32,6 +32,8 @@ Expression::Expression(std::vector<Expression*> args)
     : args_(std::move(args)), sampled_value_(0), sampled_(false) {}
 
 double Expression::Sample() noexcept {
+  if (args_.empty())  // The constant leaves may be shared across threads.
+    return this->DoSample();
   if (!sampled_) {
     sampled_ = true;
     sampled_value_ = this->DoSample();
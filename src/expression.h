@@ -106,6 +106,12 @@ class Expression : private boost::noncopyable {
   virtual bool IsDeviate() noexcept;
 
   /// @returns A sampled value of this expression.
+  ///
+  /// @note Expressions without arguments are sampled
+  ///       without caching the value,
+  ///       so that the shared constants (e.g., ConstantExpression::kOne)
+  ///       are not written by concurrent analyses.
+  ///       Such expressions must not be random.
   double Sample() noexcept;
 
   /// This routine resets the sampling to get new values.
@@ -36,7 +36,29 @@
 
 namespace scram::mef {
 
-std::mt19937 RandomDeviate::rng_;
+thread_local std::mt19937 RandomDeviate::rng_;
+
+void GatherDeviates(Expression* expression,
+                    std::vector<RandomDeviate*>* deviates,
+                    std::unordered_set<Expression*>* visited) noexcept {
+  if (!expression->IsDeviate() || !visited->insert(expression).second)
+    return;
+  if (auto* deviate = dynamic_cast<RandomDeviate*>(expression)) {
+    deviates->push_back(deviate);
+    return;
+  }
+  for (Expression* arg : expression->args())
+    GatherDeviates(arg, deviates, visited);
+}
+
+namespace {
+
+/// @returns The standard normal quantile for a given probability.
+double StandardNormalQuantile(double p) noexcept {
+  return -std::sqrt(2) * boost::math::erfc_inv(2 * p);
+}
+
+}  // namespace
 
 UniformDeviate::UniformDeviate(Expression* min, Expression* max)
     : RandomDeviate({min, max}), min_(*min), max_(*max) {}
@@ -48,11 +70,16 @@ void UniformDeviate::Validate() const {
   }
 }
 
-double UniformDeviate::DoSample() noexcept {
+double UniformDeviate::Draw() noexcept {
   return std::uniform_real_distribution(min_.value(),
                                         max_.value())(RandomDeviate::rng());
 }
 
+double UniformDeviate::Quantile(double p) noexcept {
+  double min = min_.value();
+  return min + p * (max_.value() - min);
+}
+
 NormalDeviate::NormalDeviate(Expression* mean, Expression* sigma)
     : RandomDeviate({mean, sigma}), mean_(*mean), sigma_(*sigma) {}
 
@@ -62,11 +89,15 @@ void NormalDeviate::Validate() const {
   }
 }
 
-double NormalDeviate::DoSample() noexcept {
+double NormalDeviate::Draw() noexcept {
   return std::normal_distribution(mean_.value(),
                                   sigma_.value())(RandomDeviate::rng());
 }
 
+double NormalDeviate::Quantile(double p) noexcept {
+  return mean_.value() + sigma_.value() * StandardNormalQuantile(p);
+}
+
 LognormalDeviate::LognormalDeviate(Expression* mean, Expression* ef,
                                    Expression* level)
     : RandomDeviate({mean, ef, level}),
@@ -88,11 +119,16 @@ void LognormalDeviate::Logarithmic::Validate() const {
   }
 }
 
-double LognormalDeviate::DoSample() noexcept {
+double LognormalDeviate::Draw() noexcept {
   return std::lognormal_distribution(flavor_->location(),
                                      flavor_->scale())(RandomDeviate::rng());
 }
 
+double LognormalDeviate::Quantile(double p) noexcept {
+  return std::exp(flavor_->location() +
+                  flavor_->scale() * StandardNormalQuantile(p));
+}
+
 Interval LognormalDeviate::interval() noexcept {
   double high_estimate = std::exp(3 * flavor_->scale() + flavor_->location());
   return Interval::left_open(0, high_estimate);
@@ -139,11 +175,15 @@ Interval GammaDeviate::interval() noexcept {
   return Interval::left_open(0, high_estimate);
 }
 
-double GammaDeviate::DoSample() noexcept {
+double GammaDeviate::Draw() noexcept {
   return std::gamma_distribution(k_.value())(RandomDeviate::rng()) *
          theta_.value();
 }
 
+double GammaDeviate::Quantile(double p) noexcept {
+  return boost::math::gamma_p_inv(k_.value(), p) * theta_.value();
+}
+
 BetaDeviate::BetaDeviate(Expression* alpha, Expression* beta)
     : RandomDeviate({alpha, beta}), alpha_(*alpha), beta_(*beta) {}
 
@@ -165,11 +205,15 @@ Interval BetaDeviate::interval() noexcept {
   return Interval::closed(0, high_estimate);
 }
 
-double BetaDeviate::DoSample() noexcept {
+double BetaDeviate::Draw() noexcept {
   return boost::random::beta_distribution(alpha_.value(),
                                           beta_.value())(RandomDeviate::rng());
 }
 
+double BetaDeviate::Quantile(double p) noexcept {
+  return boost::math::ibeta_inv(alpha_.value(), beta_.value(), p);
+}
+
 Histogram::Histogram(std::vector<Expression*> boundaries,
                      std::vector<Expression*> weights)
     : RandomDeviate(std::move(boundaries)) {  // Partial registration!
@@ -225,7 +269,7 @@ auto make_sampler(const Iterator& it) {
 
 }  // namespace
 
-double Histogram::DoSample() noexcept {
+double Histogram::Draw() noexcept {
   // clang-format off
   return std::piecewise_constant_distribution<double>(
       make_sampler(boundaries_.begin()),
@@ -234,4 +278,25 @@ double Histogram::DoSample() noexcept {
   // clang-format on
 }
 
+double Histogram::Quantile(double p) noexcept {
+  // The weights are the interval masses as in the pseudo-random draws.
+  double total_mass = 0;
+  for (const auto& weight : weights_)
+    total_mass += weight->value();
+
+  // Linear interpolation within the interval of the cumulative mass.
+  double target = p * total_mass;
+  auto it_b = boundaries_.begin();
+  double lower = (*it_b)->value();
+  for (const auto& weight : weights_) {
+    double upper = (*++it_b)->value();
+    double cur_mass = weight->value();
+    if (target < cur_mass)
+      return lower + (upper - lower) * target / cur_mass;
+    target -= cur_mass;
+    lower = upper;
+  }
+  return lower;  // Rounding errors at the upper boundary.
+}
+
 }  // namespace scram::mef
@@ -21,8 +21,10 @@
 
 #pragma once
 
+#include <cassert>
 #include <memory>
 #include <random>
+#include <unordered_set>
 #include <vector>
 
 #include <boost/range/iterator_range.hpp>
@@ -49,17 +51,59 @@ class RandomDeviate : public Expression {
   ///
   /// @param[in] seed  The seed for RNGs.
   ///
-  /// @note This is static! Used by all the deriving deviates.
+  /// @note This is static! Used by all the deriving deviates
+  ///       in the calling thread.
   static void seed(unsigned seed) noexcept { rng_.seed(seed); }
 
- protected:
-  /// @returns RNG to be used by derived classes.
-  std::mt19937& rng() { return rng_; }
+  /// @returns The RNG shared by all the deviates and sampling strategies
+  ///          in the calling thread.
+  static std::mt19937& rng() noexcept { return rng_; }
+
+  /// Places the next sample at the given cumulative probability
+  /// instead of the pseudo-random draw.
+  /// Stratified and quasi-random sampling strategies
+  /// drive the deviates through their inverse distribution functions.
+  ///
+  /// @param[in] p  The cumulative probability in (0, 1);
+  ///               0 to return to the pseudo-random draws.
+  void quantile(double p) noexcept {
+    assert(p >= 0 && p < 1);
+    quantile_ = p;
+  }
 
  private:
-  static std::mt19937 rng_;  ///< The random number generator.
+  /// Samples with the inverse distribution function if requested.
+  double DoSample() noexcept final {
+    return quantile_ ? Quantile(quantile_) : Draw();
+  }
+
+  /// @returns A pseudo-random sample from the distribution.
+  virtual double Draw() noexcept = 0;
+
+  /// The inverse cumulative distribution function.
+  ///
+  /// @param[in] p  The cumulative probability in (0, 1).
+  ///
+  /// @returns The value of the distribution at the given probability.
+  virtual double Quantile(double p) noexcept = 0;
+
+  /// The random number generator per thread
+  /// for independent analyses in parallel.
+  static thread_local std::mt19937 rng_;
+  double quantile_ = 0;  ///< The requested cumulative probability.
 };
 
+/// Gathers the random deviates that determine the samples of an expression.
+/// The parameters of the deviates are not gathered
+/// because the deviates do not sample them.
+///
+/// @param[in] expression  The expression with the deviates.
+/// @param[in,out] deviates  The unique deviates in the order of discovery.
+/// @param[in,out] visited  The already visited expressions.
+void GatherDeviates(Expression* expression,
+                    std::vector<RandomDeviate*>* deviates,
+                    std::unordered_set<Expression*>* visited) noexcept;
+
 /// Uniform distribution.
 class UniformDeviate : public RandomDeviate {
  public:
@@ -78,7 +122,8 @@ class UniformDeviate : public RandomDeviate {
   }
 
  private:
-  double DoSample() noexcept override;
+  double Draw() noexcept override;
+  double Quantile(double p) noexcept override;
 
   Expression& min_;  ///< Minimum value of the distribution.
   Expression& max_;  ///< Maximum value of the distribution.
@@ -105,7 +150,8 @@ class NormalDeviate : public RandomDeviate {
   }
 
  private:
-  double DoSample() noexcept override;
+  double Draw() noexcept override;
+  double Quantile(double p) noexcept override;
 
   Expression& mean_;  ///< Mean value of normal distribution.
   Expression& sigma_;  ///< Standard deviation of normal distribution.
@@ -140,7 +186,8 @@ class LognormalDeviate : public RandomDeviate {
   Interval interval() noexcept override;
 
  private:
-  double DoSample() noexcept override;
+  double Draw() noexcept override;
+  double Quantile(double p) noexcept override;
 
   /// Support for parametrization differences.
   struct Flavor {
@@ -210,7 +257,8 @@ class GammaDeviate : public RandomDeviate {
   Interval interval() noexcept override;
 
  private:
-  double DoSample() noexcept override;
+  double Draw() noexcept override;
+  double Quantile(double p) noexcept override;
 
   Expression& k_;  ///< The shape parameter of the gamma distribution.
   Expression& theta_;  ///< The scale factor of the gamma distribution.
@@ -237,7 +285,8 @@ class BetaDeviate : public RandomDeviate {
   Interval interval() noexcept override;
 
  private:
-  double DoSample() noexcept override;
+  double Draw() noexcept override;
+  double Quantile(double p) noexcept override;
 
   Expression& alpha_;  ///< The alpha shape parameter.
   Expression& beta_;  ///< The beta shape parameter.
@@ -274,7 +323,8 @@ class Histogram : public RandomDeviate {
   using IteratorRange =
       boost::iterator_range<std::vector<Expression*>::const_iterator>;
 
-  double DoSample() noexcept override;
+  double Draw() noexcept override;
+  double Quantile(double p) noexcept override;
 
   IteratorRange boundaries_;  ///< Boundaries of the intervals.
   IteratorRange weights_;  ///< Weights of the intervals.
@@ -20,6 +20,7 @@
 
 #include "fault_tree_analysis.h"
 
+#include <algorithm>
 #include <iostream>
 #include <utility>
 
@@ -83,25 +84,55 @@ void Print(const ProductContainer& products) {
   std::cerr << std::endl;
 }
 
-ProductContainer::ProductContainer(const Zbdd& products,
-                                   const Pdag& graph) noexcept
-    : products_(products), graph_(graph), size_(0) {
-  Pdag::IndexMap<bool> filter(graph_.basic_events().size());
-  for (const std::vector<int>& product : products_) {
-    int order_index = product.empty() ? 0 : product.size() - 1;
-    if (distribution_.size() <= order_index)
-      distribution_.resize(order_index + 1);
-    distribution_[order_index]++;
-    ++size_;
-
-    for (int i : product) {
+const std::unordered_set<const mef::BasicEvent*>&
+ProductContainer::product_events() const {
+  if (!product_events_) {
+    product_events_.emplace();
+    Pdag::IndexMap<bool> filter(graph_.basic_events().size());
+    for (int i : products_.GatherLiterals()) {
       i = std::abs(i);
       if (filter[i])
         continue;
       filter[i] = true;
-      product_events_.insert(graph_.basic_events()[i]);
+      product_events_->insert(graph_.basic_events()[i]);
     }
   }
+  return *product_events_;
+}
+
+const std::vector<int>& ProductContainer::distribution() const {
+  if (distribution_.empty() && !products_.empty()) {
+    const std::vector<std::int64_t>& counts = products_.distribution();
+    int max_order = counts.size() - 1;
+    while (max_order > 0 && counts[max_order] == 0)
+      --max_order;
+    distribution_.resize(std::max(max_order, 1));
+    distribution_[0] = counts[0];  // The Base set is reported as order 1.
+    for (int i = 1; i <= max_order; ++i)
+      distribution_[i - 1] += counts[i];
+  }
+  return distribution_;
+}
+
+double ProductContainer::p_sum() const {
+  return products_.GetProbabilitySum(ExtractVariableProbabilities());
+}
+
+const std::vector<std::vector<int>>&
+ProductContainer::GetTopProducts(int k) const {
+  if (num_top_products_ != k) {
+    top_products_ = products_.GetTopProducts(k, ExtractVariableProbabilities());
+    num_top_products_ = k;
+  }
+  return top_products_;
+}
+
+Pdag::IndexMap<double> ProductContainer::ExtractVariableProbabilities() const {
+  Pdag::IndexMap<double> p_vars;
+  p_vars.reserve(graph_.basic_events().size());
+  for (const mef::BasicEvent* event : graph_.basic_events())
+    p_vars.push_back(event->p());
+  return p_vars;
 }
 
 double Product::p() const {
@@ -23,11 +23,13 @@
 #include <cstdlib>
 
 #include <memory>
+#include <optional>
 #include <unordered_set>
 #include <vector>
 
 #include <boost/iterator/iterator_facade.hpp>
 #include <boost/iterator/transform_iterator.hpp>
+#include <boost/range/adaptor/transformed.hpp>
 
 #include "analysis.h"
 #include "pdag.h"
@@ -106,6 +108,8 @@ class Product {
 
 /// A container of analysis result products with Literals.
 /// This is a wrapper of the analysis resultant ZBDD to work with Literals.
+/// The statistics of the products are computed lazily
+/// from the ZBDD structure without enumerating the products.
 class ProductContainer {
   /// Converter of analysis products with indices into products with literals.
   struct ProductExtractor {
@@ -119,16 +123,13 @@ class ProductContainer {
   };
 
  public:
-  /// The constructor also collects basic events in products.
-  ///
   /// @param[in] products  Sets with indices of events from calculations.
   /// @param[in] graph  PDAG with basic event indices and pointers.
-  ProductContainer(const Zbdd& products, const Pdag& graph) noexcept;
+  ProductContainer(const Zbdd& products, const Pdag& graph) noexcept
+      : products_(products), graph_(graph) {}
 
   /// @returns Collection of basic events that are in the products.
-  const std::unordered_set<const mef::BasicEvent*>& product_events() const {
-    return product_events_;
-  }
+  const std::unordered_set<const mef::BasicEvent*>& product_events() const;
 
   /// Begin and end iterators over products in the container.
   /// @{
@@ -142,22 +143,66 @@ class ProductContainer {
   }
   /// @}
 
+  /// Random access to products in the iteration order.
+  ///
+  /// @param[in] index  The position of the product in [0, size()).
+  /// @param[out] data  The storage for the product event indices.
+  ///
+  /// @returns The product wrapper over the data.
+  Product at(int index, std::vector<int>* data) const {
+    products_.GetProduct(index, data);
+    return Product(*data, graph_);
+  }
+
+  /// @param[in] k  The max number of products.
+  ///
+  /// @returns The most probable products
+  ///          in non-increasing order of probabilities.
+  ///
+  /// @pre Events are initialized with expressions.
+  auto top(int k) const {
+    return GetTopProducts(k) |
+           boost::adaptors::transformed(ProductExtractor{graph_});
+  }
+
+  /// Drops the cached most probable products
+  /// after changes in the event probabilities.
+  void ClearTopProducts() const noexcept {
+    num_top_products_ = 0;
+    top_products_.clear();
+  }
+
+  /// @returns The sum of the product probabilities.
+  ///
+  /// @pre Events are initialized with expressions.
+  double p_sum() const;
+
   /// @returns true if no products in the container.
   bool empty() const { return products_.empty(); }
 
   /// @returns The number of products in the container.
-  int size() const { return size_; }
+  int size() const { return products_.size(); }
 
   /// @returns The product distribution by order.
-  const std::vector<int>& distribution() const { return distribution_; }
+  const std::vector<int>& distribution() const;
 
  private:
+  /// @param[in] k  The max number of products.
+  ///
+  /// @returns The cached most probable products.
+  const std::vector<std::vector<int>>& GetTopProducts(int k) const;
+
+  /// @returns The probabilities of the graph variables.
+  Pdag::IndexMap<double> ExtractVariableProbabilities() const;
+
   const Zbdd& products_;  ///< Container of analysis results.
   const Pdag& graph_;  ///< The analysis graph.
-  int size_;  ///< The number of products.
-  std::vector<int> distribution_;  ///< Product counts by order.
+  mutable std::vector<int> distribution_;  ///< Product counts by order.
+  mutable int num_top_products_ = 0;  ///< The size of the cache.
+  mutable std::vector<std::vector<int>> top_products_;  ///< The cache.
   /// The set of events in the resultant products.
-  std::unordered_set<const mef::BasicEvent*> product_events_;
+  mutable std::optional<std::unordered_set<const mef::BasicEvent*>>
+      product_events_;
 };
 
 /// Prints a collection of products to the standard error.
@@ -291,7 +336,7 @@ class FaultTreeAnalyzer : public FaultTreeAnalysis {
 
  private:
   void Preprocess(Pdag* graph) noexcept override {
-    CustomPreprocessor<Algorithm>{graph}();
+    CustomPreprocessor<Algorithm>{graph, Analysis::settings()}();
   }
 
   const Zbdd& GenerateProducts(const Pdag* graph) noexcept override {
@@ -75,16 +75,12 @@ double ImportanceAnalyzer<Bdd>::CalculateMif(int index) noexcept {
   const Bdd::VertexPtr& root = bdd_graph_->root().vertex;
   if (root->terminal())
     return 0;
-  bool original_mark = Ite::Ref(root).mark();
-
   int order = bdd_graph_->index_to_order().find(index)->second;
-  double mif = CalculateMif(root, order, !original_mark);
-  bdd_graph_->ClearMarks(original_mark);
-  return mif;
+  return CalculateMif(root, order, Ite::NewMark());
 }
 
 double ImportanceAnalyzer<Bdd>::CalculateMif(const Bdd::VertexPtr& vertex,
-                                             int order, bool mark) noexcept {
+                                             int order, int mark) noexcept {
   if (vertex->terminal())
     return 0;
   Ite& ite = Ite::Ref(vertex);
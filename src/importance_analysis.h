@@ -176,15 +176,13 @@ class ImportanceAnalyzer<Bdd> : public ImportanceAnalyzerBase {
   ///
   /// @param[in] vertex  The root vertex of a function graph.
   /// @param[in] order  The identifying order of the variable.
-  /// @param[in] mark  A flag to mark traversed vertices.
+  /// @param[in] mark  The unique mark of this traversal.
   ///
   /// @returns Importance factor value.
   ///
   /// @note Probability factor fields are used to save results.
-  /// @note The graph needs cleaning its marks after this function
-  ///       because the graph gets continuously-but-partially marked.
   double CalculateMif(const Bdd::VertexPtr& vertex, int order,
-                      bool mark) noexcept;
+                      int mark) noexcept;
 
   /// Retrieves memorized probability values for BDD function graphs.
   ///
@@ -157,10 +157,12 @@ ConstructElement<Phase>(const xml::Element& xml_element) {
 
 Initializer::Initializer(const std::vector<std::string>& xml_files,
                          core::Settings settings, bool allow_extern,
-                         xml::Validator* extra_validator)
+                         xml::Validator* extra_validator,
+                         xml::DocumentCache* document_cache)
     : settings_(std::move(settings)),
       allow_extern_(allow_extern),
-      extra_validator_(extra_validator) {
+      extra_validator_(extra_validator),
+      document_cache_(document_cache) {
   BLOG(WARNING, allow_extern_) << "Enabling external dynamic libraries";
   ProcessInputFiles(xml_files);
 }
@@ -198,18 +200,21 @@ void Initializer::ProcessInputFiles(const std::vector<std::string>& xml_files) {
   for (const auto& xml_file : xml_files) {
     CLOCK(parse_time);
     LOG(DEBUG3) << "Parsing " << xml_file << " ...";
-    xml::Document document(xml_file, &validator);
+    std::shared_ptr<const xml::Document> document =
+        document_cache_
+            ? document_cache_->Get(xml_file, &validator)
+            : std::make_shared<const xml::Document>(xml_file, &validator);
     if (extra_validator_)
-      extra_validator_->validate(document);
-    documents_.emplace_back(std::move(document));
+      extra_validator_->validate(*document);
+    documents_.push_back(std::move(document));
     LOG(DEBUG3) << "Parsed " << xml_file << " in " << DUR(parse_time);
   }
   CLOCK(def_time);
-  for (const xml::Document& document : documents_) {
+  for (const auto& document : documents_) {
     try {
-      ProcessInputFile(document);
+      ProcessInputFile(*document);
     } catch (ValidityError& err) {
-      err << boost::errinfo_file_name(document.root().filename());
+      err << boost::errinfo_file_name(document->root().filename());
       throw;
     }
   }
@@ -591,8 +596,8 @@ void Initializer::Define(const xml::Element& xml_node,
 /// @}
 
 void Initializer::ProcessTbdElements() {
-  for (const xml::Document& document : documents_) {
-    xml::Element root = document.root();
+  for (const auto& document : documents_) {
+    xml::Element root = document->root();
     for (const xml::Element& node : root.children("define-extern-function")) {
       try {
         DefineExternFunction(node);
@@ -68,6 +68,8 @@ class Initializer : private boost::noncopyable {
   /// @param[in] allow_extern  Allow external libraries in the input.
   /// @param[in] extra_validator  Additional XML validator to be run
   ///                             after the MEF validator.
+  /// @param[in] document_cache  Optional cache of the parsed input files
+  ///                            shared with other initializations.
   ///
   /// @throws IOError  Input contains duplicate files.
   /// @throws IOError  One of the input files is not accessible.
@@ -80,7 +82,8 @@ class Initializer : private boost::noncopyable {
   ///          Enable this feature for trusted input files and libraries only.
   Initializer(const std::vector<std::string>& xml_files,
               core::Settings settings, bool allow_extern = false,
-              xml::Validator* extra_validator = nullptr);
+              xml::Validator* extra_validator = nullptr,
+              xml::DocumentCache* document_cache = nullptr);
 
   /// @returns The model built from the input files.
   std::unique_ptr<Model> model() && { return std::move(model_); }
@@ -494,9 +497,10 @@ class Initializer : private boost::noncopyable {
   core::Settings settings_;  ///< Settings for analysis.
   bool allow_extern_;  ///< Allow processing MEF 'extern-library'.
   xml::Validator* extra_validator_;  ///< The optional extra XML validation.
+  xml::DocumentCache* document_cache_;  ///< The optional shared documents.
 
   /// Saved XML documents to keep elements alive.
-  std::vector<xml::Document> documents_;
+  std::vector<std::shared_ptr<const xml::Document>> documents_;
 
   /// Collection of elements that are defined late
   /// because of unordered registration and definition of their dependencies.
@@ -16,16 +16,189 @@
  */
 
 /// @file
-/// Initializing static members and member functions of Logger class.
+/// Initializing static members and member functions of Logger class
+/// with the background writer of the per-thread log queues.
 
 #include "logger.h"
 
 #include <cstdio>
+#include <cstdlib>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace scram {
 
+namespace {
+
+/// Lock-free single-producer single-consumer queue of log records.
+/// The producer is the owner thread,
+/// and the consumer is the writer holding the writer lock.
+class RecordRing {
+ public:
+  /// Queues a log record.
+  ///
+  /// @param[in,out] record  The record to be taken
+  ///                        and replaced with a spare buffer.
+  ///
+  /// @returns false if the queue is full.
+  bool Push(std::string* record) noexcept {
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == kCapacity)
+      return false;
+    slots_[head % kCapacity].swap(*record);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Writes all the queued records into the stream.
+  ///
+  /// @param[in] out  The destination stream.
+  ///
+  /// @returns true if any records have been written.
+  bool Drain(std::FILE* out) noexcept {
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    std::size_t head = head_.load(std::memory_order_acquire);
+    if (tail == head)
+      return false;
+    for (; tail != head; ++tail) {
+      std::string& slot = slots_[tail % kCapacity];
+      std::fwrite(slot.data(), 1, slot.size(), out);
+      slot.clear();  // The buffer is reused by the producer.
+    }
+    tail_.store(tail, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  static const std::size_t kCapacity = 1 << 10;  ///< The number of slots.
+
+  std::array<std::string, kCapacity> slots_;  ///< The records.
+  alignas(64) std::atomic<std::size_t> head_{0};  ///< The next push.
+  alignas(64) std::atomic<std::size_t> tail_{0};  ///< The next drain.
+};
+
+/// The background writer of the log queues into the standard error.
+class Writer {
+ public:
+  /// The period of polling the log queues.
+  static constexpr std::chrono::milliseconds kPeriod{10};
+
+  /// Starts the background thread.
+  Writer() : stop_(false), thread_([this] { Run(); }) {}
+
+  /// Writes the remaining records and stops the background thread.
+  ~Writer() noexcept {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    condition_.notify_one();
+    thread_.join();
+    Flush();
+  }
+
+  /// @returns A new queue for the calling thread.
+  std::shared_ptr<RecordRing> Register() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return rings_.emplace_back(std::make_shared<RecordRing>());
+  }
+
+  /// Writes all the queued records.
+  void Flush() noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DrainAll();
+  }
+
+  /// Writes all the queued records followed by the given record.
+  ///
+  /// @param[in] record  The record to be written right away.
+  void Write(const std::string& record) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DrainAll();
+    std::fputs(record.c_str(), stderr);
+    std::fflush(stderr);
+  }
+
+ private:
+  /// Drains the queues periodically.
+  void Run() noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+      condition_.wait_for(lock, kPeriod);
+      DrainAll();
+      // The queues of finished threads are released after draining.
+      rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                  [](const std::shared_ptr<RecordRing>& ring) {
+                                    return ring.use_count() == 1;
+                                  }),
+                   rings_.end());
+    }
+  }
+
+  /// Drains all the queues.
+  ///
+  /// @pre The writer lock is held.
+  void DrainAll() noexcept {
+    bool written = false;
+    for (const std::shared_ptr<RecordRing>& ring : rings_)
+      written |= ring->Drain(stderr);
+    if (written)
+      std::fflush(stderr);
+  }
+
+  std::mutex mutex_;  ///< The lock for the queue list and consumption.
+  std::condition_variable condition_;  ///< The notification of the stop.
+  bool stop_;  ///< The indication to stop the background thread.
+  std::vector<std::shared_ptr<RecordRing>> rings_;  ///< The thread queues.
+  std::thread thread_;  ///< The background writer thread.
+};
+
+std::atomic<bool> writer_alive(false);  ///< Guard for the exit time logging.
+
+/// The termination handler replaced by the logger.
+std::terminate_handler previous_terminate = nullptr;
+
+/// Writes the queued log records before the abnormal termination.
+[[noreturn]] void FlushAndTerminate() noexcept {
+  Logger::Flush();
+  if (previous_terminate)
+    previous_terminate();
+  std::abort();
+}
+
+/// @returns The writer of the log queues started upon the first use,
+///          or nullptr if the writer has stopped at the program exit.
+Writer* GetWriter() {
+  static Writer writer;
+  static struct Guard {  // Destroyed before the writer.
+    Guard() {
+      writer_alive = true;
+      previous_terminate = std::set_terminate(&FlushAndTerminate);
+    }
+    ~Guard() { writer_alive = false; }
+  } guard;
+  return writer_alive ? &writer : nullptr;
+}
+
+/// @returns The unique small id of the calling thread.
+int GetThreadId() noexcept {
+  static std::atomic<int> next_id(0);
+  thread_local int id = next_id++;
+  return id;
+}
+
+}  // namespace
+
 const char* const Logger::kLevelToString_[] = {"ERROR",  "WARNING", "INFO",
                                                "DEBUG1", "DEBUG2",  "DEBUG3",
                                                "DEBUG4", "DEBUG5"};
@@ -33,12 +206,29 @@ LogLevel Logger::report_level_ = ERROR;
 
 Logger::~Logger() noexcept {
   os_ << "\n";
-  std::fputs(os_.str().c_str(), stderr);  // stdio is used for thread safety.
-  std::fflush(stderr);  // Should be no-op for the unbuffered stderr.
+  std::string record = os_.str();
+  Writer* writer = GetWriter();
+  if (!writer) {
+    std::fputs(record.c_str(), stderr);  // Logging at the program exit.
+    return;
+  }
+  if (level_ <= WARNING) {  // The failures may follow without the exit.
+    writer->Write(record);
+    return;
+  }
+  thread_local std::shared_ptr<RecordRing> ring = writer->Register();
+  while (!ring->Push(&record))
+    writer->Flush();  // The queue is full; the producer drains all.
+}
+
+void Logger::Flush() noexcept {
+  if (writer_alive)
+    GetWriter()->Flush();
 }
 
 std::ostringstream& Logger::Get(LogLevel level) {
-  os_ << Logger::kLevelToString_[level] << ": ";
+  level_ = level;
+  os_ << Logger::kLevelToString_[level] << " [T" << GetThreadId() << "]: ";
   if (level > INFO)
     os_ << std::string(level - INFO, '\t');
   return os_;
@@ -25,6 +25,14 @@
 ///
 /// The timing facilities are inspired by
 /// the talk of Bryce Adelstein "Benchmarking C++ Code" at CppCon 2015.
+///
+/// The log records are queued into lock-free per-thread ring buffers
+/// and written to the standard error by a background thread.
+/// The errors and warnings are written right away
+/// together with the queued records,
+/// and the queues are flushed upon std::terminate.
+/// The logging sites deeper than SCRAM_LOG_MAX_LEVEL
+/// are eliminated at compile time.
 
 #pragma once
 
@@ -55,10 +63,19 @@ namespace scram {
 #define TIMER(level, ...) \
   Timer<level> BOOST_PP_CAT(timer_, __LINE__)(__VA_ARGS__)
 
+/// The maximum log level compiled into the code (DEBUG5 by default).
+#ifndef SCRAM_LOG_MAX_LEVEL
+#define SCRAM_LOG_MAX_LEVEL 7
+#endif
+
 // clang-format off
 /// Logging with a level.
+/// The level check is a compile-time constant
+/// for levels beyond the compiled maximum.
 #define LOG(level) \
-  if (level <= scram::Logger::report_level()) scram::Logger().Get(level)
+  if (level <= scram::kMaxLogLevel && \
+      level <= scram::Logger::report_level()) \
+    scram::Logger().Get(level)
 
 /// Conditional logging with a level.
 #define BLOG(level, cond) \
@@ -84,9 +101,16 @@ enum LogLevel {  // The numbers are used for array indices.
 
 const int kMaxVerbosity = 7;  ///< The index of the last level.
 
+/// The deepest level of logging sites kept in the code.
+const int kMaxLogLevel = SCRAM_LOG_MAX_LEVEL;
+
 /// This is a general purpose logger;
 /// however, its main usage is asserted to be for debugging.
-/// All messages are directed to the standard error in a thread-safe way.
+/// All messages are directed to the standard error in a thread-safe way
+/// with the ids of the logging threads.
+/// The messages of each thread keep their order;
+/// however, messages of different threads may be interleaved
+/// in the order other than of their creation.
 /// This class may be expanded and modified in future
 /// to include more levels, prefixes, and logging types
 /// if it deems necessary.
@@ -99,7 +123,8 @@ const int kMaxVerbosity = 7;  ///< The index of the last level.
 ///          because it will mess up the level-dependent printing.
 class Logger : private boost::noncopyable {
  public:
-  /// Flashes all the logs into the standard error upon destruction.
+  /// Queues the log record for the standard error upon destruction.
+  /// The errors and warnings are written without queuing.
   ~Logger() noexcept;
 
   /// @returns Reference to the cut-off level for reporting.
@@ -108,10 +133,17 @@ class Logger : private boost::noncopyable {
   /// Sets the reporting level cut-off.
   ///
   /// @param[in] level  The maximum level of logging.
+  ///
+  /// @pre No other threads are logging.
   static void report_level(LogLevel level) { report_level_ = level; }
 
+  /// Writes all the queued log records into the standard error.
+  /// The queues are also flushed at the program exit
+  /// and upon std::terminate.
+  static void Flush() noexcept;
+
   /// Returns a string stream by reference
-  /// that is flushed to stderr by the Logger class destructor.
+  /// that is queued for stderr by the Logger class destructor.
   ///
   /// @param[in] level  The log level for the information.
   ///
@@ -125,11 +157,15 @@ class Logger : private boost::noncopyable {
 
   static LogLevel report_level_;  ///< Cut-off log level for reporting.
 
+  LogLevel level_ = ERROR;  ///< The level of the log record.
   std::ostringstream os_;  ///< Main stringstream to gather the logs.
 };
 
 /// Automatic (scoped) timer to log process duration.
-template <LogLevel Level>
+///
+/// @tparam Level  The log level of the timing.
+/// @tparam Enabled  The level is compiled in.
+template <LogLevel Level, bool Enabled = (Level <= kMaxLogLevel)>
 class Timer {
  public:
   /// @param[in] process_name  The process being logged.
@@ -148,4 +184,12 @@ class Timer {
   std::uint64_t process_time_;  ///< The process start time.
 };
 
+/// No-op timer for the levels eliminated at compile time.
+template <LogLevel Level>
+class Timer<Level, false> {
+ public:
+  /// @param[in] process_name  The ignored process name.
+  explicit Timer(const char* /*process_name*/) {}
+};
+
 }  // namespace scram
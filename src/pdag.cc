@@ -29,6 +29,7 @@
 #include <string>
 #include <unordered_set>
 
+#include <boost/functional/hash.hpp>
 #include <boost/math/special_functions/sign.hpp>
 #include <boost/range/algorithm.hpp>
 
@@ -47,30 +48,47 @@ void NodeParentManager::AddParent(const GatePtr& gate) {
 
 Node::Node(Pdag* graph) noexcept
     : index_(Pdag::NodeIndexGenerator()(graph)),
-      order_(0),
-      visits_{},
-      opti_value_(0),
-      pos_count_(0),
-      neg_count_(0),
-      graph_(*graph) {}
+      graph_(*graph) {
+  Pdag::NodeRegistrar().Insert(graph);
+}
 
-Node::~Node() = default;
+Node::~Node() { Pdag::NodeRegistrar().Erase(&graph_); }
 
 Gate::Gate(Connective type, Pdag* graph) noexcept
     : Node(graph),
       type_(type),
-      mark_(false),
       module_(false),
       coherent_(false),
+      hashed_(false),
+      pending_(false),
       min_number_(0),
-      descendant_(0),
-      ancestor_(0),
       min_time_(0),
       max_time_(0) {}
 
+Gate::~Gate() noexcept {
+  assert(Node::parents().empty());
+  if (hashed_)
+    Pdag::GateTableRegistrar().Erase(this);
+  hashed_ = false;
+  pending_ = true;  // No more registration of changes.
+  EraseArgs();
+}
+
+void Gate::RegisterChange() noexcept {
+  if (hashed_) {
+    hashed_ = false;
+    Pdag::GateTableRegistrar().Erase(this);
+  }
+  if (!pending_) {
+    pending_ = true;
+    Pdag::GateTableRegistrar().Queue(this);
+  }
+}
+
 void Gate::type(Connective type) {  // Don't use in Gate constructor!
   /// @todo Find the inefficient resets.
   /* assert(type_ != type && "Attribute reset: Operation with no effect."); */
+  Touch();
   type_ = type;
   if (type_ == kNull)
     Pdag::NullGateRegistrar()(shared_from_this());
@@ -79,7 +97,7 @@ void Gate::type(Connective type) {  // Don't use in Gate constructor!
 GatePtr Gate::Clone() noexcept {
   BLOG(DEBUG5, module_) << "WARNING: Cloning module G" << Node::index();
   assert(!constant() && type_ != kNull);
-  auto clone = std::make_shared<Gate>(type_, &Node::graph());  // The same type.
+  auto clone = Node::graph().MakeNode<Gate>(type_);  // The same type.
   clone->coherent_ = coherent_;
   clone->min_number_ = min_number_;  // Copy min number in case it is K/N.
   // Getting arguments copied.
@@ -87,6 +105,7 @@ GatePtr Gate::Clone() noexcept {
   clone->gate_args_ = gate_args_;
   clone->variable_args_ = variable_args_;
   clone->constant_ = constant_;
+  clone->Touch();
   // Introducing the new parent to the args.
   for (const auto& arg : gate_args_)
     arg.second->AddParent(clone);
@@ -163,6 +182,7 @@ template <>
 void Gate::AddArg<Constant>(int index, const ConstantPtr& arg) noexcept {
   assert(!constant_);
   assert(arg->value());
+  Touch();
   return index > 0 ? AddConstantArg<true>() : AddConstantArg<false>();
 }
 
@@ -170,6 +190,7 @@ void Gate::TransferArg(int index, const GatePtr& recipient) noexcept {
   assert(!constant() && "Improper use case.");
   assert(index != 0);
   assert(args_.count(index));
+  Touch();
   args_.erase(index);
 
   if (auto it_g = ext::find(gate_args_, index)) {
@@ -199,6 +220,7 @@ void Gate::ShareArg(int index, const GatePtr& recipient) noexcept {
 void Gate::NegateArgs() noexcept {
   /* assert(!constant() && "Improper use case."); */
   /// @todo Consider in place inversion.
+  Touch();
   ArgSet inverted_args;
   for (auto it = args_.rbegin(); it != args_.rend(); ++it)
     inverted_args.insert(inverted_args.end(), -*it);
@@ -215,6 +237,7 @@ void Gate::NegateArg(int existing_arg) noexcept {
   assert(args_.count(existing_arg));
   assert(!args_.count(-existing_arg));
 
+  Touch();
   args_.erase(existing_arg);
   args_.insert(-existing_arg);
 
@@ -232,6 +255,7 @@ void Gate::CoalesceGate(const GatePtr& arg_gate) noexcept {
   assert(args_.count(arg_gate->index()) && "Cannot join complement gate.");
   assert(!arg_gate->constant() && "Impossible to join.");
   assert(!arg_gate->args().empty() && "Corrupted gate.");
+  Touch();
 
   for (const auto& arg : arg_gate->gate_args_) {
     AddArg(arg);
@@ -254,6 +278,7 @@ void Gate::JoinNullGate(int index) noexcept {
   assert(args_.count(index));
   assert(gate_args_.count(index));
 
+  Touch();
   args_.erase(index);
   auto it_g = gate_args_.find(index);
   GatePtr null_gate = it_g->second;
@@ -287,6 +312,7 @@ void Gate::ProcessConstantArg(const NodePtr& arg, bool state) noexcept {
 void Gate::EraseArg(int index) noexcept {
   assert(index != 0);
   assert(args_.count(index));
+  Touch();
   args_.erase(index);
 
   if (auto it_g = ext::find(gate_args_, index)) {
@@ -305,6 +331,7 @@ void Gate::EraseArg(int index) noexcept {
 }
 
 void Gate::EraseArgs() noexcept {
+  Touch();
   args_.clear();
   for (const auto& arg : gate_args_)
     arg.second->EraseParent(Node::index());
@@ -393,7 +420,7 @@ void Gate::ProcessAtleastGateDuplicateArg(int index) noexcept {
     assert(this->args_.size() == 2);
   } else {
     // Create the AND gate to combine with the duplicate node.
-    auto and_gate = std::make_shared<Gate>(kAnd, &Node::graph());
+    auto and_gate = Node::graph().MakeNode<Gate>(kAnd);
     this->AddArg(and_gate);
     clone_one->TransferArg(index, and_gate);  // Transferred the x.
 
@@ -448,6 +475,7 @@ void Gate::ProcessComplementArg(int index) noexcept {
 
 Pdag::Pdag() noexcept
     : node_index_(0),
+      num_nodes_(0),
       complement_(false),
       coherent_(true),
       normal_(true),
@@ -467,7 +495,7 @@ Pdag::Pdag(const mef::Gate& root, bool ccf, const mef::Model* model) noexcept
   root_ = ConstructGate(root.formula(), ccf, &nodes);
 
   if (model) {  // Process substitution application.
-    auto application = std::make_shared<Gate>(kAnd, this);
+    auto application = MakeNode<Gate>(kAnd);
     for (const mef::Substitution& substitution : model->substitutions()) {
       if (substitution.declarative()) {  // Apply declarative substitutions.
         application->AddArg(ConstructSubstitution(substitution, ccf, &nodes));
@@ -483,6 +511,60 @@ Pdag::Pdag(const mef::Gate& root, bool ccf, const mef::Model* model) noexcept
   }
 }
 
+Pdag::~Pdag() noexcept {
+  root_.reset();
+  constant_.reset();
+  assert(!num_nodes_ && "Pooled nodes must not outlive the graph.");
+}
+
+std::size_t Pdag::GateHash::operator()(const Gate* gate) const noexcept {
+  std::size_t seed =
+      boost::hash_range(gate->args().begin(), gate->args().end());
+  boost::hash_combine(seed, static_cast<int>(gate->type()));
+  if (gate->type() == kAtleast)
+    boost::hash_combine(seed, gate->min_number());
+  return seed;
+}
+
+bool Pdag::GateEqual::operator()(const Gate* lhs,
+                                 const Gate* rhs) const noexcept {
+  if (lhs->type() != rhs->type() || lhs->args() != rhs->args())
+    return false;
+  if (lhs->type() == kAtleast && lhs->min_number() != rhs->min_number())
+    return false;
+  return true;
+}
+
+std::unordered_map<GatePtr, std::vector<GateWeakPtr>>
+Pdag::GetMultipleDefinitions() noexcept {
+  std::unordered_map<GatePtr, std::vector<GateWeakPtr>> multi_def;
+  std::vector<GateWeakPtr> changed_gates;
+  changed_gates.swap(pending_gates_);
+  for (GateWeakPtr& ptr : changed_gates) {
+    GatePtr gate = ptr.lock();
+    if (!gate)
+      continue;
+    assert(gate->pending_ && !gate->hashed_);
+    // Modules are unique by definition.
+    if (gate->constant() || gate->module() ||
+        (gate->parents().empty() && gate != root_)) {
+      pending_gates_.push_back(std::move(ptr));
+      continue;
+    }
+    auto [it, inserted] = gate_table_.insert(gate.get());
+    if (inserted) {
+      gate->pending_ = false;
+      gate->hashed_ = true;
+    } else if ((*it)->module()) {
+      pending_gates_.push_back(std::move(ptr));
+    } else {  // The gate is duplicate.
+      gate->pending_ = false;
+      multi_def[(*it)->shared_from_this()].push_back(std::move(ptr));
+    }
+  }
+  return multi_def;
+}
+
 void Pdag::Print() {
   Clear<kVisit>();
   std::cerr << "\n" << this << std::endl;
@@ -532,7 +614,7 @@ void Pdag::GatherVariables(const mef::BasicEvent& basic_event, bool ccf,
     VariablePtr& var = nodes->variables[&basic_event];
     if (!var) {
       basic_events_.push_back(&basic_event);
-      var = std::make_shared<Variable>(this);  // Sequential indices.
+      var = MakeNode<Variable>();  // Sequential indices.
       assert((kVariableStartIndex + basic_events_.size() - 1) == var->index());
     }
   }
@@ -558,7 +640,7 @@ void Pdag::AddArg(const GatePtr& parent, const T& event, bool complement,
     (void)ccf;
     (void)nodes;
     // Create unique pass-through gates to hold the construction invariant.
-    auto null_gate = std::make_shared<Gate>(kNull, this);
+    auto null_gate = MakeNode<Gate>(kNull);
     null_gate->AddArg(constant_, complement ^ !event.state());
     parent->AddArg(null_gate);
     null_gates_.push_back(null_gate);
@@ -606,7 +688,7 @@ GatePtr Pdag::ConstructGate(const mef::Formula& formula, bool ccf,
     return ConstructComplexGate(formula, ccf, nodes);
 
   Connective type = static_cast<Connective>(formula.connective());
-  auto parent = std::make_shared<Gate>(type, this);
+  auto parent = MakeNode<Gate>(type);
 
   if (type != kOr && type != kAnd)
     normal_ = false;
@@ -644,8 +726,8 @@ GatePtr Pdag::ConstructComplexGate(const mef::Formula& formula, bool ccf,
     case mef::kIff: {
       assert(formula.args().size() == 2);
       normal_ = false;
-      auto parent = std::make_shared<Gate>(kNull, this);
-      auto arg_gate = std::make_shared<Gate>(kXor, this);
+      auto parent = MakeNode<Gate>(kNull);
+      auto arg_gate = MakeNode<Gate>(kXor);
 
       for (const mef::Formula::Arg& arg : formula.args()) {
         AddArg(arg_gate, arg.event, arg.complement, ccf, nodes);
@@ -656,7 +738,7 @@ GatePtr Pdag::ConstructComplexGate(const mef::Formula& formula, bool ccf,
     }
     case mef::kImply: {
       assert(formula.args().size() == 2);
-      auto parent = std::make_shared<Gate>(kOr, this);
+      auto parent = MakeNode<Gate>(kOr);
       AddArg(parent, formula.args().front().event,
              !formula.args().front().complement, ccf, nodes);
       AddArg(parent, formula.args().back().event,
@@ -667,8 +749,8 @@ GatePtr Pdag::ConstructComplexGate(const mef::Formula& formula, bool ccf,
       assert(formula.args().size() >= *formula.max_number());
       assert(*formula.min_number() <= *formula.max_number());
       normal_ = false;
-      auto parent = std::make_shared<Gate>(kAnd, this);
-      auto first_arg = std::make_shared<Gate>(kAtleast, this);
+      auto parent = MakeNode<Gate>(kAnd);
+      auto first_arg = MakeNode<Gate>(kAtleast);
       first_arg->min_number(*formula.min_number());
       for (const mef::Formula::Arg& arg : formula.args()) {
         AddArg(first_arg, arg.event, arg.complement, ccf, nodes);
@@ -701,7 +783,7 @@ GatePtr Pdag::ConstructComplexGate(const mef::Formula& formula, bool ccf,
 GatePtr Pdag::ConstructSubstitution(const mef::Substitution& substitution,
                                     bool ccf, ProcessedNodes* nodes) noexcept {
   assert(substitution.declarative() && "Only declarative substitutions.");
-  auto implication = std::make_shared<Gate>(kOr, this);
+  auto implication = MakeNode<Gate>(kOr);
   implication->AddArg(ConstructGate(substitution.hypothesis(), ccf, nodes),
                       /*complement=*/true);
   if (auto* target = std::get_if<mef::BasicEvent*>(&substitution.target())) {
@@ -888,7 +970,7 @@ struct GraphLogger {
 }  // namespace
 
 void Pdag::Log() noexcept {
-  if (DEBUG4 > scram::Logger::report_level())
+  if (DEBUG4 > kMaxLogLevel || DEBUG4 > Logger::report_level())
     return;
   Clear<kGateMark>();
   GraphLogger logger(root_);
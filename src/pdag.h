@@ -33,10 +33,13 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <array>
 #include <iosfwd>
 #include <memory>
+#include <memory_resource>
 #include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -104,6 +107,48 @@ class NodeParentManager : private boost::noncopyable {
 
 class Pdag;  // Manager of the graph, node indices and uniqueness.
 
+/// A node mark value stamped with the epoch of its kind of the mark.
+/// The value is implicitly clear if its stamp is not the current epoch;
+/// that is, the marks of the whole graph are cleared
+/// by starting a new epoch in constant time.
+///
+/// @tparam T  The default constructible value type with the clear default.
+template <typename T>
+class EpochValue {
+ public:
+  /// @param[in] epoch  The current epoch of the mark.
+  ///
+  /// @returns The value stamped with the current epoch.
+  /// @returns The clear value if the stamp is out of date.
+  T get(int epoch) const { return epoch_ == epoch ? value_ : T(); }
+
+  /// @param[in] epoch  The current epoch of the mark.
+  ///
+  /// @returns The value stamped with the current epoch for modification.
+  ///
+  /// @post The out-of-date value is cleared.
+  T& get(int epoch) {
+    if (epoch_ != epoch) {
+      epoch_ = epoch;
+      value_ = T();
+    }
+    return value_;
+  }
+
+  /// Sets the value stamped with the current epoch.
+  ///
+  /// @param[in] epoch  The current epoch of the mark.
+  /// @param[in] value  The new value of the mark.
+  void set(int epoch, T value) {
+    epoch_ = epoch;
+    value_ = std::move(value);
+  }
+
+ private:
+  int epoch_ = 0;  ///< The epoch of the value.
+  T value_ = T();  ///< The mark value.
+};
+
 /// An abstract base class that represents a node in a PDAG.
 /// The index of the node is a unique identifier for the node.
 /// The node holds weak pointers to the parents
@@ -120,27 +165,30 @@ class Node : public NodeParentManager {
   virtual ~Node() = 0;  ///< Abstract class.
 
   /// @returns The host graph of the node.
+  /// @{
   Pdag& graph() { return graph_; }
+  const Pdag& graph() const { return graph_; }
+  /// @}
 
   /// @returns The index of this node.
   int index() const { return index_; }
 
   /// @returns Assigned order for this node.
-  int order() const { return order_; }
+  int order() const;
 
   /// Sets the order number for this node.
   /// The order is interpreted by the assigner.
   ///
   /// @param[in] val  Positive integer.
-  void order(int val) { order_ = val; }
+  void order(int val);
 
   /// @returns Optimization value for failure propagation.
-  int opti_value() const { return opti_value_; }
+  int opti_value() const;
 
   /// Sets the optimization value for failure propagation.
   ///
   /// @param[in] val  Value that makes sense to the caller.
-  void opti_value(int val) { opti_value_ = val; }
+  void opti_value(int val);
 
   /// Registers the visit time for this node upon graph traversal.
   /// This information can be used to detect dependencies.
@@ -150,34 +198,23 @@ class Node : public NodeParentManager {
   ///
   /// @returns true if this node was previously visited.
   /// @returns false if this is visited and re-visited only once.
-  bool Visit(int time) {
-    assert(time > 0);
-    if (!visits_[0]) {
-      visits_[0] = time;
-    } else if (!visits_[1]) {
-      visits_[1] = time;
-    } else {
-      visits_[2] = time;
-      return true;
-    }
-    return false;
-  }
+  bool Visit(int time);
 
   /// @returns The time when this node was first encountered or entered.
   /// @returns 0 if no enter time is registered.
-  int EnterTime() const { return visits_[0]; }
+  int EnterTime() const;
 
   /// @returns The exit time upon traversal of the graph.
   /// @returns 0 if no exit time is registered.
-  int ExitTime() const { return visits_[1]; }
+  int ExitTime() const;
 
   /// @returns The last time this node was visited.
   /// @returns 0 if no last time is registered.
-  int LastVisit() const { return visits_[2] ? visits_[2] : visits_[1]; }
+  int LastVisit() const;
 
   /// @returns The minimum time of the visit.
   /// @returns 0 if no time is registered.
-  virtual int min_time() const { return visits_[0]; }
+  virtual int min_time() const { return EnterTime(); }
 
   /// @returns The maximum time of the visit.
   /// @returns 0 if no time is registered.
@@ -185,39 +222,37 @@ class Node : public NodeParentManager {
 
   /// @returns false if this node was only visited once upon graph traversal.
   /// @returns true if this node was revisited at least one more time.
-  bool Revisited() const { return visits_[2]; }
+  bool Revisited() const;
 
   /// @returns true if this node was visited at least once.
   /// @returns false if this node was never visited upon traversal.
-  bool Visited() const { return visits_[0]; }
+  bool Visited() const { return EnterTime(); }
 
   /// Clears all the visit information. Resets the visit times to 0s.
-  void ClearVisits() { std::fill_n(visits_, 3, 0); }
+  void ClearVisits();
 
   /// @returns The positive count of this node.
-  int pos_count() const { return pos_count_; }
+  int pos_count() const;
 
   /// @returns The negative count of this node.
-  int neg_count() const { return neg_count_; }
+  int neg_count() const;
 
   /// Increases the count of this node.
   ///
   /// @param[in] positive  Indication of a positive node.
-  void AddCount(bool positive) { positive ? ++pos_count_ : ++neg_count_; }
+  void AddCount(bool positive);
 
   /// Resets positive and negative counts of this node.
-  void ResetCount() {
-    pos_count_ = 0;
-    neg_count_ = 0;
-  }
+  void ResetCount();
 
  private:
   int index_;  ///< Index of this node.
-  int order_;  ///< Ordering of nodes in the graph.
-  int visits_[3];  ///< Traversal array with first, second, and last visits.
-  int opti_value_;  ///< Failure propagation optimization value.
-  int pos_count_;  ///< The number of occurrences as a positive node.
-  int neg_count_;  ///< The number of occurrences as a negative node.
+  EpochValue<int> order_;  ///< Ordering of nodes in the graph.
+  /// Traversal array with first, second, and last visits.
+  EpochValue<std::array<int, 3>> visits_;
+  EpochValue<int> opti_value_;  ///< Failure propagation optimization value.
+  EpochValue<int> pos_count_;  ///< The number of occurrences as a positive node.
+  EpochValue<int> neg_count_;  ///< The number of occurrences as a negative node.
   Pdag& graph_;  ///< The host graph for the node.
 };
 
@@ -280,6 +315,8 @@ const int kNumConnectives = 8;  // Update this number if connectives change.
 /// This gate class helps process the fault tree
 /// before any complex analysis is done.
 class Gate : public Node, public std::enable_shared_from_this<Gate> {
+  friend class Pdag;  ///< The hash-consing of gates by semantics.
+
  public:
   /// An argument entry type in the gate's argument containers.
   /// The entry contains
@@ -317,10 +354,7 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
   Gate(Connective type, Pdag* graph) noexcept;
 
   /// Destructs parent information from the arguments.
-  ~Gate() noexcept {
-    assert(Node::parents().empty());
-    EraseArgs();
-  }
+  ~Gate() noexcept;
 
   /// Clones arguments and parameters.
   /// The semantics of the gate is cloned,
@@ -358,7 +392,10 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
   /// @param[in] number  The min number of ATLEAST gate.
   ///
   /// @pre The min number is appropriate for the gate logic and arguments.
-  void min_number(int number) { min_number_ = number; }
+  void min_number(int number) {
+    Touch();
+    min_number_ = number;
+  }
 
   /// @returns true if this gate has become constant.
   bool constant() const { return constant_ != nullptr; }
@@ -402,7 +439,7 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
   /// to visit information provided by the base Node class.
   ///
   /// @returns The mark of this gate.
-  bool mark() const { return mark_; }
+  bool mark() const;
 
   /// Sets the mark of this gate.
   ///
@@ -410,23 +447,23 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
   ///
   /// @pre The marks are assigned in a top-down traversal.
   /// @pre The marks are continuous.
-  void mark(bool flag) { mark_ = flag; }
+  void mark(bool flag);
 
   /// @returns Pre-assigned index of one of gate's descendants.
-  int descendant() const { return descendant_; }
+  int descendant() const;
 
   /// Assigns a descendant index of this gate.
   ///
   /// @param[in] index  Index of the descendant.
-  void descendant(int index) { descendant_ = index; }
+  void descendant(int index);
 
   /// @returns Pre-assigned index of one of the gate's ancestors.
-  int ancestor() { return ancestor_; }
+  int ancestor();
 
   /// Assigns an ancestor index of this gate.
   ///
   /// @param[in] index  Index of the ancestor.
-  void ancestor(int index) { ancestor_ = index; }
+  void ancestor(int index);
 
   /// @returns The minimum time of visits of the gate's sub-graph.
   /// @returns 0 if no time assignment was performed.
@@ -550,6 +587,7 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
     assert(!(type_ == kXor && args_.size() > 1));
     assert(min_number_ >= 0);
 
+    Touch();
     if (args_.count(index))
       return ProcessDuplicateArg(index);
     if (args_.count(-index))
@@ -608,6 +646,7 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
   /// This is a helper function for gate normalization
   /// to efficiently normalize non-coherent gates.
   void NegateNonCoherentGateArgs() noexcept {
+    Touch();
     for (Arg<Gate>& arg : gate_args_) {
       switch (arg.second->type()) {
         case kNor:
@@ -683,6 +722,18 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
  private:
   using std::enable_shared_from_this<Gate>::shared_from_this;
 
+  /// Registers an upcoming change of the gate semantics
+  /// (the logic, min number, or arguments)
+  /// with the hash-consing table of the graph.
+  void Touch() noexcept {
+    if (hashed_ || !pending_)
+      RegisterChange();
+  }
+
+  /// Removes the gate from the table of unique gates
+  /// and puts it into the queue of changed gates.
+  void RegisterChange() noexcept;
+
   /// Mutable getter for the gate arguments.
   ///
   /// @tparam T  The type of the argument nodes.
@@ -734,12 +785,14 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
   }
 
   Connective type_;  ///< Type of this gate.
-  bool mark_;  ///< Marking for linear traversal of a graph.
+  EpochValue<bool> mark_;  ///< Marking for linear traversal of a graph.
   bool module_;  ///< Indication of an independent module gate.
   bool coherent_;  ///< Indication of a coherent graph.
+  bool hashed_;  ///< Membership in the table of unique gates.
+  bool pending_;  ///< Membership in the queue of changed gates.
   int min_number_;  ///< Min number for ATLEAST gate.
-  int descendant_;  ///< Mark by descendant indices.
-  int ancestor_;  ///< Mark by ancestor indices.
+  EpochValue<int> descendant_;  ///< Mark by descendant indices.
+  EpochValue<int> ancestor_;  ///< Mark by ancestor indices.
   int min_time_;  ///< Minimum time of visits of the sub-graph of the gate.
   int max_time_;  ///< Maximum time of visits of the sub-graph of the gate.
   ArgSet args_;  ///< Argument indices of the gate.
@@ -794,6 +847,15 @@ class Pdag : private boost::noncopyable {
     int operator()(Pdag* graph) const { return ++graph->node_index_; }
   };
 
+  /// Counts the live nodes allocated in the node pool of the graph.
+  class NodeRegistrar {
+    friend class Node;
+    /// @param[in,out] graph  The graph of the new node.
+    void Insert(Pdag* graph) const { ++graph->num_nodes_; }
+    /// @param[in,out] graph  The graph of the destroyed node.
+    void Erase(Pdag* graph) const { --graph->num_nodes_; }
+  };
+
   /// Registers pass-through or Null logic gates belonging to the graph.
   class NullGateRegistrar {
     friend class Gate;
@@ -805,6 +867,19 @@ class Pdag : private boost::noncopyable {
     }
   };
 
+  /// Registers changes of gates for hash-consing by semantics.
+  class GateTableRegistrar {
+    friend class Gate;
+    /// @param[in] gate  The gate to be removed from the table of unique gates.
+    void Erase(Gate* gate) const {
+      gate->graph().gate_table_.erase(gate);
+    }
+    /// @param[in] gate  The gate to be queued for (re-)hashing.
+    void Queue(Gate* gate) const {
+      gate->graph().pending_gates_.emplace_back(gate->weak_from_this());
+    }
+  };
+
   /// Non-declarative substitutions.
   struct Substitution {
     /// The non-empty unique hypothesis set event IDs.
@@ -824,7 +899,8 @@ class Pdag : private boost::noncopyable {
     kOptiValue,
     kDescendant,
     kAncestor,
-    kOrder
+    kOrder,
+    kNumNodeMarks  ///< The number of the kinds of marks.
   };
 
   /// Constructs a graph with no root gate
@@ -861,6 +937,30 @@ class Pdag : private boost::noncopyable {
   explicit Pdag(const mef::Gate& root, bool ccf = false,
                 const mef::Model* model = nullptr) noexcept;
 
+  /// Releases the graph nodes before their memory pool.
+  ///
+  /// @pre No pointers to the nodes (incl. weak) are held outside the graph.
+  ~Pdag() noexcept;
+
+  /// Creates a new node of the graph in the node memory pool of the graph.
+  /// The node and its shared pointer control block
+  /// are allocated together without the general-purpose heap.
+  ///
+  /// @tparam T  The type of the node (Gate or Variable).
+  /// @tparam Ts  The types of the node constructor arguments.
+  ///
+  /// @param[in] args  The node constructor arguments except for the graph.
+  ///
+  /// @returns The shared pointer to the new node.
+  ///
+  /// @pre The node and its pointers do not outlive this graph.
+  template <class T, typename... Ts>
+  std::shared_ptr<T> MakeNode(Ts&&... args) noexcept {
+    return std::allocate_shared<T>(
+        std::pmr::polymorphic_allocator<T>(&node_pool_),
+        std::forward<Ts>(args)..., this);
+  }
+
   /// @returns Non-declarative substitutions to be applied by analysis.
   const std::vector<Substitution>& substitutions() const {
     return substitutions_;
@@ -959,6 +1059,18 @@ class Pdag : private boost::noncopyable {
   /// @warning Gate marks are manipulated.
   void Log() noexcept;
 
+  /// Hash-conses the gates changed since the last call
+  /// by their semantics (logic, min number, and arguments).
+  /// The unchanged gates are kept in the persistent table of unique gates,
+  /// so only the changed gates are hashed and tested.
+  ///
+  /// @returns The original gates and their multiple definitions.
+  ///
+  /// @note Constant, module, and detached gates are deferred
+  ///       until the next call.
+  std::unordered_map<GatePtr, std::vector<GateWeakPtr>>
+  GetMultipleDefinitions() noexcept;
+
   /// Removes gates of Null logic with a single argument (maybe constant).
   /// That one child arg is transferred to the parent gate,
   /// and the original argument gate is removed from the parent gate.
@@ -979,33 +1091,37 @@ class Pdag : private boost::noncopyable {
   /// @warning Gate marks will get cleared by this function.
   void RemoveNullGates() noexcept;
 
-  /// Clears marks from graph nodes.
-  ///
   /// @tparam Mark  The kind of the mark.
+  ///
+  /// @returns The current epoch of the node marks.
   template <NodeMark Mark>
-  void Clear() noexcept {
-    if constexpr (Mark == kGateMark) {
-      Clear<kGateMark>(root_);
-
-    } else {
-      Clear<kGateMark>();
-      Clear<Mark>(root_);
-      Clear<kGateMark>();
-    }
+  int epoch() const {
+    return epochs_[Mark];
   }
 
-  /// Determines the proper "clear" state for the graph node mark,
-  /// and set the clear mark to nodes starting from the given gate.
+  /// Clears marks from all graph nodes
+  /// by starting a new epoch of the mark in constant time.
   ///
   /// @tparam Mark  The kind of the mark.
-  ///
-  /// @param[in,out] gate  The root gate to start the traversal and cleaning.
-  ///
-  /// @pre The gate marks are usable for traversal (clear, continuous, etc.).
   template <NodeMark Mark>
-  void Clear(const GatePtr& gate) noexcept;
+  void Clear() noexcept {
+    ++epochs_[Mark];
+    assert(epochs_[Mark] > 0 && "Node mark epoch overflow.");
+  }
 
  private:
+  /// Functor for hashing gates by their semantics.
+  struct GateHash {
+    /// @returns Hash value of the gate logic, min number, and arguments.
+    std::size_t operator()(const Gate* gate) const noexcept;
+  };
+
+  /// Functor for equality test for gates by their semantics.
+  struct GateEqual {
+    /// @returns true if the gates have the same logic and arguments.
+    bool operator()(const Gate* lhs, const Gate* rhs) const noexcept;
+  };
+
   /// Holder for nodes that are created from fault tree events.
   /// This is a helper structure
   /// for functions that transform a fault tree into a PDAG.
@@ -1124,7 +1240,18 @@ class Pdag : private boost::noncopyable {
   /// @post Null logic gates have no parents.
   void PropagateNullGate(const GatePtr& gate) noexcept;
 
+  /// The memory pool of the graph nodes and their control blocks.
+  /// The pool is declared first to be destroyed after all the nodes.
+  std::pmr::unsynchronized_pool_resource node_pool_;
+  /// The table of unique gates by semantics.
+  /// The table is declared before the root to outlive all the gates.
+  std::unordered_set<Gate*, GateHash, GateEqual> gate_table_;
+  /// The gates changed since the last hash-consing.
+  std::vector<GateWeakPtr> pending_gates_;
+  /// The current epochs of the node marks.
+  std::array<int, kNumNodeMarks> epochs_ = {};
   int node_index_;  ///< Automatic index of the new node.
+  int num_nodes_;  ///< The number of live nodes in the node pool.
   bool complement_;  ///< The indication of a complement graph.
   bool coherent_;  ///< Indication that the graph does not contain negation.
   bool normal_;  ///< Indication for the graph containing only OR and AND gates.
@@ -1139,6 +1266,100 @@ class Pdag : private boost::noncopyable {
   std::vector<Substitution> substitutions_;  ///< Non-declarative substitutions.
 };
 
+inline int Node::order() const {
+  return order_.get(graph_.epoch<Pdag::kOrder>());
+}
+
+inline void Node::order(int val) {
+  order_.set(graph_.epoch<Pdag::kOrder>(), val);
+}
+
+inline int Node::opti_value() const {
+  return opti_value_.get(graph_.epoch<Pdag::kOptiValue>());
+}
+
+inline void Node::opti_value(int val) {
+  opti_value_.set(graph_.epoch<Pdag::kOptiValue>(), val);
+}
+
+inline bool Node::Visit(int time) {
+  assert(time > 0);
+  std::array<int, 3>& visits = visits_.get(graph_.epoch<Pdag::kVisit>());
+  if (!visits[0]) {
+    visits[0] = time;
+  } else if (!visits[1]) {
+    visits[1] = time;
+  } else {
+    visits[2] = time;
+    return true;
+  }
+  return false;
+}
+
+inline int Node::EnterTime() const {
+  return visits_.get(graph_.epoch<Pdag::kVisit>())[0];
+}
+
+inline int Node::ExitTime() const {
+  return visits_.get(graph_.epoch<Pdag::kVisit>())[1];
+}
+
+inline int Node::LastVisit() const {
+  std::array<int, 3> visits = visits_.get(graph_.epoch<Pdag::kVisit>());
+  return visits[2] ? visits[2] : visits[1];
+}
+
+inline bool Node::Revisited() const {
+  return visits_.get(graph_.epoch<Pdag::kVisit>())[2];
+}
+
+inline void Node::ClearVisits() {
+  visits_.set(graph_.epoch<Pdag::kVisit>(), {});
+}
+
+inline int Node::pos_count() const {
+  return pos_count_.get(graph_.epoch<Pdag::kCount>());
+}
+
+inline int Node::neg_count() const {
+  return neg_count_.get(graph_.epoch<Pdag::kCount>());
+}
+
+inline void Node::AddCount(bool positive) {
+  int epoch = graph_.epoch<Pdag::kCount>();
+  positive ? ++pos_count_.get(epoch) : ++neg_count_.get(epoch);
+}
+
+inline void Node::ResetCount() {
+  int epoch = graph_.epoch<Pdag::kCount>();
+  pos_count_.set(epoch, 0);
+  neg_count_.set(epoch, 0);
+}
+
+inline bool Gate::mark() const {
+  return mark_.get(Node::graph().epoch<Pdag::kGateMark>());
+}
+
+inline void Gate::mark(bool flag) {
+  mark_.set(Node::graph().epoch<Pdag::kGateMark>(), flag);
+}
+
+inline int Gate::descendant() const {
+  return descendant_.get(Node::graph().epoch<Pdag::kDescendant>());
+}
+
+inline void Gate::descendant(int index) {
+  descendant_.set(Node::graph().epoch<Pdag::kDescendant>(), index);
+}
+
+inline int Gate::ancestor() {
+  return ancestor_.get(Node::graph().epoch<Pdag::kAncestor>());
+}
+
+inline void Gate::ancestor(int index) {
+  ancestor_.set(Node::graph().epoch<Pdag::kAncestor>(), index);
+}
+
 /// Traverses and visits gates and nodes in the graph.
 ///
 /// @tparam Mark  The "visited" gate mark.
@@ -1173,38 +1394,6 @@ void TraverseNodes(const GatePtr& gate, T&& visit) noexcept {
 }
 /// @}
 
-template <Pdag::NodeMark Mark>
-void Pdag::Clear(const GatePtr& gate) noexcept {
-  if constexpr (Mark == kGateMark) {
-    TraverseGates<false>(gate, [](auto&&) {});
-
-  } else if constexpr (Mark == kDescendant) {
-    TraverseGates(gate, [](const GatePtr& arg) { arg->descendant(0); });
-
-  } else if constexpr (Mark == kAncestor) {
-    TraverseGates(gate, [](const GatePtr& arg) { arg->ancestor(0); });
-
-  } else {
-    TraverseNodes(gate, [](auto&& node) {
-      if constexpr (Mark == kVisit) {
-        if (node->Visited())
-          node->ClearVisits();
-
-      } else if constexpr (Mark == kOrder) {
-        if (node->order())
-          node->order(0);
-
-      } else if constexpr (Mark == kOptiValue) {
-        node->opti_value(0);
-
-      } else {
-        static_assert(Mark == kCount, "The node mark is not covered.");
-        node->ResetCount();
-      }
-    });
-  }
-}
-
 /// Prints PDAG nodes in the Aralia format.
 /// @{
 std::ostream& operator<<(std::ostream& os, const Constant& constant);
@@ -76,11 +76,12 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <list>
 #include <queue>
+#include <thread>
 #include <unordered_set>
 
-#include <boost/functional/hash.hpp>
 #include <boost/math/special_functions/sign.hpp>
 #include <boost/range/algorithm.hpp>
 #include <boost/range/algorithm_ext.hpp>
@@ -167,7 +168,14 @@ void MarkCoherence(Pdag* graph) noexcept {
 
 }  // namespace pdag
 
-Preprocessor::Preprocessor(Pdag* graph) noexcept : graph_(graph) {}
+Preprocessor::Preprocessor(Pdag* graph, const Settings& settings) noexcept
+    : graph_(graph),
+      num_threads_(settings.num_threads()),
+      passes_(settings.preprocessing_passes()),
+      policy_(settings.preprocessing_policy()),
+      exhausted_passes_(passes_.size(), false) {
+  assert(num_threads_ > 0);
+}
 
 void Preprocessor::operator()() noexcept {
   TIMER(DEBUG2, "Preprocessing");
@@ -183,64 +191,6 @@ void Preprocessor::Run() noexcept {
                   });
 }
 
-/// Container of unique gates.
-/// This container acts like an unordered set of gates.
-/// The gates are equivalent
-/// if they have the same semantics.
-/// However, this set does not test
-/// for the isomorphism of the gates' Boolean formulas.
-class Preprocessor::GateSet {
- public:
-  /// Inserts a gate into the set
-  /// if it is semantically unique.
-  ///
-  /// @param[in] gate  The gate to insert.
-  ///
-  /// @returns A pair of the unique gate and
-  ///          the insertion success flag.
-  std::pair<GatePtr, bool> insert(const GatePtr& gate) noexcept {
-    auto result = table_[gate->type()].insert(gate);
-    return {*result.first, result.second};
-  }
-
- private:
-  /// Functor for hashing gates by their arguments.
-  ///
-  /// @note The hashing discards the logic of the gate.
-  struct Hash {
-    /// Operator overload for hashing.
-    ///
-    /// @param[in] gate  The gate which hash must be calculated.
-    ///
-    /// @returns Hash value of the gate
-    ///          from its arguments but not logic.
-    std::size_t operator()(const GatePtr& gate) const noexcept {
-      return boost::hash_range(gate->args().begin(), gate->args().end());
-    }
-  };
-  /// Functor for equality test for gates by their arguments.
-  ///
-  /// @note The equality discards the logic of the gate.
-  struct Equal {
-    /// Operator overload for gate argument equality test.
-    ///
-    /// @param[in] lhs  The first gate.
-    /// @param[in] rhs  The second gate.
-    ///
-    /// @returns true if the gate arguments are equal.
-    bool operator()(const GatePtr& lhs, const GatePtr& rhs) const noexcept {
-      assert(lhs->type() == rhs->type());
-      if (lhs->args() != rhs->args())
-        return false;
-      if (lhs->type() == kAtleast && lhs->min_number() != rhs->min_number())
-        return false;
-      return true;
-    }
-  };
-  /// Container of gates grouped by their types.
-  std::array<std::unordered_set<GatePtr, Hash, Equal>, kNumConnectives> table_;
-};
-
 namespace {  // PDAG structure verification tools.
 
 /// Functor to sanity check the marks of PDAG gates.
@@ -343,21 +293,271 @@ void Preprocessor::RunPhaseTwo() noexcept {
                   },
                   [this](Pdag*) { DetectModules(); },
                   [this](Pdag*) {
-                    while (CoalesceGates(/*common=*/false))
-                      continue;
-                  },
-                  [this](Pdag*) { MergeCommonArgs(); },
-                  [this](Pdag*) { DetectDistributivity(); },
-                  [this](Pdag*) { DetectModules(); },
-                  [this](Pdag*) { BooleanOptimization(); },
-                  [this](Pdag*) { DecomposeCommonNodes(); },
-                  [this](Pdag*) { DetectModules(); },
+                    if (num_threads_ > 1) {
+                      OptimizeStructureInParallel();
+                    } else {
+                      OptimizeStructure();
+                    }
+                  });
+  graph_->Log();
+}
+
+void Preprocessor::OptimizeStructure() noexcept {
+  bool modular = true;  // The module detection is up-to-date.
+  int last = -1;  // The statistics of the last pass with the current counts.
+  for (std::size_t i = 0; i < passes_.size(); ++i) {
+    if (graph_->IsTrivial())
+      return;
+    if (exhausted_passes_[i]) {
+      LOG(DEBUG4) << "Skipping the exhausted pass "
+                  << kPreprocessingPassToString[static_cast<int>(passes_[i])];
+      continue;
+    }
+    const PassStatistics* previous = last < 0 ? nullptr : &statistics_[last];
+    if (!RunPass(passes_[i], previous) &&
+        policy_ == PreprocessingPolicy::kAuto)
+      exhausted_passes_[i] = true;
+    last = statistics_.size() - 1;
+    modular = passes_[i] == PreprocessingPass::kDistributivity ||
+              passes_[i] == PreprocessingPass::kDecomposition;
+  }
+  if (!modular)
+    pdag::Transform(graph_, [this](Pdag*) { DetectModules(); });
+}
+
+bool Preprocessor::RunPass(PreprocessingPass pass,
+                           const PassStatistics* previous) noexcept {
+  auto count_nodes = [this](int* num_gates, int* num_variables,
+                            int* num_args) {
+    std::vector<GatePtr> gates;
+    std::vector<VariablePtr> variables;
+    GatherNodes(&gates, &variables);
+    *num_gates = gates.size();
+    *num_variables = variables.size();
+    *num_args = 0;
+    for (const GatePtr& gate : gates)
+      *num_args += gate->args().size();
+  };
+  PassStatistics stats{pass};
+  if (previous) {  // The graph is unchanged since the previous pass.
+    stats.gates_before = previous->gates_after;
+    stats.variables_before = previous->variables_after;
+    stats.args_before = previous->args_after;
+  } else {
+    count_nodes(&stats.gates_before, &stats.variables_before,
+                &stats.args_before);
+  }
+  CLOCK(pass_time);
+  switch (pass) {
+    case PreprocessingPass::kCoalescence:
+      while (CoalesceGates(/*common=*/false))
+        continue;
+      break;
+    case PreprocessingPass::kMergeCommonArgs:
+      MergeCommonArgs();
+      break;
+    case PreprocessingPass::kDistributivity:
+      DetectDistributivity();
+      pdag::Transform(graph_, [this](Pdag*) { DetectModules(); });
+      break;
+    case PreprocessingPass::kBooleanOptimization:
+      BooleanOptimization();
+      break;
+    case PreprocessingPass::kDecomposition:
+      DecomposeCommonNodes();
+      pdag::Transform(graph_, [this](Pdag*) { DetectModules(); });
+      break;
+  }
+  stats.time = DUR(pass_time);
+  count_nodes(&stats.gates_after, &stats.variables_after, &stats.args_after);
+  stats.modules = -1;
+  if (DEBUG3 <= kMaxLogLevel && DEBUG3 <= Logger::report_level())
+    stats.modules = graph_->IsTrivial() ? 0 : GatherModules().size();
+  LOG(DEBUG3) << "Pass " << kPreprocessingPassToString[static_cast<int>(pass)]
+              << " finished in " << stats.time << ": gates "
+              << stats.gates_before << " -> " << stats.gates_after
+              << ", variables " << stats.variables_before << " -> "
+              << stats.variables_after << ", arguments " << stats.args_before
+              << " -> " << stats.args_after << ", modules " << stats.modules;
+  statistics_.push_back(stats);
+  return stats.gates_after + stats.variables_after + stats.args_after <
+         stats.gates_before + stats.variables_before + stats.args_before;
+}
+
+namespace {  // Parallel optimization of independent modules.
+
+/// Preprocessor of top-level modules extracted into independent graphs.
+class ModulePreprocessor final : public Preprocessor {
+ public:
+  using Preprocessor::Preprocessor;
+
+ private:
+  void Run() noexcept override {
+    pdag::Transform(graph_, [this](Pdag*) { DetectModules(); },
+                    [this](Pdag*) { OptimizeStructure(); });
+  }
+};
+
+/// A top-level module extracted into an independent graph.
+struct ModuleGraph {
+  std::unique_ptr<Pdag> graph;  ///< The independent graph of the module.
+  std::weak_ptr<Variable> placeholder;  ///< The substitute in the main graph.
+  /// The original variables mapped by the module graph variable indices.
+  std::unordered_map<int, VariablePtr> variables;
+  std::vector<PassStatistics> statistics;  ///< The optimization statistics.
+};
+
+/// Copies the structure of a sub-graph into another graph.
+///
+/// @param[in] gate  The root gate of the sub-graph to copy.
+/// @param[in,out] graph  The destination graph.
+/// @param[in] variables  The destination variables mapped by source indices.
+/// @param[in,out] copies  The gate copies mapped by the source gate indices.
+///
+/// @returns The copy of the gate in the destination graph.
+///
+/// @pre The sub-graph contains no constant or NULL gates.
+GatePtr CopyGraph(const GatePtr& gate, Pdag* graph,
+                  const std::unordered_map<int, VariablePtr>& variables,
+                  std::unordered_map<int, GatePtr>* copies) noexcept {
+  if (auto it = ext::find(*copies, gate->index()))
+    return it->second;
+  assert(!gate->constant() && gate->type() != kNull);
+  auto copy = graph->MakeNode<Gate>(gate->type());
+  if (gate->type() == kAtleast)
+    copy->min_number(gate->min_number());
+  copy->coherent(gate->coherent());
+  if (gate->module())
+    copy->module(true);
+  for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
+    copy->AddArg(CopyGraph(arg.second, graph, variables, copies),
+                 arg.first < 0);
+  }
+  for (const Gate::Arg<Variable>& arg : gate->args<Variable>()) {
+    assert(variables.count(arg.second->index()));
+    copy->AddArg(variables.find(arg.second->index())->second, arg.first < 0);
+  }
+  copies->emplace(gate->index(), copy);
+  return copy;
+}
+
+/// Substitutes a node with another node in all its parents.
+///
+/// @tparam T  The type of the replacement node.
+///
+/// @param[in] node  The node to be substituted.
+/// @param[in] replacement  The new node in place of the substituted node.
+/// @param[in] complement  The flag to complement the replacement.
+///
+/// @pre The replacement does not share parents with the node.
+template <class T>
+void Substitute(const NodePtr& node, const std::shared_ptr<T>& replacement,
+                bool complement) noexcept {
+  while (!node->parents().empty()) {
+    GatePtr parent = node->parents().begin()->second.lock();
+    int sign = parent->GetArgSign(node);
+    parent->EraseArg(sign * node->index());
+    parent->AddArg(replacement, (sign < 0) != complement);
+  }
+}
+
+}  // namespace
+
+void Preprocessor::OptimizeStructureInParallel() noexcept {
+  std::vector<GateWeakPtr> top_modules = GatherTopModules();
+  if (top_modules.size() < 2)
+    return OptimizeStructure();
+
+  TIMER(DEBUG3, "Parallel optimization of modules");
+  LOG(DEBUG4) << "Extracting " << top_modules.size() << " top-level modules...";
+  std::vector<ModuleGraph> modules;
+  graph_->Clear<Pdag::kVisit>();
+  for (const GateWeakPtr& ptr : top_modules) {
+    GatePtr module = ptr.lock();
+    ModuleGraph& entry = modules.emplace_back();
+    entry.graph = std::make_unique<Pdag>();
+    entry.graph->coherent(graph_->coherent());
+    entry.graph->normal(graph_->normal());
+    std::vector<GatePtr> gates;
+    std::vector<VariablePtr> variables;
+    GatherNodes(module, &gates, &variables);
+    // Variables go first to keep the index ordering of the module graph.
+    std::unordered_map<int, VariablePtr> copy_variables;
+    for (VariablePtr& variable : variables) {
+      auto copy = entry.graph->MakeNode<Variable>();
+      copy_variables.emplace(variable->index(), copy);
+      entry.variables.emplace(copy->index(), std::move(variable));
+    }
+    std::unordered_map<int, GatePtr> copies;
+    entry.graph->root(
+        CopyGraph(module, entry.graph.get(), copy_variables, &copies));
+    auto placeholder = graph_->MakeNode<Variable>();
+    Substitute(module, placeholder, /*complement=*/false);
+    entry.placeholder = placeholder;
+  }
+
+  // The module graphs share no state with this graph or each other.
+  Settings settings;  // Single-threaded preprocessing of the modules.
+  settings.preprocessing_passes(passes_).preprocessing_policy(policy_);
+  std::atomic<std::size_t> next_module = 0;
+  auto optimize_modules = [&modules, &next_module, &settings] {
+    for (std::size_t i = next_module++; i < modules.size();
+         i = next_module++) {
+      ModulePreprocessor preprocessor(modules[i].graph.get(), settings);
+      preprocessor();
+      modules[i].statistics = preprocessor.statistics();
+    }
+  };
+  std::vector<std::thread> workers;
+  int num_workers = std::min<std::size_t>(num_threads_ - 1, modules.size());
+  for (int i = 0; i < num_workers; ++i)
+    workers.emplace_back(optimize_modules);
+  OptimizeStructure();  // The rest of the graph with the placeholders.
+  optimize_modules();
+  for (std::thread& worker : workers)
+    worker.join();
+
+  LOG(DEBUG4) << "Substituting the placeholders with the optimized modules...";
+  for (const ModuleGraph& module : modules) {
+    statistics_.insert(statistics_.end(), module.statistics.begin(),
+                       module.statistics.end());
+    if (module.placeholder.expired())
+      continue;  // The module is redundant in the optimized graph.
+    VariablePtr placeholder = module.placeholder.lock();
+    const GatePtr& root = module.graph->root();
+    bool complement = module.graph->complement();
+    std::unordered_map<int, GatePtr> copies;
+    if (root->constant()) {
+      bool state = (*root->args().begin() > 0) != complement;
+      while (!placeholder->parents().empty()) {
+        GatePtr parent = placeholder->parents().begin()->second.lock();
+        parent->ProcessConstantArg(placeholder, state);
+      }
+    } else if (root->type() == kNull) {
+      int index = *root->args().begin();
+      complement = complement != (index < 0);
+      if (!root->args<Gate>().empty()) {
+        Substitute(placeholder,
+                   CopyGraph(root->args<Gate>().begin()->second, graph_,
+                             module.variables, &copies),
+                   complement);
+      } else {
+        Substitute(placeholder, module.variables.at(std::abs(index)),
+                   complement);
+      }
+    } else {
+      Substitute(placeholder,
+                 CopyGraph(root, graph_, module.variables, &copies),
+                 complement);
+    }
+  }
+  graph_->RemoveNullGates();
+  pdag::Transform(graph_,
                   [this](Pdag*) {
                     while (CoalesceGates(/*common=*/false))
                       continue;
                   },
                   [this](Pdag*) { DetectModules(); });
-  graph_->Log();
 }
 
 void Preprocessor::RunPhaseThree() noexcept {
@@ -561,8 +761,8 @@ void Preprocessor::NormalizeGate(const GatePtr& gate, bool full) noexcept {
 
 void Preprocessor::NormalizeXorGate(const GatePtr& gate) noexcept {
   assert(gate->args().size() == 2);
-  auto gate_one = std::make_shared<Gate>(kAnd, graph_);
-  auto gate_two = std::make_shared<Gate>(kAnd, graph_);
+  auto gate_one = graph_->MakeNode<Gate>(kAnd);
+  auto gate_two = graph_->MakeNode<Gate>(kAnd);
   gate_one->mark(true);
   gate_two->mark(true);
 
@@ -600,14 +800,14 @@ void Preprocessor::NormalizeAtleastGate(const GatePtr& gate) noexcept {
     return gate->GetArg(lhs)->order() < gate->GetArg(rhs)->order();
   });
   assert(it != gate->args().cend());
-  auto first_arg = std::make_shared<Gate>(kAnd, graph_);
+  auto first_arg = graph_->MakeNode<Gate>(kAnd);
   gate->TransferArg(*it, first_arg);
 
-  auto grand_arg = std::make_shared<Gate>(kAtleast, graph_);
+  auto grand_arg = graph_->MakeNode<Gate>(kAtleast);
   first_arg->AddArg(grand_arg);
   grand_arg->min_number(min_number - 1);
 
-  auto second_arg = std::make_shared<Gate>(kAtleast, graph_);
+  auto second_arg = graph_->MakeNode<Gate>(kAtleast);
   second_arg->min_number(min_number);
 
   for (int index : gate->args()) {
@@ -750,14 +950,9 @@ bool Preprocessor::ProcessMultipleDefinitions() noexcept {
 
   TIMER(DEBUG3, "Detecting multiple definitions");
 
-  graph_->Clear<Pdag::kGateMark>();
   // The original gate and its multiple definitions.
-  std::unordered_map<GatePtr, std::vector<GateWeakPtr>> multi_def;
-  {
-    GateSet unique_gates;
-    DetectMultipleDefinitions(graph_->root(), &multi_def, &unique_gates);
-  }
-  graph_->Clear<Pdag::kGateMark>();
+  std::unordered_map<GatePtr, std::vector<GateWeakPtr>> multi_def =
+      graph_->GetMultipleDefinitions();
 
   if (multi_def.empty())
     return false;
@@ -775,29 +970,6 @@ bool Preprocessor::ProcessMultipleDefinitions() noexcept {
   return true;
 }
 
-void Preprocessor::DetectMultipleDefinitions(
-    const GatePtr& gate,
-    std::unordered_map<GatePtr, std::vector<GateWeakPtr>>* multi_def,
-    GateSet* unique_gates) noexcept {
-  if (gate->mark())
-    return;
-  gate->mark(true);
-  assert(!gate->constant());
-
-  if (!gate->module()) {  // Modules are unique by definition.
-    std::pair<GatePtr, bool> ret = unique_gates->insert(gate);
-    assert(ret.first->mark());
-    if (!ret.second) {  // The gate is duplicate.
-      (*multi_def)[ret.first].push_back(gate);
-      return;
-    }
-  }
-  // No redefinition is found for this gate.
-  for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
-    DetectMultipleDefinitions(arg.second, multi_def, unique_gates);
-  }
-}
-
 void Preprocessor::DetectModules() noexcept {
   TIMER(DEBUG3, "Module detection");
   assert(!graph_->HasNullGates());
@@ -943,11 +1115,11 @@ GatePtr Preprocessor::CreateNewModule(
   switch (gate->type()) {
     case kNand:
     case kAnd:
-      module = std::make_shared<Gate>(kAnd, graph_);
+      module = graph_->MakeNode<Gate>(kAnd);
       break;
     case kNor:
     case kOr:
-      module = std::make_shared<Gate>(kOr, graph_);
+      module = graph_->MakeNode<Gate>(kOr);
       break;
     default:
       return module;  // Cannot create sub-modules for other types.
@@ -1093,6 +1265,31 @@ std::vector<GateWeakPtr> Preprocessor::GatherModules() noexcept {
   return modules;
 }
 
+std::vector<GateWeakPtr> Preprocessor::GatherTopModules() noexcept {
+  graph_->Clear<Pdag::kGateMark>();
+  const GatePtr& root = graph_->root();
+  root->mark(true);
+  std::vector<GateWeakPtr> modules;
+  std::queue<Gate*> gates_queue;
+  gates_queue.push(root.get());
+  while (!gates_queue.empty()) {
+    Gate* gate = gates_queue.front();
+    gates_queue.pop();
+    for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
+      const GatePtr& arg_gate = arg.second;
+      if (arg_gate->mark())
+        continue;
+      arg_gate->mark(true);
+      if (!arg_gate->module()) {
+        gates_queue.push(arg_gate.get());
+      } else if (!arg_gate->args<Gate>().empty()) {
+        modules.push_back(arg_gate);
+      }
+    }
+  }
+  return modules;
+}
+
 bool Preprocessor::MergeCommonArgs() noexcept {
   TIMER(DEBUG3, "Merging common arguments");
   assert(!graph_->HasNullGates());
@@ -1128,7 +1325,7 @@ bool Preprocessor::MergeCommonArgs(Connective op) noexcept {
     GatePtr root = module.lock();
     MergeTable::Candidates candidates;
     GatherCommonArgs(root, op, &candidates);
-    graph_->Clear<Pdag::kGateMark>(root);
+    graph_->Clear<Pdag::kGateMark>();
     if (candidates.size() < 2)
       continue;
     FilterMergeCandidates(&candidates);
@@ -1481,7 +1678,7 @@ void Preprocessor::TransformCommonArgs(MergeTable::MergeGroup* group) noexcept {
     LOG(DEBUG5) << "The number of common parents: " << common_parents.size();
     const GatePtr& parent = *common_parents.begin();  // To get the arguments.
     assert(parent->args().size() > 1);
-    auto merge_gate = std::make_shared<Gate>(parent->type(), graph_);
+    auto merge_gate = graph_->MakeNode<Gate>(parent->type());
     for (int index : common_args) {
       parent->ShareArg(index, merge_gate);
       for (const GatePtr& common_parent : common_parents) {
@@ -1734,13 +1931,12 @@ void Preprocessor::TransformDistributiveArgs(
         assert(false && "Gate is not suited for distributive operations.");
     }
   } else {
-    new_parent = std::make_shared<Gate>(distr_type, graph_);
+    new_parent = graph_->MakeNode<Gate>(distr_type);
     new_parent->mark(true);
     gate->AddArg(new_parent);
   }
 
-  auto sub_parent =
-      std::make_shared<Gate>(distr_type == kAnd ? kOr : kAnd, graph_);
+  auto sub_parent = graph_->MakeNode<Gate>(distr_type == kAnd ? kOr : kAnd);
   sub_parent->mark(true);
   new_parent->AddArg(sub_parent);
 
@@ -1787,10 +1983,28 @@ void Preprocessor::BooleanOptimization() noexcept {
   std::vector<GateWeakPtr> common_gates;
   std::vector<std::weak_ptr<Variable>> common_variables;
   GatherCommonNodes(&common_gates, &common_variables);
-  for (const auto& gate : common_gates)
-    ProcessCommonNode(gate);
-  for (const auto& var : common_variables)
-    ProcessCommonNode(var);
+  graph_->Clear<Pdag::kVisit>();
+  AssignTiming(0, graph_->root());  // Bottom-up order of ancestors.
+
+  // The most shared nodes are the most likely sources of redundancy.
+  auto by_multiplicity = [](const auto& lhs, const auto& rhs) {
+    return lhs.lock()->parents().size() > rhs.lock()->parents().size();
+  };
+  boost::stable_sort(common_gates, by_multiplicity);
+  boost::stable_sort(common_variables, by_multiplicity);
+
+  int budget = kBooleanOptimizationBudget_;
+  auto process = [this, &budget](const auto& common_nodes) {
+    for (const auto& node : common_nodes) {
+      if (budget <= 0) {
+        LOG(DEBUG4) << "Boolean optimization work budget is exhausted.";
+        return;
+      }
+      budget -= ProcessCommonNode(node);
+    }
+  };
+  process(common_gates);
+  process(common_variables);
 }
 
 void Preprocessor::GatherCommonNodes(
@@ -1824,19 +2038,19 @@ void Preprocessor::GatherCommonNodes(
 }
 
 template <class N>
-void Preprocessor::ProcessCommonNode(
+int Preprocessor::ProcessCommonNode(
     const std::weak_ptr<N>& common_node) noexcept {
   assert(!graph_->HasNullGates());
   if (common_node.expired())
-    return;  // The node has been deleted.
+    return 0;  // The node has been deleted.
 
   std::shared_ptr<N> node = common_node.lock();
 
   if (node->parents().size() == 1)
-    return;  // The extra parent is deleted.
+    return 0;  // The extra parent is deleted.
   GatePtr root;
-  MarkAncestors(node, &root);
-  assert(root && "Marking ancestors ended without guaranteed module.");
+  int num_ancestors = MarkAncestors(node, &root);
+  assert(root && "Marking ancestors ended without guaranteed dominator.");
   assert(root->mark() && "Graph gate marks are not cleaned.");
   assert(!root->opti_value() && "Optimization values are corrupted.");
   assert(!node->opti_value() && "Optimization values are corrupted.");
@@ -1851,6 +2065,7 @@ void Preprocessor::ProcessCommonNode(
   // The results of the failure propagation.
   std::unordered_map<int, GateWeakPtr> destinations;
   int num_dest = 0;  // This is not the same as the size of destinations.
+  bool retime = false;  // New gates are introduced into the graph.
   if (root->opti_value()) {  // The root gate received the state.
     destinations.emplace(root->index(), root);
     num_dest = 1;
@@ -1867,29 +2082,54 @@ void Preprocessor::ProcessCommonNode(
                   << redundant_parents.size() << " redundant parent(s) and "
                   << destinations.size() << " failure destination(s)";
       ProcessRedundantParents(node, redundant_parents);
-      ProcessStateDestinations(node, destinations);
+      retime = ProcessStateDestinations(node, destinations);
     }
   }
-  ClearStateMarks(root);
-  node->opti_value(0);
+  graph_->Clear<Pdag::kOptiValue>();
+  graph_->Clear<Pdag::kDescendant>();
   graph_->RemoveNullGates();
-}
-
-void Preprocessor::MarkAncestors(const NodePtr& node,
-                                 GatePtr* module) noexcept {
-  for (const Node::Parent& member : node->parents()) {
-    assert(!member.second.expired());
-    GatePtr parent = member.second.lock();
-    if (parent->mark())
-      continue;
-    parent->mark(true);
-    if (parent->module()) {  // Do not mark further than independent subgraph.
-      assert(!*module);
-      *module = parent;
-      continue;
+  if (retime && !graph_->root()->constant()) {
+    // New gates have no exit times to order the ancestor marking.
+    graph_->Clear<Pdag::kVisit>();
+    num_ancestors += AssignTiming(0, graph_->root());
+  }
+  return num_ancestors;
+}
+
+int Preprocessor::MarkAncestors(const NodePtr& node,
+                                GatePtr* dominator) noexcept {
+  // The frontier of marked ancestors cuts all the paths to the root.
+  // The deepest ancestor (with the earliest exit time) is expanded first,
+  // so the frontier collapses into the closest dominator
+  // before any gate above the dominator is expanded.
+  auto later_exit = [](const GatePtr& lhs, const GatePtr& rhs) {
+    return lhs->ExitTime() > rhs->ExitTime();
+  };
+  std::priority_queue<GatePtr, std::vector<GatePtr>, decltype(later_exit)>
+      frontier(later_exit);
+  int num_ancestors = 0;
+  auto expand = [&frontier, &num_ancestors](const Node& child) {
+    for (const Node::Parent& member : child.parents()) {
+      assert(!member.second.expired());
+      GatePtr parent = member.second.lock();
+      if (parent->mark())
+        continue;
+      parent->mark(true);
+      frontier.push(std::move(parent));
+      ++num_ancestors;
     }
-    MarkAncestors(parent, module);
+  };
+  expand(*node);
+  while (frontier.size() > 1) {
+    GatePtr gate = frontier.top();
+    frontier.pop();
+    // Do not mark further than independent subgraph.
+    assert(!gate->module() && "Modules must dominate their sub-graphs.");
+    expand(*gate);
   }
+  assert(!frontier.empty());
+  *dominator = frontier.top();
+  return num_ancestors;
 }
 
 int Preprocessor::PropagateState(const GatePtr& gate,
@@ -2050,9 +2290,10 @@ void Preprocessor::ProcessRedundantParents(
 }
 
 template <class N>
-void Preprocessor::ProcessStateDestinations(
+bool Preprocessor::ProcessStateDestinations(
     const std::shared_ptr<N>& node,
     const std::unordered_map<int, GateWeakPtr>& destinations) noexcept {
+  bool new_gates = false;
   for (const auto& ptr : destinations) {
     if (ptr.second.expired())
       continue;
@@ -2067,7 +2308,7 @@ void Preprocessor::ProcessStateDestinations(
       assert(!(!target->constant() && target->type() == kNull));
       continue;
     }
-    auto new_gate = std::make_shared<Gate>(type, graph_);
+    auto new_gate = graph_->MakeNode<Gate>(type);
     new_gate->AddArg(node, target->opti_value() < 0);
     if (target->module()) {  // Transfer modularity.
       target->module(false);
@@ -2080,20 +2321,9 @@ void Preprocessor::ProcessStateDestinations(
     }
     new_gate->AddArg(target);  // Only after replacing target!
     new_gate->descendant(node->index());  // Preserve continuity.
+    new_gates = true;
   }
-}
-
-void Preprocessor::ClearStateMarks(const GatePtr& gate) noexcept {
-  if (!gate->descendant())
-    return;  // Clean only 'dirty' gates.
-  gate->descendant(0);
-  gate->opti_value(0);
-  for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
-    ClearStateMarks(arg.second);
-  }
-  for (const Node::Parent& member : gate->parents()) {
-    ClearStateMarks(member.second.lock());  // Due to replacement.
-  }
+  return new_gates;
 }
 
 bool Preprocessor::DecomposeCommonNodes() noexcept {
@@ -2235,7 +2465,7 @@ bool Preprocessor::DecompositionProcessor::ProcessDestinations(
     bool ret = ProcessAncestors(parent, state, parent);
     changed |= ret;
     // Keep the graph clean.
-    preprocessor_->graph_->Clear<Pdag::kGateMark>(parent);
+    preprocessor_->graph_->Clear<Pdag::kGateMark>();
     BLOG(DEBUG5, ret) << "Successful decomposition is in G" << parent->index();
   }
   // Actual propagation of the constant.
@@ -31,6 +31,7 @@
 #include <boost/unordered_map.hpp>
 
 #include "pdag.h"
+#include "settings.h"
 
 namespace scram::core {
 
@@ -82,6 +83,21 @@ void MarkCoherence(Pdag* graph) noexcept;
 
 }  // namespace pdag
 
+/// Statistics of a single application of a preprocessing pass.
+struct PassStatistics {
+  PreprocessingPass pass;  ///< The applied pass.
+  double time;  ///< The duration of the pass in seconds.
+  int gates_before;  ///< The number of gates before the pass.
+  int gates_after;  ///< The number of gates after the pass.
+  int variables_before;  ///< The number of variables before the pass.
+  int variables_after;  ///< The number of variables after the pass.
+  int args_before;  ///< The number of gate arguments before the pass.
+  int args_after;  ///< The number of gate arguments after the pass.
+  /// The number of modules after the pass
+  /// or -1 if the pass is not logged at DEBUG3.
+  int modules;
+};
+
 /// The class provides main preprocessing operations
 /// over a PDAG
 /// to simplify the fault tree
@@ -92,6 +108,9 @@ class Preprocessor : private boost::noncopyable {
   /// representing a fault tree.
   ///
   /// @param[in] graph  The PDAG to be preprocessed.
+  /// @param[in] settings  The analysis settings
+  ///                      with the optimization passes,
+  ///                      their policy, and the number of threads.
   ///
   /// @warning There should not be another shared pointer to the root gate
   ///          outside of the passed PDAG.
@@ -101,16 +120,19 @@ class Preprocessor : private boost::noncopyable {
   ///          the destructor will not be called
   ///          as expected by the preprocessing algorithms,
   ///          which will mess the new structure of the PDAG.
-  explicit Preprocessor(Pdag* graph) noexcept;
+  explicit Preprocessor(Pdag* graph,
+                        const Settings& settings = Settings()) noexcept;
 
   virtual ~Preprocessor() = default;
 
   /// Runs the graph preprocessing.
   void operator()() noexcept;
 
- protected:
-  class GateSet;  ///< Container of unique gates by semantics.
+  /// @returns The statistics of the optimization passes
+  ///          in the order of application.
+  const std::vector<PassStatistics>& statistics() const { return statistics_; }
 
+ protected:
   /// Runs the default preprocessing
   /// that achieves the graph in a normal form.
   virtual void Run() noexcept = 0;
@@ -145,8 +167,49 @@ class Preprocessor : private boost::noncopyable {
   /// @note Modules are detected and created.
   /// @note Non-module and non-multiple gates are coalesced.
   /// @note Boolean optimization is applied.
+  /// @note Top-level modules are optimized in parallel
+  ///       if more than one thread is requested.
   void RunPhaseTwo() noexcept;
 
+  /// Optimizes the structure of the graph with detected modules
+  /// by applying the configured optimization passes in order.
+  /// This is the main part of Phase II after the module detection.
+  ///
+  /// @pre Modules are detected.
+  ///
+  /// @post Modules are detected.
+  void OptimizeStructure() noexcept;
+
+  /// Applies an optimization pass to the graph
+  /// and records its statistics.
+  ///
+  /// @param[in] pass  The optimization pass.
+  /// @param[in] previous  The statistics of the preceding pass
+  ///                      if the graph has not changed since,
+  ///                      or nullptr to count the nodes anew.
+  ///
+  /// @returns true if the graph has been reduced by the pass.
+  ///
+  /// @pre Modules are detected.
+  ///
+  /// @note Modules are re-detected after the passes that may destroy them.
+  bool RunPass(PreprocessingPass pass,
+               const PassStatistics* previous) noexcept;
+
+  /// Optimizes the structure of top-level modules
+  /// as independent graphs in parallel threads.
+  /// Meanwhile, the modules are substituted with placeholder variables
+  /// in this graph,
+  /// and the rest of the graph is optimized in the calling thread.
+  /// Upon completion,
+  /// the placeholders are replaced with the optimized modules.
+  ///
+  /// @pre Modules are detected.
+  ///
+  /// @note If there are no top-level modules worth the parallelization,
+  ///       the structure is optimized sequentially.
+  void OptimizeStructureInParallel() noexcept;
+
   /// Application of gate normalization.
   /// After this phase,
   /// the graph is in normal form.
@@ -308,25 +371,13 @@ class Preprocessor : private boost::noncopyable {
   ///
   /// @returns true if multiple definitions are found and replaced.
   ///
-  /// @note This function does not recursively detect multiple definitions
-  ///       due to replaced redundant arguments of gates.
-  ///       The replaced gates are considered a new graph,
+  /// @note Only the gates changed since the last call are tested
+  ///       against the persistent table of unique gates of the graph.
+  ///       The parents of the replaced gates are changed gates,
   ///       and this function must be called again
-  ///       to verify that the new graph does not have multiple definitions.
+  ///       to verify that they do not have multiple definitions.
   bool ProcessMultipleDefinitions() noexcept;
 
-  /// Traverses the PDAG to collect multiple definitions of gates.
-  ///
-  /// @param[in] gate  The gate to traverse the sub-graph.
-  /// @param[in,out] multi_def  Detected multiple definitions.
-  /// @param[in,out] unique_gates  A set of semantically unique gates.
-  ///
-  /// @warning Gate marks must be clear.
-  void DetectMultipleDefinitions(
-      const GatePtr& gate,
-      std::unordered_map<GatePtr, std::vector<GateWeakPtr>>* multi_def,
-      GateSet* unique_gates) noexcept;
-
   /// Traverses the PDAG to detect modules.
   /// Modules are independent sub-graphs
   /// without common nodes with the rest of the graph.
@@ -426,6 +477,18 @@ class Preprocessor : private boost::noncopyable {
   /// @warning Gate marks are used.
   std::vector<GateWeakPtr> GatherModules() noexcept;
 
+  /// Gathers the top-level modules of the PDAG,
+  /// i.e., the modules that are not sub-graphs of other modules
+  /// except for the root.
+  /// Modules without gate arguments are not gathered.
+  ///
+  /// @returns Unique top-level modules encountered breadth-first.
+  ///
+  /// @pre Module detection and marking has already been performed.
+  ///
+  /// @warning Gate marks are used.
+  std::vector<GateWeakPtr> GatherTopModules() noexcept;
+
   /// Identifies common arguments of gates,
   /// and merges the common arguments into new gates.
   /// This technique helps uncover the common structure
@@ -684,6 +747,9 @@ class Preprocessor : private boost::noncopyable {
   /// by removing the redundancies if possible.
   /// This optimization helps reduce the number of common nodes.
   ///
+  /// The most shared nodes are processed first
+  /// until the work budget of the pass is exhausted.
+  ///
   /// @warning Boolean optimization may replace the root gate of the graph.
   /// @warning Node visit information is manipulated.
   /// @warning Gate marks are manipulated.
@@ -711,23 +777,32 @@ class Preprocessor : private boost::noncopyable {
   /// @tparam N  Non-Node, concrete (i.e. Gate, etc.) type.
   ///
   /// @param[in] common_node  A node with more than one parent.
+  ///
+  /// @returns The amount of work in the number of processed ancestor gates
+  ///          and the nodes re-timed after the graph transformation.
   template <class N>
-  void ProcessCommonNode(const std::weak_ptr<N>& common_node) noexcept;
+  int ProcessCommonNode(const std::weak_ptr<N>& common_node) noexcept;
 
   /// Marks ancestor gates true.
-  /// The marking stops at the root
-  /// of an independent subgraph for algorithmic efficiency.
+  /// The marking stops at the closest gate
+  /// through which all the paths from the node to the root pass
+  /// because the node state cannot propagate beyond this dominator gate
+  /// other than through the dominator itself.
   ///
   /// @param[in] node  The child node.
-  /// @param[out] module  The root module gate ancestor.
+  /// @param[out] dominator  The closest dominator ancestor gate.
+  ///
+  /// @returns The number of marked ancestor gates including the dominator.
   ///
   /// @pre Gate marks are clear.
+  /// @pre Gate exit times are assigned in the depth-first order.
+  /// @pre Modules are detected.
   ///
   /// @warning Since very specific branches are marked 'true',
   ///          cleanup must be performed after/with the use of the ancestors.
   ///          If the cleanup is done improperly or not at all,
   ///          the default global contract of clean marks will be broken.
-  void MarkAncestors(const NodePtr& node, GatePtr* module) noexcept;
+  int MarkAncestors(const NodePtr& node, GatePtr* dominator) noexcept;
 
   /// Propagates failure or success of a common node
   /// by setting its ancestors' optimization values to 1 or -1
@@ -811,23 +886,16 @@ class Preprocessor : private boost::noncopyable {
   /// @param[in] node  The common node.
   /// @param[in] destinations  Destination gates for the state.
   ///
+  /// @returns true if new gates are introduced into the graph.
+  ///
   /// @warning This function will replace the root gate of the graph
   ///          if it is the destination.
+  /// @warning The new gates have no visit times.
   template <class N>
-  void ProcessStateDestinations(
+  bool ProcessStateDestinations(
       const std::shared_ptr<N>& node,
       const std::unordered_map<int, GateWeakPtr>& destinations) noexcept;
 
-  /// Clears all the ancestor marks used in Boolean optimization steps.
-  ///
-  /// @param[in] gate  The top ancestor of the common node.
-  ///
-  /// @pre All ancestor gates are marked with the descendant index.
-  /// @pre The common node itself is not the ancestor.
-  ///
-  /// @warning The common node must be cleaned separately.
-  void ClearStateMarks(const GatePtr& gate) noexcept;
-
   /// The Shannon decomposition for common nodes in the PDAG.
   /// This procedure is also called "Constant Propagation",
   /// but it is confusing with the actual propagation of
@@ -991,8 +1059,26 @@ class Preprocessor : private boost::noncopyable {
   void GatherNodes(const GatePtr& gate, std::vector<GatePtr>* gates,
                    std::vector<VariablePtr>* variables) noexcept;
 
+  /// The work budget of Boolean optimization
+  /// in the number of ancestor gates processed for all common nodes.
+  /// The remaining common nodes are skipped beyond this limit.
+  ///
+  /// The optimization is quadratic in the worst case,
+  /// so the budget (about 1.7e7 gate visits) bounds it to seconds.
+  /// The most demanding model in the Aralia set (das9701)
+  /// consumes about 4e5 units,
+  /// i.e., the limit cuts off only the pathological graphs.
+  static constexpr int kBooleanOptimizationBudget_ = 1 << 24;
+
   /// @todo Eliminate the protected data.
   Pdag* graph_;  ///< The PDAG to preprocess.
+  int num_threads_;  ///< The number of threads for independent modules.
+  std::vector<PreprocessingPass> passes_;  ///< The ordered optimization passes.
+  PreprocessingPolicy policy_;  ///< The policy to apply the passes.
+  /// The passes in the order of OptimizeStructure
+  /// that stopped reducing the graph.
+  std::vector<bool> exhausted_passes_;
+  std::vector<PassStatistics> statistics_;  ///< The applied pass statistics.
 };
 
 /// Undefined template class for specialization of Preprocessor
@@ -21,6 +21,8 @@
 
 #include "probability_analysis.h"
 
+#include <algorithm>
+
 #include <boost/range/algorithm/find_if.hpp>
 
 #include "event.h"
@@ -40,11 +42,17 @@ void ProbabilityAnalysis::Analyze() noexcept {
   LOG(DEBUG3) << "Calculating probabilities...";
   // Get the total probability.
   p_total_ = this->CalculateTotalProbability();
+  p_bounds_ = this->GetProbabilityBounds();
   assert(p_total_ >= 0 && p_total_ <= 1 && "The total probability is invalid.");
   if (p_total_ == 1 &&
       Analysis::settings().approximation() != Approximation::kNone) {
     Analysis::AddWarning("Probability may have been adjusted to 1.");
   }
+  if (p_bounds_) {
+    auto [lower, upper] = *p_bounds_;
+    if (upper - lower > Analysis::settings().bound_tolerance() * upper)
+      Analysis::AddWarning("The probability bounds are not within tolerance.");
+  }
 
   p_time_ = this->CalculateProbabilityOverTime();
   if (Analysis::settings().safety_integrity_levels())
@@ -185,6 +193,78 @@ double McubCalculator::Calculate(
   return 1 - m;
 }
 
+namespace {
+
+/// Sums the probabilities of intersections of products
+/// over the combinations of the remaining products.
+///
+/// @param[in] products  The products with positive indices of variables.
+/// @param[in] start  The first product available for the combinations.
+/// @param[in] k  The number of products left to intersect.
+/// @param[in] p  The probability of the current intersection.
+/// @param[in] p_vars  Probabilities of events mapped by the variable indices.
+/// @param[in,out] counts  The multiplicity of variables in the intersection.
+///
+/// @returns The sum of the intersection probabilities.
+double SumIntersections(const std::vector<std::vector<int>>& products,
+                        int start, int k, double p,
+                        const Pdag::IndexMap<double>& p_vars,
+                        Pdag::IndexMap<int>* counts) noexcept {
+  if (!k)
+    return p;
+  double sum = 0;
+  for (int i = start; i <= static_cast<int>(products.size()) - k; ++i) {
+    double p_intersection = p;
+    for (int index : products[i]) {
+      if ((*counts)[index]++ == 0)
+        p_intersection *= p_vars[index];
+    }
+    if (p_intersection != 0)
+      sum += SumIntersections(products, i + 1, k - 1, p_intersection, p_vars,
+                              counts);
+    for (int index : products[i])
+      --(*counts)[index];
+  }
+  return sum;
+}
+
+}  // namespace
+
+double BonferroniCalculator::Calculate(
+    const Zbdd& cut_sets, const Pdag::IndexMap<double>& p_vars) noexcept {
+  std::vector<std::vector<int>> products;
+  double sum = 0;  // The alternating sum of the inclusion-exclusion terms.
+  double lower = 0;  // The most probable product is the trivial lower bound.
+  for (const std::vector<int>& cut_set : cut_sets) {
+    double p = CutSetProbabilityCalculator::Calculate(cut_set, p_vars);
+    sum += p;
+    lower = std::max(lower, p);
+    products.push_back(cut_set);
+  }
+  double upper = std::min(sum, 1.0);
+  double tolerance = cut_sets.settings().bound_tolerance();
+  Pdag::IndexMap<int> counts(p_vars.size());
+  double num_intersections = products.size();
+  int k = 2;
+  for (; k <= products.size() && upper - lower > tolerance * upper; ++k) {
+    num_intersections *= static_cast<double>(products.size() - k + 1) / k;
+    if (num_intersections > kMaxIntersections)
+      break;
+    double term = SumIntersections(products, 0, k, 1, p_vars, &counts);
+    if (k % 2) {
+      sum += term;
+      upper = std::min(upper, sum);
+    } else {
+      sum -= term;
+      lower = std::max(lower, sum);
+    }
+  }
+  if (k > products.size())  // The complete inclusion-exclusion.
+    lower = upper = std::clamp(sum, 0.0, 1.0);
+  bounds_ = {lower, upper};
+  return upper;
+}
+
 void ProbabilityAnalyzerBase::ExtractVariableProbabilities() {
   p_vars_.reserve(graph_->basic_events().size());
   for (const mef::BasicEvent* event : graph_->basic_events())
@@ -221,8 +301,6 @@ ProbabilityAnalyzer<Bdd>::ProbabilityAnalyzer(FaultTreeAnalyzer<Bdd>* fta,
     : ProbabilityAnalyzerBase(fta, mission_time), owner_(false) {
   LOG(DEBUG2) << "Re-using BDD from FaultTreeAnalyzer for ProbabilityAnalyzer";
   bdd_graph_ = fta->algorithm();
-  const Bdd::VertexPtr& root = bdd_graph_->root().vertex;
-  current_mark_ = root->terminal() ? false : Ite::Ref(root).mark();
 }
 
 ProbabilityAnalyzer<Bdd>::~ProbabilityAnalyzer() noexcept {
@@ -234,38 +312,25 @@ double ProbabilityAnalyzer<Bdd>::CalculateTotalProbability(
     const Pdag::IndexMap<double>& p_vars) noexcept {
   CLOCK(calc_time);  // BDD based calculation time.
   LOG(DEBUG4) << "Calculating probability with BDD...";
-  current_mark_ = !current_mark_;
   double prob =
-      CalculateProbability(bdd_graph_->root().vertex, current_mark_, p_vars);
+      CalculateProbability(bdd_graph_->root().vertex, Ite::NewMark(), p_vars);
   if (bdd_graph_->root().complement)
     prob = 1 - prob;
   LOG(DEBUG4) << "Calculated probability " << prob << " in " << DUR(calc_time);
   return prob;
 }
 
-void ProbabilityAnalyzer<Bdd>::CreateBdd(
-    const FaultTreeAnalysis& fta) noexcept {
-  CLOCK(total_time);
-
-  CLOCK(ft_creation);
-  Pdag graph(fta.top_event(), Analysis::settings().ccf_analysis());
-  LOG(DEBUG2) << "PDAG is created in " << DUR(ft_creation);
-
-  CLOCK(prep_time);  // Overall preprocessing time.
-  LOG(DEBUG2) << "Preprocessing...";
-  CustomPreprocessor<Bdd>{&graph}();
-  LOG(DEBUG2) << "Finished preprocessing in " << DUR(prep_time);
-
+void ProbabilityAnalyzer<Bdd>::CreateBdd() noexcept {
   CLOCK(bdd_time);  // BDD based calculation time.
-  LOG(DEBUG2) << "Creating BDD for Probability Analysis...";
-  bdd_graph_ = new Bdd(&graph, Analysis::settings());
+  LOG(DEBUG2) << "Creating BDD from the preprocessed PDAG...";
+  bdd_graph_ = new Bdd(ProbabilityAnalyzerBase::graph(), Analysis::settings());
   LOG(DEBUG2) << "BDD is created in " << DUR(bdd_time);
 
-  Analysis::AddAnalysisTime(DUR(total_time));
+  Analysis::AddAnalysisTime(DUR(bdd_time));
 }
 
 double ProbabilityAnalyzer<Bdd>::CalculateProbability(
-    const Bdd::VertexPtr& vertex, bool mark,
+    const Bdd::VertexPtr& vertex, int mark,
     const Pdag::IndexMap<double>& p_vars) noexcept {
   if (vertex->terminal())
     return 1;
@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <optional>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -81,6 +83,14 @@ class ProbabilityAnalysis : public Analysis {
   /// @pre The analysis is done.
   double p_total() const { return p_total_; }
 
+  /// @returns The lower and upper bounds of the total probability
+  ///          if the calculation method provides them.
+  ///
+  /// @pre The analysis is done.
+  const std::optional<std::pair<double, double>>& p_bounds() const {
+    return p_bounds_;
+  }
+
   /// @returns The probability values over the mission time in time steps.
   ///          The empty container implies no calculation has been done.
   ///
@@ -107,6 +117,13 @@ class ProbabilityAnalysis : public Analysis {
   /// @returns The total probability of the graph or products.
   virtual double CalculateTotalProbability() noexcept = 0;
 
+  /// @returns The {lower, upper} bounds
+  ///          of the last total probability calculation if any.
+  virtual std::optional<std::pair<double, double>> GetProbabilityBounds()
+      const noexcept {
+    return {};
+  }
+
   /// Calculates the probability evolution through the mission time.
   ///
   /// @returns The probabilities at time steps.
@@ -117,6 +134,8 @@ class ProbabilityAnalysis : public Analysis {
   void ComputeSil() noexcept;
 
   double p_total_;  ///< Total probability of the top event.
+  /// The {lower, upper} bounds of the total probability.
+  std::optional<std::pair<double, double>> p_bounds_;
   mef::MissionTime* mission_time_;  ///< The mission time expression.
   std::vector<std::pair<double, double>> p_time_;  ///< {probability, time}.
   std::unique_ptr<Sil> sil_;  ///< The Safety Integrity Level results.
@@ -179,6 +198,48 @@ class McubCalculator : private CutSetProbabilityCalculator {
                    const Pdag::IndexMap<double>& p_vars) noexcept;
 };
 
+/// Quantitative calculator of probability bounds
+/// with the Bonferroni inequalities,
+/// i.e., the truncated inclusion-exclusion over the products.
+/// The sums truncated after odd terms are the upper bounds,
+/// and the sums truncated after even terms are the lower bounds
+/// of the probability of the union of the products.
+///
+/// @note The bounds are certified only for the analysis products,
+///       which may be truncated by the order or probability cut-offs.
+class BonferroniCalculator : private CutSetProbabilityCalculator {
+ public:
+  /// The max number of product intersections
+  /// to compute an inclusion-exclusion term.
+  /// The k-th term takes C(n, k) intersections of n products,
+  /// so the limit bounds the work of the next term
+  /// instead of letting the terms grow combinatorially.
+  /// For example, 100 products allow the first 4 terms,
+  /// and 1000 products allow only the first 2 terms.
+  static constexpr double kMaxIntersections = 1e7;
+
+  /// Calculates the bounds of the total probability
+  /// adding inclusion-exclusion terms
+  /// until the gap between the bounds is within the tolerance
+  /// relative to the upper bound.
+  ///
+  /// @param[in] cut_sets  A collection of sets of indices of basic events.
+  /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
+  ///
+  /// @returns The upper bound of the total probability.
+  ///
+  /// @note The calculation stops early with the best bounds so far
+  ///       if the next term requires more than kMaxIntersections.
+  double Calculate(const Zbdd& cut_sets,
+                   const Pdag::IndexMap<double>& p_vars) noexcept;
+
+  /// @returns The {lower, upper} bounds of the last calculation.
+  const std::pair<double, double>& bounds() const { return bounds_; }
+
+ private:
+  std::pair<double, double> bounds_;  ///< The last calculated bounds.
+};
+
 /// Base class for Probability analyzers.
 class ProbabilityAnalyzerBase : public ProbabilityAnalysis {
  public:
@@ -258,6 +319,15 @@ class ProbabilityAnalyzer : public ProbabilityAnalyzerBase {
   }
 
  private:
+  std::optional<std::pair<double, double>> GetProbabilityBounds() const
+      noexcept final {
+    if constexpr (std::is_same_v<Calculator, BonferroniCalculator>) {
+      return calc_.bounds();
+    } else {
+      return {};
+    }
+  }
+
   Calculator calc_;  ///< Provider of the calculation logic.
 };
 
@@ -268,6 +338,8 @@ class ProbabilityAnalyzer<Bdd> : public ProbabilityAnalyzerBase {
  public:
   /// Constructs probability analyzer from a fault tree analyzer
   /// with the same algorithm.
+  /// The BDD is built from the already preprocessed PDAG
+  /// of the fault tree analyzer.
   ///
   /// @tparam Algorithm  Fault tree analysis algorithm.
   ///
@@ -275,10 +347,8 @@ class ProbabilityAnalyzer<Bdd> : public ProbabilityAnalyzerBase {
   template <class Algorithm>
   ProbabilityAnalyzer(const FaultTreeAnalyzer<Algorithm>* fta,
                       mef::MissionTime* mission_time)
-      : ProbabilityAnalyzerBase(fta, mission_time),
-        current_mark_(false),
-        owner_(true) {
-    CreateBdd(*fta);
+      : ProbabilityAnalyzerBase(fta, mission_time), owner_(true) {
+    CreateBdd();
   }
 
   /// Reuses BDD structures from Fault tree analyzer.
@@ -303,18 +373,19 @@ class ProbabilityAnalyzer<Bdd> : public ProbabilityAnalyzerBase {
       const Pdag::IndexMap<double>& p_vars) noexcept final;
 
  private:
-  /// Creates a new BDD for use by the analyzer.
-  ///
-  /// @param[in] fta  The fault tree analysis providing the root gate.
+  /// Creates a new BDD for use by the analyzer
+  /// from the PDAG of the fault tree analysis.
   ///
   /// @pre The function is called in the constructor only once.
-  void CreateBdd(const FaultTreeAnalysis& fta) noexcept;
+  /// @pre The PDAG is preprocessed by any fault tree analysis algorithm
+  ///      (a superset of the preprocessing for BDD).
+  void CreateBdd() noexcept;
 
   /// Calculates exact probability
   /// of a function graph represented by its root BDD vertex.
   ///
   /// @param[in] vertex  The root vertex of a function graph.
-  /// @param[in] mark  A flag to mark traversed vertices.
+  /// @param[in] mark  The unique mark of this traversal.
   /// @param[in] p_vars  The probabilities of the variables
   ///                    mapped by their indices.
   ///
@@ -322,11 +393,10 @@ class ProbabilityAnalyzer<Bdd> : public ProbabilityAnalyzerBase {
   ///
   /// @warning If a vertex is already marked with the input mark,
   ///          it will not be traversed and updated with a probability value.
-  double CalculateProbability(const Bdd::VertexPtr& vertex, bool mark,
+  double CalculateProbability(const Bdd::VertexPtr& vertex, int mark,
                               const Pdag::IndexMap<double>& p_vars) noexcept;
 
   Bdd* bdd_graph_;  ///< The main BDD graph for analysis.
-  bool current_mark_;  ///< To keep track of BDD current mark.
   bool owner_;  ///< Indication that pointers are handles.
 };
 
@@ -26,6 +26,7 @@
 #include <memory>
 #include <optional>
 #include <string_view>
+#include <utility>
 
 #include <boost/predef.h>
 
@@ -130,6 +131,15 @@ void Project::GatherOptions(const xml::Element& root) {
 
       } else if (name == "approximation") {
         settings_.approximation(option_group.attribute("name"));
+        if (std::optional<double> tolerance =
+                option_group.attribute<double>("tolerance"))
+          settings_.bound_tolerance(*tolerance);
+
+      } else if (name == "preprocessing") {
+        SetPreprocessing(option_group);
+
+      } else if (name == "sampling") {
+        settings_.sampling(option_group.attribute("name"));
 
       } else if (name == "limits") {
         SetLimits(option_group);
@@ -161,11 +171,34 @@ void Project::SetAnalysis(const xml::Element& analysis) {
            [this](bool flag) { settings_.importance_analysis(flag); });
   set_flag("uncertainty",
            [this](bool flag) { settings_.uncertainty_analysis(flag); });
+  set_flag("sensitivity",
+           [this](bool flag) { settings_.sensitivity_analysis(flag); });
   set_flag("ccf", [this](bool flag) { settings_.ccf_analysis(flag); });
+  set_flag("shared-bdd", [this](bool flag) { settings_.shared_bdd(flag); });
+  set_flag("phase-cofactors",
+           [this](bool flag) { settings_.phase_cofactors(flag); });
+  set_flag("raw-samples", [this](bool flag) { settings_.raw_samples(flag); });
   set_flag("sil",
            [this](bool flag) { settings_.safety_integrity_levels(flag); });
 }
 
+void Project::SetPreprocessing(const xml::Element& preprocessing) {
+  if (std::string_view policy = preprocessing.attribute("policy");
+      !policy.empty())
+    settings_.preprocessing_policy(policy);
+
+  std::vector<core::PreprocessingPass> passes;
+  for (xml::Element pass : preprocessing.children("pass")) {
+    auto it = boost::find(core::kPreprocessingPassToString,
+                          pass.attribute("name"));
+    assert(it != std::end(core::kPreprocessingPassToString));
+    passes.push_back(static_cast<core::PreprocessingPass>(
+        std::distance(core::kPreprocessingPassToString, it)));
+  }
+  // No passes mean no optimization as with the empty command-line list.
+  settings_.preprocessing_passes(std::move(passes));
+}
+
 void Project::SetLimits(const xml::Element& limits) {
   for (xml::Element limit : limits.children()) {
     std::string_view name = limit.name();
@@ -175,6 +208,9 @@ void Project::SetLimits(const xml::Element& limits) {
     } else if (name == "cut-off") {
       settings_.cut_off(limit.text<double>());
 
+    } else if (name == "top-products") {
+      settings_.top_products(limit.text<int>());
+
     } else if (name == "mission-time") {
       settings_.mission_time(limit.text<double>());
 
@@ -184,6 +220,12 @@ void Project::SetLimits(const xml::Element& limits) {
     } else if (name == "number-of-trials") {
       settings_.num_trials(limit.text<int>());
 
+    } else if (name == "target-precision") {
+      settings_.target_precision(limit.text<double>());
+
+    } else if (name == "time-budget") {
+      settings_.time_budget(limit.text<double>());
+
     } else if (name == "number-of-quantiles") {
       settings_.num_quantiles(limit.text<int>());
 
@@ -192,6 +234,9 @@ void Project::SetLimits(const xml::Element& limits) {
 
     } else if (name == "seed") {
       settings_.seed(limit.text<int>());
+
+    } else if (name == "number-of-threads") {
+      settings_.num_threads(limit.text<int>());
     }
   }
 }
@@ -74,6 +74,14 @@ class Project {
   /// @param[in] analysis  Analysis element node.
   void SetAnalysis(const xml::Element& analysis);
 
+  /// Extracts the graph optimization passes of preprocessing
+  /// and the policy to apply them.
+  ///
+  /// @param[in] preprocessing  The XML element with the ordered passes.
+  ///
+  /// @throws SettingsError  The policy is not recognized.
+  void SetPreprocessing(const xml::Element& preprocessing);
+
   /// Extracts limits for analysis.
   ///
   /// @param[in] limits  An XML element containing various limits.
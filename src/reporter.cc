@@ -20,6 +20,7 @@
 
 #include "reporter.h"
 
+#include <cmath>
 #include <ctime>
 
 #include <memory>
@@ -69,8 +70,8 @@ void PutId(const core::RiskAnalysis::Result::Id& id,
 }  // namespace
 
 void Reporter::Report(const core::RiskAnalysis& risk_an, std::FILE* out,
-                      bool indent) {
-  xml::Stream xml_stream(out, indent);
+                      bool indent, xml::Compression compression) {
+  xml::Stream xml_stream(out, indent, compression);
   xml::StreamElement report = xml_stream.root("report");
   ReportInformation(risk_an, &report);
 
@@ -98,19 +99,26 @@ void Reporter::Report(const core::RiskAnalysis& risk_an, std::FILE* out,
 
     if (result.uncertainty_analysis)
       ReportResults(result.id, *result.uncertainty_analysis, &results);
+
+    if (result.sensitivity_analysis)
+      ReportResults(result.id, *result.sensitivity_analysis, &results);
   }
 }
 
 void Reporter::Report(const core::RiskAnalysis& risk_an,
-                      const std::string& file, bool indent) {
+                      const std::string& file, bool indent,
+                      std::optional<xml::Compression> compression) {
+  if (!compression)
+    compression = xml::CompressionFromPath(file);
+  const char* mode = *compression == xml::Compression::kNone ? "w" : "wb";
   std::unique_ptr<std::FILE, decltype(&std::fclose)> fp(
-      std::fopen(file.c_str(), "w"), &std::fclose);
+      std::fopen(file.c_str(), mode), &std::fclose);
   try {
     if (!fp) {
       SCRAM_THROW(IOError("Cannot open the output file for report."))
-          << boost::errinfo_errno(errno) << boost::errinfo_file_open_mode("w");
+          << boost::errinfo_errno(errno) << boost::errinfo_file_open_mode(mode);
     }
-    Report(risk_an, fp.get(), indent);
+    Report(risk_an, fp.get(), indent, *compression);
   } catch (IOError& err) {
     err << boost::errinfo_file_name(file);
     throw;
@@ -139,9 +147,10 @@ void Reporter::ReportCalculatedQuantity<core::FaultTreeAnalysis>(
       case core::Algorithm::kMocus:
         methods.SetAttribute("name", "MOCUS");
     }
-    methods.AddChild("limits")
-        .AddChild("product-order")
-        .AddText(settings.limit_order());
+    xml::StreamElement limits = methods.AddChild("limits");
+    limits.AddChild("product-order").AddText(settings.limit_order());
+    if (settings.top_products())
+      limits.AddChild("top-products").AddText(settings.top_products());
   }
   if (settings.ccf_analysis()) {
     information->AddChild("calculated-quantity")
@@ -174,6 +183,9 @@ void Reporter::ReportCalculatedQuantity<core::ProbabilityAnalysis>(
       break;
     case core::Approximation::kMcub:
       methods.SetAttribute("name", "MCUB Approximation");
+      break;
+    case core::Approximation::kBonferroni:
+      methods.SetAttribute("name", "Bonferroni Bounds");
   }
   xml::StreamElement limits = methods.AddChild("limits");
   limits.AddChild("mission-time").AddText(settings.mission_time());
@@ -205,6 +217,31 @@ void Reporter::ReportCalculatedQuantity<core::UncertaintyAnalysis>(
   methods.SetAttribute("name", "Monte Carlo");
   xml::StreamElement limits = methods.AddChild("limits");
   limits.AddChild("number-of-trials").AddText(settings.num_trials());
+  if (settings.target_precision()) {
+    limits.AddChild("target-precision").AddText(settings.target_precision());
+  }
+  if (settings.time_budget()) {
+    limits.AddChild("time-budget").AddText(settings.time_budget());
+  }
+  if (settings.seed() >= 0) {
+    limits.AddChild("seed").AddText(settings.seed());
+  }
+}
+
+/// Describes the sensitivity analysis and techniques.
+template <>
+void Reporter::ReportCalculatedQuantity<core::SensitivityAnalysis>(
+    const core::Settings& settings, xml::StreamElement* information) {
+  xml::StreamElement quant = information->AddChild("calculated-quantity");
+  quant.SetAttribute("name", "Sensitivity Analysis")
+      .SetAttribute("definition",
+                    "Variance-based global sensitivity indices "
+                    "of uncertain basic events");
+
+  xml::StreamElement methods = quant.AddChild("calculation-method");
+  methods.SetAttribute("name", "Saltelli Sampling");
+  xml::StreamElement limits = methods.AddChild("limits");
+  limits.AddChild("number-of-trials").AddText(settings.num_trials());
   if (settings.seed() >= 0) {
     limits.AddChild("seed").AddText(settings.seed());
   }
@@ -230,6 +267,9 @@ void Reporter::ReportCalculatedQuantity<core::RiskAnalysis>(
   if (settings.uncertainty_analysis()) {
     ReportCalculatedQuantity<core::UncertaintyAnalysis>(settings, information);
   }
+  if (settings.sensitivity_analysis()) {
+    ReportCalculatedQuantity<core::SensitivityAnalysis>(settings, information);
+  }
 }
 
 void Reporter::ReportInformation(const core::RiskAnalysis& risk_an,
@@ -333,6 +373,10 @@ void Reporter::ReportPerformance(const core::RiskAnalysis& risk_an,
     if (result.uncertainty_analysis)
       calc_time.AddChild("uncertainty")
           .AddText(result.uncertainty_analysis->analysis_time());
+
+    if (result.sensitivity_analysis)
+      calc_time.AddChild("sensitivity")
+          .AddText(result.sensitivity_analysis->analysis_time());
   }
 }
 
@@ -390,8 +434,13 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
       .SetAttribute("basic-events", fta.products().product_events().size())
       .SetAttribute("products", fta.products().size());
 
-  if (prob_analysis)
+  if (prob_analysis) {
     sum_of_products.SetAttribute("probability", prob_analysis->p_total());
+    if (const auto& bounds = prob_analysis->p_bounds()) {
+      sum_of_products.SetAttribute("lower-bound", bounds->first)
+          .SetAttribute("upper-bound", bounds->second);
+    }
+  }
 
   if (fta.products().empty() == false) {
     sum_of_products.SetAttribute(
@@ -402,12 +451,10 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
                     " "));
   }
 
-  double sum = 0;  // Sum of probabilities for contribution calculations.
-  if (prob_analysis) {
-    for (const core::Product& product_set : fta.products())
-      sum += product_set.p();
-  }
-  for (const core::Product& product_set : fta.products()) {
+  // Sum of probabilities for contribution calculations.
+  double sum = prob_analysis ? fta.products().p_sum() : 0;
+  auto report_product = [this, &sum_of_products, prob_analysis,
+                         sum](const core::Product& product_set) {
     xml::StreamElement product = sum_of_products.AddChild("product");
     product.SetAttribute("order", product_set.order());
     if (prob_analysis) {
@@ -419,6 +466,13 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
     for (const core::Literal& literal : product_set) {
       ReportLiteral(literal, &product);
     }
+  };
+  if (int k = fta.settings().top_products(); k && prob_analysis) {
+    for (const core::Product& product_set : fta.products().top(k))
+      report_product(product_set);
+  } else {
+    for (const core::Product& product_set : fta.products())
+      report_product(product_set);
   }
 }
 
@@ -500,6 +554,10 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
   if (!uncert_analysis.warnings().empty()) {
     measure.SetAttribute("warning", uncert_analysis.warnings());
   }
+  measure.SetAttribute("trials", uncert_analysis.num_trials());
+  if (std::isfinite(uncert_analysis.precision())) {
+    measure.SetAttribute("precision", uncert_analysis.precision());
+  }
   measure.AddChild("mean").SetAttribute("value", uncert_analysis.mean());
   measure.AddChild("standard-deviation")
       .SetAttribute("value", uncert_analysis.sigma());
@@ -547,6 +605,26 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
   }
 }
 
+void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
+                             const core::SensitivityAnalysis& sens_analysis,
+                             xml::StreamElement* results) {
+  xml::StreamElement sensitivity = results->AddChild("sensitivity");
+  scram::PutId(id, &sensitivity);
+  if (!sens_analysis.warnings().empty()) {
+    sensitivity.SetAttribute("warning", sens_analysis.warnings());
+  }
+  sensitivity.SetAttribute("basic-events", sens_analysis.indices().size())
+      .SetAttribute("variance", sens_analysis.variance());
+
+  for (const core::SensitivityRecord& entry : sens_analysis.indices()) {
+    ReportBasicEvent(entry.event, &sensitivity,
+                     [&entry](xml::StreamElement* element) {
+                       element->SetAttribute("first-order", entry.first_order)
+                           .SetAttribute("total", entry.total);
+                     });
+  }
+}
+
 void Reporter::ReportLiteral(const core::Literal& literal,
                              xml::StreamElement* parent) {
   auto add_data = [](xml::StreamElement* /*element*/) {};
@@ -22,6 +22,7 @@
 
 #include <cstdio>
 
+#include <optional>
 #include <string>
 
 #include "event.h"
@@ -30,6 +31,7 @@
 #include "model.h"
 #include "probability_analysis.h"
 #include "risk_analysis.h"
+#include "sensitivity_analysis.h"
 #include "settings.h"
 #include "uncertainty_analysis.h"
 #include "xml_stream.h"
@@ -45,13 +47,16 @@ class Reporter {
   /// @param[in] risk_an  Risk analysis with results.
   /// @param[out] out  The report destination stream.
   /// @param[in] indent  The flag to indent output for readability.
+  /// @param[in] compression  The compression of the report on the fly.
   ///
   /// @pre The output destination is used only by this reporter.
   ///      There is going to be no appending to the stream after the report.
   ///
   /// @throws IOError  The write operation has failed.
+  /// @throws xml::StreamError  The compression is not supported.
   void Report(const core::RiskAnalysis& risk_an, std::FILE* out,
-              bool indent = true);
+              bool indent = true,
+              xml::Compression compression = xml::Compression::kNone);
 
   /// A convenience function to generate the report into a file.
   /// This function overwrites the file.
@@ -59,11 +64,15 @@ class Reporter {
   /// @param[in] risk_an  Risk analysis with results.
   /// @param[out] file  The output destination.
   /// @param[in] indent  The flag to indent output for readability.
+  /// @param[in] compression  The compression of the report on the fly;
+  ///                         deduced from the file extension if not given.
   ///
   /// @throws IOError  The output file is not accessible,
   ///                  or the write operation has failed.
+  /// @throws xml::StreamError  The compression is not supported.
   void Report(const core::RiskAnalysis& risk_an, const std::string& file,
-              bool indent = true);
+              bool indent = true,
+              std::optional<xml::Compression> compression = {});
 
  private:
   /// This function populates information
@@ -168,6 +177,15 @@ class Reporter {
                      const core::UncertaintyAnalysis& uncert_analysis,
                      xml::StreamElement* results);
 
+  /// Reports the Sobol indices of sensitivity analysis.
+  ///
+  /// @param[in] id  The analysis id.
+  /// @param[in] sens_analysis  Sensitivity analysis with results.
+  /// @param[in,out] results  XML element to for all results.
+  void ReportResults(const core::RiskAnalysis::Result::Id& id,
+                     const core::SensitivityAnalysis& sens_analysis,
+                     xml::StreamElement* results);
+
   /// Reports literal in products.
   ///
   /// @param[in] literal  A literal to be reported.
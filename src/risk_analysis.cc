@@ -20,12 +20,20 @@
 
 #include "risk_analysis.h"
 
+#include <string>
+#include <unordered_map>
+#include <variant>
+
+#include <boost/range/algorithm.hpp>
+
 #include "bdd.h"
 #include "expression/random_deviate.h"
 #include "ext/scope_guard.h"
 #include "fault_tree.h"
 #include "logger.h"
 #include "mocus.h"
+#include "pdag.h"
+#include "preprocessor.h"
 #include "zbdd.h"
 
 namespace scram::core {
@@ -33,6 +41,8 @@ namespace scram::core {
 RiskAnalysis::RiskAnalysis(mef::Model* model, const Settings& settings)
     : Analysis(settings), model_(model) {}
 
+RiskAnalysis::~RiskAnalysis() noexcept = default;
+
 void RiskAnalysis::Analyze() noexcept {
   assert(results_.empty() && "Rerunning the analysis.");
   // Set the seed for the pseudo-random number generator if given explicitly.
@@ -43,6 +53,18 @@ void RiskAnalysis::Analyze() noexcept {
   if (model_->alignments().empty()) {
     RunAnalysis();
   } else {
+    if (Analysis::settings().phase_cofactors()) {
+      for (const mef::Alignment& alignment : model_->alignments()) {
+        for (const mef::Phase& phase : alignment.phases()) {
+          for (const mef::SetHouseEvent* instruction : phase.instructions()) {
+            auto it =
+                model_->table<mef::HouseEvent>().find(instruction->name());
+            assert(it != model_->table<mef::HouseEvent>().end());
+            parameters_.insert(&*it);
+          }
+        }
+      }
+    }
     for (const mef::Alignment& alignment : model_->alignments()) {
       for (const mef::Phase& phase : alignment.phases())
         RunAnalysis(Context{alignment, phase});
@@ -50,6 +72,42 @@ void RiskAnalysis::Analyze() noexcept {
   }
 }
 
+void RiskAnalysis::Requantify() noexcept {
+  assert(event_tree_results_.empty() && model_->alignments().empty() &&
+         "Only fault tree results are requantified.");
+  if (Analysis::settings().seed() >= 0)
+    mef::RandomDeviate::seed(Analysis::settings().seed());
+
+  for (Result& result : results_) {
+    // The dependent analyses go first.
+    result.sensitivity_analysis.reset();
+    result.uncertainty_analysis.reset();
+    result.importance_analysis.reset();
+    result.probability_analysis.reset();
+    result.fault_tree_analysis->products().ClearTopProducts();
+    if (!Analysis::settings().probability_analysis())
+      continue;
+    LOG(INFO) << "Requantifying gate: "
+              << std::get<const mef::Gate*>(result.id.target)->id();
+    switch (Analysis::settings().algorithm()) {
+      case Algorithm::kBdd:
+        RunAnalysis(static_cast<FaultTreeAnalyzer<Bdd>*>(
+                        result.fault_tree_analysis.get()),
+                    &result);
+        break;
+      case Algorithm::kZbdd:
+        RunAnalysis(static_cast<FaultTreeAnalyzer<Zbdd>*>(
+                        result.fault_tree_analysis.get()),
+                    &result);
+        break;
+      case Algorithm::kMocus:
+        RunAnalysis(static_cast<FaultTreeAnalyzer<Mocus>*>(
+                        result.fault_tree_analysis.get()),
+                    &result);
+    }
+  }
+}
+
 void RiskAnalysis::RunAnalysis(std::optional<Context> context) noexcept {
   std::vector<std::pair<mef::HouseEvent*, bool>> house_events;
   /// Restores the model after application of the context.
@@ -86,8 +144,17 @@ void RiskAnalysis::RunAnalysis(std::optional<Context> context) noexcept {
     if (initiating_event.event_tree()) {
       LOG(INFO) << "Running event tree analysis: " << initiating_event.name();
       auto eta = std::make_unique<EventTreeAnalysis>(
-          initiating_event, Analysis::settings(), model_->context());
+          initiating_event, Analysis::settings(), model_->context(),
+          parameters_.empty() ? nullptr : &parameters_);
       eta->Analyze();
+      if (Analysis::settings().shared_bdd()) {
+        QuantifySequences(eta.get());
+        event_tree_results_.push_back(
+            {initiating_event, context, std::move(eta)});
+        LOG(INFO) << "Finished event tree analysis: "
+                  << initiating_event.name();
+        continue;
+      }
       for (EventTreeAnalysis::Result& result : eta->sequences()) {
         const mef::Sequence& sequence = result.sequence;
         LOG(INFO) << "Running analysis for sequence: " << sequence.name();
@@ -132,27 +199,237 @@ void RiskAnalysis::RunAnalysis(const mef::Gate& target,
   }
 }
 
+namespace {
+
+/// Calculates the probability of a function in the shared BDD.
+///
+/// @param[in] vertex  The root vertex of the function graph.
+/// @param[in] mark  The traversal mark common to all the functions.
+/// @param[in] p_vars  The probabilities of the shared variables.
+///
+/// @returns The probability of the function graph.
+double CalculateProbability(const Bdd::VertexPtr& vertex, int mark,
+                            const Pdag::IndexMap<double>& p_vars) noexcept {
+  if (vertex->terminal())
+    return 1;
+  Ite& ite = Ite::Ref(vertex);
+  if (ite.mark() == mark)
+    return ite.p();
+  ite.mark(mark);
+  assert(!ite.module() && "Modules are not shared among sequences.");
+  double high = CalculateProbability(ite.high(), mark, p_vars);
+  double low = CalculateProbability(ite.low(), mark, p_vars);
+  if (ite.complement_edge())
+    low = 1 - low;
+  double p_var = p_vars[ite.index()];
+  ite.p(p_var * high + (1 - p_var) * low);
+  return ite.p();
+}
+
+/// The proxies of the parameter house events in the event-tree analysis.
+using ProxyTable =
+    std::unordered_map<const mef::BasicEvent*, const mef::HouseEvent*>;
+
+/// Serializes a formula with the events of the model.
+/// The gates are written once in the depth-first order
+/// and referenced by their order numbers afterwards.
+///
+/// @param[in] formula  The formula to serialize.
+/// @param[in] proxies  The basic-event proxies of the parameter house events.
+/// @param[in,out] gates  The order numbers of the serialized gates.
+/// @param[in,out] signature  The serialization destination.
+void Serialize(const mef::Formula& formula, const ProxyTable& proxies,
+               std::unordered_map<const mef::Gate*, int>* gates,
+               std::string* signature) noexcept {
+  *signature += mef::kConnectiveToString[formula.connective()];
+  if (formula.min_number())
+    *signature += ' ' + std::to_string(*formula.min_number());
+  if (formula.max_number())
+    *signature += ' ' + std::to_string(*formula.max_number());
+  *signature += '(';
+  for (const mef::Formula::Arg& arg : formula.args()) {
+    if (arg.complement)
+      *signature += '~';
+    if (auto* basic_event = std::get_if<mef::BasicEvent*>(&arg.event)) {
+      if (auto it = proxies.find(*basic_event); it != proxies.end()) {
+        *signature += "p:" + it->second->id();
+      } else {
+        *signature += "b:" + (*basic_event)->id();
+      }
+    } else if (auto* house_event = std::get_if<mef::HouseEvent*>(&arg.event)) {
+      *signature += "h:" + (*house_event)->id() +
+                    ((*house_event)->state() ? "=1" : "=0");
+    } else {
+      const mef::Gate* gate = std::get<mef::Gate*>(arg.event);
+      auto [it, inserted] = gates->try_emplace(gate, gates->size());
+      *signature += "g" + std::to_string(it->second);
+      if (inserted)
+        Serialize(gate->formula(), proxies, gates, signature);
+    }
+    *signature += ' ';
+  }
+  *signature += ')';
+}
+
+}  // namespace
+
+/// Event-tree sequences converted into a shared BDD.
+/// The probabilities are calculated with the current state of the model,
+/// so the BDD serves the cofactors of the parameter house events.
+class SequenceBdd {
+ public:
+  /// Converts the sequence formulas into the shared BDD.
+  ///
+  /// @param[in] eta  The analysis with the collected sequence formulas.
+  /// @param[in] settings  The analysis settings.
+  /// @param[in] model  The model with the substitutions.
+  SequenceBdd(const EventTreeAnalysis& eta, const Settings& settings,
+              const mef::Model* model) noexcept;
+
+  /// Calculates the sequence probabilities in a single pass
+  /// with the current probabilities of the basic events
+  /// and the current states of the parameter house events.
+  ///
+  /// @param[in,out] eta  The analysis of the same event tree.
+  ///
+  /// @pre The sequence formulas of the analysis match this BDD.
+  void Quantify(EventTreeAnalysis* eta) noexcept;
+
+  /// @param[in] eta  The analysis of the same event tree in another phase.
+  ///
+  /// @returns true if the analysis has the same sequences and formulas.
+  bool Matches(const EventTreeAnalysis& eta) const noexcept {
+    return GetSignatures(eta) == signatures_;
+  }
+
+ private:
+  /// The serialized formulas of sequences.
+  using Signatures = std::unordered_map<const mef::Sequence*, std::string>;
+
+  /// @param[in] eta  The analysis with the collected sequence formulas.
+  ///
+  /// @returns The sequence formulas serialized with the events of the model.
+  static Signatures GetSignatures(const EventTreeAnalysis& eta) noexcept;
+
+  Bdd bdd_;  ///< The shared BDD manager.
+  /// The shared variables in the order of indices
+  /// with the house events of the parameter proxies.
+  std::vector<std::pair<const mef::BasicEvent*, const mef::HouseEvent*>>
+      variables_;
+  /// The root functions of the sequences.
+  std::unordered_map<const mef::Sequence*, Bdd::Function> functions_;
+  Signatures signatures_;  ///< The formulas converted into the functions.
+};
+
+SequenceBdd::SequenceBdd(const EventTreeAnalysis& eta, const Settings& settings,
+                         const mef::Model* model) noexcept
+    : bdd_(settings), signatures_(GetSignatures(eta)) {
+  TIMER(DEBUG2, "Converting sequences into a shared BDD");
+  /// The shared variables with their indices and orders.
+  std::unordered_map<const mef::BasicEvent*, std::pair<int, int>> shared;
+  for (const EventTreeAnalysis::Result& result : eta.sequences()) {
+    Pdag graph(*result.gate, settings.ccf_analysis(), model);
+    CustomPreprocessor<Bdd>{&graph, settings}();
+    // New variables are ordered after the known ones as in the PDAG.
+    std::vector<const Variable*> variables;
+    graph.Clear<Pdag::kGateMark>();
+    TraverseGates(graph.root(), [&variables](const GatePtr& gate) {
+      for (const auto& arg : gate->args<Variable>())
+        variables.push_back(arg.second.get());
+    });
+    boost::sort(variables, [](const Variable* lhs, const Variable* rhs) {
+      return lhs->order() < rhs->order();
+    });
+    Pdag::IndexMap<std::pair<int, int>> indices(graph.basic_events().size());
+    for (const Variable* variable : variables) {
+      const mef::BasicEvent* event = graph.basic_events()[variable->index()];
+      auto [it, inserted] = shared.try_emplace(
+          event, Pdag::kVariableStartIndex + variables_.size(),
+          shared.size() + 1);
+      if (inserted) {
+        auto it_proxy = eta.proxies().find(event);
+        variables_.emplace_back(event, it_proxy == eta.proxies().end()
+                                           ? nullptr
+                                           : it_proxy->second);
+      }
+      indices[variable->index()] = it->second;
+    }
+    functions_.emplace(&result.sequence, bdd_.AddFunction(&graph, indices));
+  }
+  LOG(DEBUG3) << "# of shared BDD variables: " << variables_.size();
+  LOG(DEBUG3) << "# of parameter house events: " << eta.proxies().size();
+}
+
+SequenceBdd::Signatures SequenceBdd::GetSignatures(
+    const EventTreeAnalysis& eta) noexcept {
+  Signatures signatures;
+  for (const EventTreeAnalysis::Result& result : eta.sequences()) {
+    std::unordered_map<const mef::Gate*, int> gates;
+    std::string& signature = signatures[&result.sequence];
+    Serialize(result.gate->formula(), eta.proxies(), &gates, &signature);
+  }
+  return signatures;
+}
+
+void SequenceBdd::Quantify(EventTreeAnalysis* eta) noexcept {
+  TIMER(DEBUG3, "Quantifying sequences in the shared BDD");
+  Pdag::IndexMap<double> p_vars;
+  p_vars.reserve(variables_.size());
+  for (const auto& [event, house_event] : variables_)
+    p_vars.push_back(house_event ? house_event->state() : event->p());
+
+  int mark = Ite::NewMark();
+  for (EventTreeAnalysis::Result& result : eta->sequences()) {
+    assert(functions_.count(&result.sequence) && "Unknown sequence.");
+    const Bdd::Function& function = functions_.find(&result.sequence)->second;
+    double p = CalculateProbability(function.vertex, mark, p_vars);
+    result.p_sequence = function.complement ? 1 - p : p;
+  }
+}
+
+void RiskAnalysis::QuantifySequences(EventTreeAnalysis* eta) noexcept {
+  if (!Analysis::settings().phase_cofactors())
+    return SequenceBdd(*eta, Analysis::settings(), model_).Quantify(eta);
+
+  std::unique_ptr<SequenceBdd>& sequence_bdd =
+      sequence_bdds_[&eta->initiating_event()];
+  if (!sequence_bdd || !sequence_bdd->Matches(*eta)) {
+    // The phase-dependent instructions may collect different formulas.
+    sequence_bdd =
+        std::make_unique<SequenceBdd>(*eta, Analysis::settings(), model_);
+  }
+  sequence_bdd->Quantify(eta);
+}
+
 template <class Algorithm>
 void RiskAnalysis::RunAnalysis(const mef::Gate& target,
                                Result* result) noexcept {
   auto fta = std::make_unique<FaultTreeAnalyzer<Algorithm>>(
       target, Analysis::settings(), model_);
   fta->Analyze();
-  if (Analysis::settings().probability_analysis()) {
-    switch (Analysis::settings().approximation()) {
-      case Approximation::kNone:
-        RunAnalysis<Algorithm, Bdd>(fta.get(), result);
-        break;
-      case Approximation::kRareEvent:
-        RunAnalysis<Algorithm, RareEventCalculator>(fta.get(), result);
-        break;
-      case Approximation::kMcub:
-        RunAnalysis<Algorithm, McubCalculator>(fta.get(), result);
-    }
-  }
+  if (Analysis::settings().probability_analysis())
+    RunAnalysis(fta.get(), result);
   result->fault_tree_analysis = std::move(fta);
 }
 
+template <class Algorithm>
+void RiskAnalysis::RunAnalysis(FaultTreeAnalyzer<Algorithm>* fta,
+                               Result* result) noexcept {
+  switch (Analysis::settings().approximation()) {
+    case Approximation::kNone:
+      RunAnalysis<Algorithm, Bdd>(fta, result);
+      break;
+    case Approximation::kRareEvent:
+      RunAnalysis<Algorithm, RareEventCalculator>(fta, result);
+      break;
+    case Approximation::kMcub:
+      RunAnalysis<Algorithm, McubCalculator>(fta, result);
+      break;
+    case Approximation::kBonferroni:
+      RunAnalysis<Algorithm, BonferroniCalculator>(fta, result);
+  }
+}
+
 template <class Algorithm, class Calculator>
 void RiskAnalysis::RunAnalysis(FaultTreeAnalyzer<Algorithm>* fta,
                                Result* result) noexcept {
@@ -169,6 +446,11 @@ void RiskAnalysis::RunAnalysis(FaultTreeAnalyzer<Algorithm>* fta,
     ua->Analyze();
     result->uncertainty_analysis = std::move(ua);
   }
+  if (Analysis::settings().sensitivity_analysis()) {
+    auto sa = std::make_unique<SensitivityAnalyzer<Calculator>>(pa.get());
+    sa->Analyze();
+    result->sensitivity_analysis = std::move(sa);
+  }
   result->probability_analysis = std::move(pa);
 }
 
@@ -22,6 +22,8 @@
 
 #include <memory>
 #include <optional>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -35,10 +37,13 @@
 #include "model.h"
 #include "probability_analysis.h"
 #include "settings.h"
+#include "sensitivity_analysis.h"
 #include "uncertainty_analysis.h"
 
 namespace scram::core {
 
+class SequenceBdd;  // Event-tree sequences in a shared BDD.
+
 /// Main system that performs analyses.
 class RiskAnalysis : public Analysis {
  public:
@@ -62,10 +67,11 @@ class RiskAnalysis : public Analysis {
 
     /// Optional analyses, i.e., may be nullptr.
     /// @{
-    std::unique_ptr<const FaultTreeAnalysis> fault_tree_analysis;
+    std::unique_ptr<FaultTreeAnalysis> fault_tree_analysis;
     std::unique_ptr<const ProbabilityAnalysis> probability_analysis;
     std::unique_ptr<const ImportanceAnalysis> importance_analysis;
     std::unique_ptr<const UncertaintyAnalysis> uncertainty_analysis;
+    std::unique_ptr<const SensitivityAnalysis> sensitivity_analysis;
     /// @}
   };
 
@@ -89,6 +95,9 @@ class RiskAnalysis : public Analysis {
   /// @todo Make the analysis work with a constant model.
   RiskAnalysis(mef::Model* model, const Settings& settings);
 
+  /// To handle incomplete shared BDD type with unique pointers.
+  ~RiskAnalysis() noexcept;
+
   /// @returns The model under analysis.
   const mef::Model& model() const { return *model_; }
 
@@ -102,6 +111,16 @@ class RiskAnalysis : public Analysis {
   /// @pre The analysis is performed only once.
   void Analyze() noexcept;
 
+  /// Recalculates the quantitative results
+  /// with the current probabilities of the basic events.
+  /// The qualitative results (graphs, products, BDDs) are reused as is,
+  /// so the products are not filtered again with the cut-off probability.
+  ///
+  /// @pre The analysis has been performed.
+  /// @pre The model has no event trees or alignments.
+  /// @pre The structure of the model has not changed since the analysis.
+  void Requantify() noexcept;
+
   /// @returns The results of the analysis.
   const std::vector<Result>& results() const { return results_; }
 
@@ -137,6 +156,15 @@ class RiskAnalysis : public Analysis {
   template <class Algorithm>
   void RunAnalysis(const mef::Gate& target, Result* result) noexcept;
 
+  /// Runs Quantitative analysis with the calculator from the settings.
+  ///
+  /// @tparam Algorithm  Qualitative analysis algorithm.
+  ///
+  /// @param[in] fta  The result of Qualitative analysis.
+  /// @param[in,out] result  The result container element.
+  template <class Algorithm>
+  void RunAnalysis(FaultTreeAnalyzer<Algorithm>* fta, Result* result) noexcept;
+
   /// Defines and runs Quantitative analysis on the target.
   ///
   /// @tparam Algorithm  Qualitative analysis algorithm.
@@ -150,9 +178,25 @@ class RiskAnalysis : public Analysis {
   template <class Algorithm, class Calculator>
   void RunAnalysis(FaultTreeAnalyzer<Algorithm>* fta, Result* result) noexcept;
 
+  /// Quantifies all sequences of an event tree in a shared BDD.
+  /// The sequence formulas are converted into one BDD manager
+  /// as separate root functions,
+  /// and the sequence probabilities are calculated in a single pass.
+  /// With the phase cofactors,
+  /// the BDD is converted once per event tree
+  /// and reused in the other alignment phases.
+  ///
+  /// @param[in,out] eta  The analysis with the sequence formulas.
+  void QuantifySequences(EventTreeAnalysis* eta) noexcept;
+
   mef::Model* model_;  ///< The model with constructs.
   std::vector<Result> results_;  ///< The analysis result storage.
   std::vector<EtaResult> event_tree_results_;  ///< Grouping of sequences.
+  /// The house events set by the alignment phases for the cofactors.
+  std::unordered_set<const mef::HouseEvent*> parameters_;
+  /// The shared BDDs of event trees for the phase cofactors.
+  std::unordered_map<const mef::InitiatingEvent*, std::unique_ptr<SequenceBdd>>
+      sequence_bdds_;
 };
 
 }  // namespace scram::core
@@ -22,21 +22,28 @@
 #include <cstdio>  // vsnprintf
 #include <cstring>  // strerror
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <optional>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/core/typeinfo.hpp>
 #include <boost/exception/all.hpp>
 #include <boost/program_options.hpp>
+#include <boost/range/algorithm/find.hpp>
 #include <boost/version.hpp>
 
 #include <libxml/parser.h>  // xmlInitParser, xmlCleanupParser
 #include <libxml/xmlerror.h>  // initGenericErrorDefaultFunc
 #include <libxml/xmlversion.h>  // LIBXML_TEST_VERSION, LIBXML_DOTTED_VERSION
 
+#include "batch.h"
 #include "error.h"
+#include "exporter.h"
 #include "ext/scope_guard.h"
 #include "initializer.h"
 #include "logger.h"
@@ -44,6 +51,7 @@
 #include "reporter.h"
 #include "risk_analysis.h"
 #include "serialization.h"
+#include "server.h"
 #include "settings.h"
 #include "version.h"
 
@@ -73,23 +81,54 @@ po::options_description ConstructOptions() {
       ("probability", "Perform probability analysis")
       ("importance", "Perform importance analysis")
       ("uncertainty", "Perform uncertainty analysis")
+      ("sensitivity", "Perform global sensitivity analysis")
       ("ccf", "Perform common-cause failure analysis")
+      ("shared-bdd", "Quantify event-tree sequences in a shared BDD")
+      ("phase-cofactors", "Quantify alignment phases as shared BDD cofactors")
       ("sil", "Compute the Safety Integrity Level metrics")
       ("rare-event", "Use the rare event approximation")
       ("mcub", "Use the MCUB approximation")
+      ("bonferroni", "Use the Bonferroni bounds approximation")
+      ("bound-tolerance", OPT_VALUE(double),
+       "Relative gap between the probability bounds to stop at")
       ("limit-order,l", OPT_VALUE(int), "Upper limit for the product order")
       ("cut-off", OPT_VALUE(double), "Cut-off probability for products")
+      ("top-products", OPT_VALUE(int),
+       "Number of the most probable products to report")
       ("mission-time", OPT_VALUE(double), "System mission time in hours")
       ("time-step", OPT_VALUE(double),
        "Time step in hours for probability analysis")
       ("num-trials", OPT_VALUE(int),
        "Number of trials for Monte Carlo simulations")
+      ("target-precision", OPT_VALUE(double),
+       "Target relative precision to stop Monte Carlo simulations early")
+      ("time-budget", OPT_VALUE(double),
+       "Wall-clock budget in seconds for Monte Carlo simulations")
+      ("sampling", OPT_VALUE(std::string),
+       "Sampling strategy for Monte Carlo simulations: mc, lhs, sobol")
+      ("raw-samples", "Keep the raw Monte Carlo samples for the export")
       ("num-quantiles", OPT_VALUE(int),
        "Number of quantiles for distributions")
       ("num-bins", OPT_VALUE(int), "Number of bins for histograms")
       ("seed", OPT_VALUE(int), "Seed for the pseudo-random number generator")
-      ("output,o", OPT_VALUE(path), "Output file for reports")
+      ("num-threads", OPT_VALUE(int),
+       "Number of threads for preprocessing of independent modules")
+      ("preprocessing", OPT_VALUE(std::string),
+       "Comma-separated graph optimization passes of preprocessing")
+      ("preprocessing-policy", OPT_VALUE(std::string),
+       "Policy to apply the preprocessing passes: all or auto")
+      ("output,o", OPT_VALUE(path),
+       "Output file for reports (directory for the batch)")
       ("no-indent", "Omit indentation whitespace in output XML")
+      ("compress", OPT_VALUE(std::string),
+       "Compression of the output report: none, gzip, zstd\n"
+       "(deduced from the output file extension by default)")
+      ("server", "Serve analysis requests on the standard input and output")
+      ("batch", "Run the input project files in parallel\n"
+       "(reports are written into the output directory)")
+      ("jobs,j", OPT_VALUE(int), "Number of parallel workers for the batch")
+      ("export", OPT_VALUE(path),
+       "Output file for results in the columnar binary format")
       ("verbosity", OPT_VALUE(int), "Set log verbosity");
 #ifndef NDEBUG
   po::options_description debug("Debug Options");
@@ -163,7 +202,8 @@ int ParseArguments(int argc, char* argv[], po::variables_map* vm) {
     }
   }
 
-  if (!vm->count("input-files") && !vm->count("project")) {
+  if (!vm->count("input-files") && !vm->count("project") &&
+      !vm->count("server")) {
     std::cerr << "No input or configuration file is given.\n\n";
     print_help(std::cerr);
     return 1;
@@ -174,9 +214,11 @@ int ParseArguments(int argc, char* argv[], po::variables_map* vm) {
     print_help(std::cerr);
     return 1;
   }
-  if (vm->count("rare-event") && vm->count("mcub")) {
-    std::cerr << "The rare event and MCUB approximations cannot be "
-              << "applied at the same time.\n\n";
+  if ((vm->count("rare-event") + vm->count("mcub") +
+       vm->count("bonferroni")) > 1) {
+    std::cerr << "Mutually exclusive probability approximations.\n"
+              << "(Rare-Event/MCUB/Bonferroni) cannot be applied "
+              << "at the same time.\n\n";
     print_help(std::cerr);
     return 1;
   }
@@ -214,22 +256,37 @@ void ConstructSettings(const po::variables_map& vm,
     assert(!vm.count("mcub"));
     settings->approximation(scram::core::Approximation::kRareEvent);
   } else if (vm.count("mcub")) {
+    assert(!vm.count("bonferroni"));
     settings->approximation(scram::core::Approximation::kMcub);
+  } else if (vm.count("bonferroni")) {
+    settings->approximation(scram::core::Approximation::kBonferroni);
   }
+  SET("bound-tolerance", double, bound_tolerance);
   SET("time-step", double, time_step);
   settings->safety_integrity_levels(vm.count("sil"));
 
   settings->probability_analysis(vm.count("probability"));
   settings->importance_analysis(vm.count("importance"));
   settings->uncertainty_analysis(vm.count("uncertainty"));
+  settings->sensitivity_analysis(vm.count("sensitivity"));
   settings->ccf_analysis(vm.count("ccf"));
+  settings->shared_bdd(vm.count("shared-bdd"));
+  settings->phase_cofactors(vm.count("phase-cofactors"));
+  settings->raw_samples(vm.count("raw-samples"));
   SET("seed", int, seed);
   SET("limit-order", int, limit_order);
   SET("cut-off", double, cut_off);
+  SET("top-products", int, top_products);
   SET("mission-time", double, mission_time);
   SET("num-trials", int, num_trials);
+  SET("target-precision", double, target_precision);
+  SET("time-budget", double, time_budget);
+  SET("sampling", std::string, sampling);
   SET("num-quantiles", int, num_quantiles);
   SET("num-bins", int, num_bins);
+  SET("num-threads", int, num_threads);
+  SET("preprocessing", std::string, preprocessing_passes);
+  SET("preprocessing-policy", std::string, preprocessing_policy);
 #ifndef NDEBUG
   settings->preprocessor = vm.count("preprocessor");
   settings->print = vm.count("print");
@@ -237,6 +294,32 @@ void ConstructSettings(const po::variables_map& vm,
 }
 #undef SET
 
+/// Interprets the compression format of the output report.
+///
+/// @param[in] value  The name of the compression format.
+///
+/// @returns The compression format.
+///
+/// @throws SettingsError  The format is not recognized or supported.
+scram::xml::Compression GetCompression(const std::string& value) {
+  auto it = boost::find(scram::xml::kCompressionToString, value);
+  if (it == std::end(scram::xml::kCompressionToString)) {
+    SCRAM_THROW(
+        scram::SettingsError("The compression format is not recognized."))
+        << scram::errinfo_value(value);
+  }
+  auto compression = static_cast<scram::xml::Compression>(
+      std::distance(scram::xml::kCompressionToString, it));
+#ifndef SCRAM_WITH_ZSTD
+  if (compression == scram::xml::Compression::kZstd) {
+    SCRAM_THROW(scram::SettingsError(
+        "The zstd compression is not supported in this build."))
+        << scram::errinfo_value(value);
+  }
+#endif
+  return compression;
+}
+
 /// Main body of command-line entrance to run the program.
 ///
 /// @param[in] vm  Variables map of program options.
@@ -257,10 +340,39 @@ void RunScram(const po::variables_map& vm) {
   // Command-line settings overwrite
   // the settings from the configurations.
   ConstructSettings(vm, &settings);
+  std::optional<scram::xml::Compression> compression;
+  if (vm.count("compress"))
+    compression = GetCompression(vm["compress"].as<std::string>());
   if (vm.count("input-files")) {
     auto cmd_input = vm["input-files"].as<std::vector<std::string>>();
     input_files.insert(input_files.end(), cmd_input.begin(), cmd_input.end());
   }
+  if (vm.count("batch")) {
+    int num_workers = vm.count("jobs")
+                          ? vm["jobs"].as<int>()
+                          : std::max(1u, std::thread::hardware_concurrency());
+    int num_failures =
+        scram::Batch(num_workers, vm.count("allow-extern"))
+            .Run(input_files,
+                 vm.count("output") ? vm["output"].as<std::string>() : ".",
+                 !vm.count("no-indent"),
+                 compression.value_or(scram::xml::Compression::kNone));
+    if (num_failures) {
+      SCRAM_THROW(scram::Error("Projects in the batch have failed."))
+          << scram::errinfo_value(std::to_string(num_failures));
+    }
+    return;
+  }
+  if (vm.count("server")) {
+    scram::Server server(settings, vm.count("allow-extern"));
+    if (!input_files.empty()) {  // Preload the model.
+      std::string request = "load";
+      for (const std::string& input_file : input_files)
+        request += " " + input_file;
+      std::cout << server.Process(request) << std::flush;
+    }
+    return server.Serve(std::cin, std::cout);
+  }
   // Process input files
   // into valid analysis containers and constructs.
   // Throws if anything is invalid.
@@ -284,10 +396,14 @@ void RunScram(const po::variables_map& vm) {
   scram::Reporter reporter;
   bool indent = vm.count("no-indent") ? false : true;
   if (vm.count("output")) {
-    reporter.Report(analysis, vm["output"].as<std::string>(), indent);
+    reporter.Report(analysis, vm["output"].as<std::string>(), indent,
+                    compression);
   } else {
-    reporter.Report(analysis, stdout, indent);
+    reporter.Report(analysis, stdout, indent,
+                    compression.value_or(scram::xml::Compression::kNone));
   }
+  if (vm.count("export"))
+    scram::Exporter().Export(analysis, vm["export"].as<std::string>());
 }
 
 /// Callback function to redirect XML library error/warning messages to logging.
@@ -364,6 +480,7 @@ int main(int argc, char* argv[]) {
     return 1;
   } catch (const scram::IOError& err) {
     LOG(scram::DEBUG1) << boost::diagnostic_information(err);
+    scram::Logger::Flush();  // Keep the order with the error output.
     std::cerr << boost::core::demangled_name(typeid(err)) << "\n\n";
     PrintErrorInfo<boost::errinfo_file_name>("File", err);
     PrintErrorInfo<boost::errinfo_file_open_mode>("Open mode", err);
@@ -376,6 +493,7 @@ int main(int argc, char* argv[]) {
   } catch (const scram::Error& err) {
     using namespace scram;  // NOLINT
     LOG(DEBUG1) << boost::diagnostic_information(err);
+    Logger::Flush();  // Keep the order with the error output.
     std::cerr << boost::core::demangled_name(typeid(err)) << "\n\n";
     PrintErrorInfo<errinfo_value>("Value", err);
     PrintErrorInfo<boost::errinfo_file_name>("File", err);
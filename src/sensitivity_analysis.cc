@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the Saltelli scheme for Sobol sensitivity indices.
+
+#include "sensitivity_analysis.h"
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "event.h"
+#include "expression.h"
+#include "expression/random_deviate.h"
+#include "logger.h"
+#include "statistics.h"
+#include "uncertainty_analysis.h"
+
+namespace scram::core {
+
+namespace {
+
+/// Groups the basic events sharing random deviates into single factors,
+/// for the Sobol indices are defined for independent inputs only.
+///
+/// @param[in] deviate_expressions  The deviate expressions of basic events.
+///
+/// @returns The variable indices of the basic events per factor.
+std::vector<std::vector<int>> GroupFactors(
+    const std::vector<std::pair<int, mef::Expression&>>&
+        deviate_expressions) noexcept {
+  std::vector<int> parents(deviate_expressions.size());
+  std::iota(parents.begin(), parents.end(), 0);
+  auto find_root = [&parents](int i) {
+    while (parents[i] != i)
+      i = parents[i] = parents[parents[i]];
+    return i;
+  };
+  std::unordered_map<mef::Expression*, int> owners;  // Deviate to event.
+  for (int i = 0; i < deviate_expressions.size(); ++i) {
+    std::vector<mef::RandomDeviate*> deviates;
+    std::unordered_set<mef::Expression*> visited;
+    mef::GatherDeviates(&deviate_expressions[i].second, &deviates, &visited);
+    for (mef::Expression* deviate : deviates) {
+      auto [it, inserted] = owners.emplace(deviate, i);
+      if (!inserted)
+        parents[find_root(i)] = find_root(it->second);
+    }
+  }
+  std::vector<std::vector<int>> factors;
+  std::unordered_map<int, int> factor_of_root;
+  for (int i = 0; i < deviate_expressions.size(); ++i) {
+    auto [it, inserted] = factor_of_root.emplace(find_root(i), factors.size());
+    if (inserted)
+      factors.emplace_back();
+    factors[it->second].push_back(deviate_expressions[i].first);
+  }
+  return factors;
+}
+
+}  // namespace
+
+SensitivityAnalysis::SensitivityAnalysis(
+    const ProbabilityAnalysis* prob_analysis)
+    : Analysis(prob_analysis->settings()), variance_(0) {}
+
+void SensitivityAnalysis::Analyze() noexcept {
+  CLOCK(analysis_time);
+  TIMER(DEBUG3, "Estimating Sobol sensitivity indices");
+  std::vector<std::pair<int, mef::Expression&>> deviate_expressions =
+      UncertaintyAnalysis::GatherDeviateExpressions(this->graph());
+  std::vector<std::vector<int>> factors = GroupFactors(deviate_expressions);
+  int num_factors = factors.size();
+  LOG(DEBUG4) << "Uncertain basic events: " << deviate_expressions.size();
+  LOG(DEBUG4) << "Independent factors: " << num_factors;
+
+  // Samples a row of the A or B matrix into the variable probabilities.
+  auto sample_row = [&deviate_expressions](Pdag::IndexMap<double>* p_vars) {
+    for (const auto& expression : deviate_expressions)
+      expression.second.Reset();
+    for (const auto& expression : deviate_expressions) {
+      (*p_vars)[expression.first] =
+          std::clamp(expression.second.Sample(), 0.0, 1.0);
+    }
+  };
+
+  // The rows are evaluated in place, one A row and one B row at a time,
+  // so the AB matrices are never stored.
+  Pdag::IndexMap<double> p_a = this->p_vars();
+  Pdag::IndexMap<double> p_b = this->p_vars();
+  std::vector<double> p_store;
+  std::vector<double> first_order_sums(num_factors);
+  std::vector<double> total_sums(num_factors);
+  SampleSummary outputs;
+  int num_trials = Analysis::settings().num_trials();
+  for (int trial = 0; trial < num_trials; ++trial) {
+    sample_row(&p_a);
+    sample_row(&p_b);
+    double f_a = this->Evaluate(p_a);
+    double f_b = this->Evaluate(p_b);
+    outputs.Add(f_a);
+    outputs.Add(f_b);
+    for (int i = 0; i < num_factors; ++i) {
+      p_store.clear();
+      for (int index : factors[i]) {  // The i-th columns from B.
+        p_store.push_back(p_a[index]);
+        p_a[index] = p_b[index];
+      }
+      double f_ab = this->Evaluate(p_a);
+      for (int j = 0; j < factors[i].size(); ++j)
+        p_a[factors[i][j]] = p_store[j];
+      first_order_sums[i] += f_b * (f_ab - f_a);
+      total_sums[i] += (f_a - f_ab) * (f_a - f_ab);
+    }
+  }
+
+  variance_ = outputs.variance();
+  for (int i = 0; i < num_factors; ++i) {
+    double first_order = 0;
+    double total = 0;
+    if (variance_) {
+      first_order = first_order_sums[i] / num_trials / variance_;
+      total = total_sums[i] / (2 * num_trials) / variance_;
+    }
+    for (int index : factors[i]) {
+      indices_.push_back(
+          {*this->graph()->basic_events()[index], first_order, total});
+    }
+  }
+  Analysis::AddAnalysisTime(DUR(analysis_time));
+}
+
+}  // namespace scram::core
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Global sensitivity analysis with variance-based Sobol indices.
+
+#pragma once
+
+#include <vector>
+
+#include "analysis.h"
+#include "probability_analysis.h"
+
+namespace scram::mef {  // Decouple from the analysis code header.
+class BasicEvent;
+}  // namespace scram::mef
+
+namespace scram::core {
+
+/// Sobol sensitivity indices of an uncertain basic event.
+struct SensitivityRecord {
+  const mef::BasicEvent& event;  ///< The event with a deviate probability.
+  double first_order;  ///< The share of the variance due to the event alone.
+  double total;  ///< The share of the variance including all interactions.
+};
+
+/// Variance-based global sensitivity analysis
+/// of the total probability
+/// to the uncertain probabilities of basic events.
+///
+/// The first-order and total Sobol indices are estimated
+/// with the Saltelli sampling scheme
+/// and the Saltelli (2010) and Jansen estimators.
+/// The scheme takes N(d + 2) evaluations of the total probability
+/// for N trials and d independent factors.
+/// Basic events sharing random deviates (e.g., a common parameter)
+/// are a single factor and share the indices.
+///
+/// The A and B rows of the scheme are independent pseudo-random draws
+/// for the fixed number of trials.
+/// The sampling design (e.g., Latin hypercube)
+/// and the sequential stopping settings
+/// (the target precision and time budget)
+/// of the uncertainty analysis do not apply.
+class SensitivityAnalysis : public Analysis {
+ public:
+  /// @param[in] prob_analysis  Completed probability analysis.
+  explicit SensitivityAnalysis(const ProbabilityAnalysis* prob_analysis);
+
+  virtual ~SensitivityAnalysis() = default;
+
+  /// Estimates the sensitivity indices of the uncertain basic events.
+  ///
+  /// @pre Analysis is called only once.
+  void Analyze() noexcept;
+
+  /// @returns The sensitivity indices of the uncertain basic events.
+  const std::vector<SensitivityRecord>& indices() const { return indices_; }
+
+  /// @returns The estimated variance of the total probability.
+  double variance() const { return variance_; }
+
+ private:
+  /// @returns The PDAG with the variables of the probability analysis.
+  virtual const Pdag* graph() noexcept = 0;
+
+  /// @returns The variable probabilities of the probability analysis.
+  virtual const Pdag::IndexMap<double>& p_vars() noexcept = 0;
+
+  /// Evaluates the total probability with the calculator.
+  ///
+  /// @param[in] p_vars  A map of probabilities of the graph variables.
+  ///
+  /// @returns The total probability with the given values.
+  virtual double Evaluate(const Pdag::IndexMap<double>& p_vars) noexcept = 0;
+
+  std::vector<SensitivityRecord> indices_;  ///< The indices per event.
+  double variance_;  ///< The variance of the total probability.
+};
+
+/// Sensitivity analysis facility.
+///
+/// @tparam Calculator  Quantitative analysis calculator.
+template <class Calculator>
+class SensitivityAnalyzer : public SensitivityAnalysis {
+ public:
+  /// Constructs sensitivity analyzer from probability analyzer.
+  /// Probability analyzer facilities are used
+  /// to calculate the total probability for the sampled values.
+  ///
+  /// @param[in] prob_analyzer  Instantiated probability analyzer.
+  explicit SensitivityAnalyzer(ProbabilityAnalyzer<Calculator>* prob_analyzer)
+      : SensitivityAnalysis(prob_analyzer), prob_analyzer_(prob_analyzer) {}
+
+ private:
+  const Pdag* graph() noexcept override { return prob_analyzer_->graph(); }
+  const Pdag::IndexMap<double>& p_vars() noexcept override {
+    return prob_analyzer_->p_vars();
+  }
+  double Evaluate(const Pdag::IndexMap<double>& p_vars) noexcept override {
+    return prob_analyzer_->CalculateTotalProbability(p_vars);
+  }
+
+  /// Calculator of the total probability.
+  ProbabilityAnalyzer<Calculator>* prob_analyzer_;
+};
+
+}  // namespace scram::core
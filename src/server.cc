@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the analysis server.
+
+#include "server.h"
+
+#include <cstdio>
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/exception/get_error_info.hpp>
+
+#include "error.h"
+#include "initializer.h"
+#include "logger.h"
+#include "reporter.h"
+#include "xml.h"
+
+namespace scram {
+
+namespace {
+
+/// @returns The one-line description of the error for the status line.
+std::string Describe(const Error& err) {
+  std::string message = err.what();
+  if (const auto* value = boost::get_error_info<errinfo_value>(err))
+    message += ": " + *value;
+  if (const auto* ref = boost::get_error_info<mef::errinfo_reference>(err))
+    message += ": " + *ref;
+  if (const auto* file = boost::get_error_info<boost::errinfo_file_name>(err))
+    message += " (" + *file + ")";
+  boost::replace_all(message, "\n", " ");
+  return message;
+}
+
+/// Checks the number of request arguments.
+///
+/// @param[in] args  The request words with the command.
+/// @param[in] min_size  The minimum number of words.
+/// @param[in] max_size  The maximum number of words.
+///
+/// @throws IllegalOperation  The number of words is out of the range.
+void RequireArgs(const std::vector<std::string>& args, int min_size,
+                 int max_size = std::numeric_limits<int>::max()) {
+  if (args.size() < min_size || args.size() > max_size) {
+    SCRAM_THROW(IllegalOperation("Wrong number of request arguments."))
+        << errinfo_value(args.front());
+  }
+}
+
+/// @returns A stream to format floating-point numbers losslessly.
+std::ostringstream MakeStream() {
+  std::ostringstream out;
+  out.precision(std::numeric_limits<double>::max_digits10);
+  return out;
+}
+
+}  // namespace
+
+void Server::Serve(std::istream& in, std::ostream& out) {
+  std::string request;
+  while (std::getline(in, request)) {
+    std::string command;
+    std::istringstream(request) >> command;
+    if (command.empty())
+      continue;
+    out << Process(request) << std::flush;
+    if (command == "quit")
+      break;
+  }
+}
+
+std::string Server::Process(const std::string& request) {
+  std::vector<std::string> args;
+  std::istringstream words(request);
+  std::copy(std::istream_iterator<std::string>(words),
+            std::istream_iterator<std::string>(), std::back_inserter(args));
+  try {
+    if (args.empty())
+      SCRAM_THROW(IllegalOperation("Empty request."));
+    const std::string& command = args.front();
+    TIMER(DEBUG1, "Serving a request");
+    LOG(DEBUG2) << "Request: " << request;
+    std::string payload;
+    if (command == "load") {
+      payload = Load(args);
+    } else if (command == "set-probability") {
+      payload = SetProbability(args);
+    } else if (command == "set-house") {
+      payload = SetHouse(args);
+    } else if (command == "analyze") {
+      payload = Analyze(args);
+    } else if (command == "probability") {
+      payload = Probability(args);
+    } else if (command == "importance") {
+      payload = Importance(args);
+    } else if (command != "quit") {
+      SCRAM_THROW(IllegalOperation("Unknown request."))
+          << errinfo_value(command);
+    }
+    return "ok " + std::to_string(payload.size()) + "\n" + payload;
+  } catch (const Error& err) {
+    return "error " + Describe(err) + "\n";
+  }
+}
+
+std::string Server::Load(const std::vector<std::string>& args) {
+  RequireArgs(args, 2);
+  std::vector<std::string> input_files(std::next(args.begin()), args.end());
+  std::vector<std::optional<std::size_t>> hashes;
+  for (const std::string& input_file : input_files)
+    hashes.push_back(xml::HashDocument(input_file));
+  auto it = sessions_.find(input_files);
+  if (it != sessions_.end() &&
+      (it->second.hashes != hashes ||
+       std::find(hashes.begin(), hashes.end(), std::nullopt) != hashes.end())) {
+    LOG(DEBUG2) << "The input files have changed.";
+    if (session_ == &it->second)
+      session_ = nullptr;
+    sessions_.erase(it);
+    it = sessions_.end();
+  }
+  if (it == sessions_.end()) {
+    Session session;
+    session.model =
+        mef::Initializer(input_files, settings_, allow_extern_).model();
+    session.hashes = std::move(hashes);
+    it = sessions_.emplace(input_files, std::move(session)).first;
+  } else {
+    LOG(DEBUG2) << "Using the cached model.";
+  }
+  session_ = &it->second;
+  return "";
+}
+
+std::string Server::SetProbability(const std::vector<std::string>& args) {
+  RequireArgs(args, 3, 3);
+  Session& session = GetSession();
+  auto it = session.model->table<mef::BasicEvent>().find(args[1]);
+  if (it == session.model->table<mef::BasicEvent>().end()) {
+    SCRAM_THROW(mef::UndefinedElement())
+        << mef::errinfo_reference(args[1]);
+  }
+  mef::BasicEvent& basic_event = *it;
+  double value = 0;
+  std::istringstream value_stream(args[2]);
+  if (!(value_stream >> value) || !value_stream.eof()) {
+    SCRAM_THROW(IllegalOperation("The probability is not a number."))
+        << errinfo_value(args[2]);
+  }
+  auto expression = std::make_unique<mef::ConstantExpression>(value);
+  mef::Expression* prev_expression = &basic_event.expression();
+  basic_event.expression(expression.get());
+  try {
+    basic_event.Validate();
+  } catch (Error&) {
+    basic_event.expression(prev_expression);
+    throw;
+  }
+  session.probabilities[&basic_event] = std::move(expression);
+  session.stale = true;
+  return "";
+}
+
+std::string Server::SetHouse(const std::vector<std::string>& args) {
+  RequireArgs(args, 3, 3);
+  Session& session = GetSession();
+  auto it = session.model->table<mef::HouseEvent>().find(args[1]);
+  if (it == session.model->table<mef::HouseEvent>().end()) {
+    SCRAM_THROW(mef::UndefinedElement())
+        << mef::errinfo_reference(args[1]);
+  }
+  if (args[2] != "true" && args[2] != "false") {
+    SCRAM_THROW(IllegalOperation("The house event state is not Boolean."))
+        << errinfo_value(args[2]);
+  }
+  mef::HouseEvent& house_event = *it;
+  bool state = args[2] == "true";
+  if (house_event.state() != state) {
+    house_event.state(state);
+    session.analysis.reset();  // The graphs depend on the house events.
+  }
+  return "";
+}
+
+std::string Server::Analyze(const std::vector<std::string>& args) {
+  RequireArgs(args, 1, 1);
+  const core::RiskAnalysis& analysis = GetAnalysis();
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> fp(std::tmpfile(),
+                                                        &std::fclose);
+  if (!fp)
+    SCRAM_THROW(IOError("Cannot create a temporary file for the report."));
+  Reporter().Report(analysis, fp.get(), /*indent=*/false);
+  std::string payload(std::ftell(fp.get()), '\0');
+  std::rewind(fp.get());
+  if (std::fread(payload.data(), 1, payload.size(), fp.get()) !=
+      payload.size()) {
+    SCRAM_THROW(IOError("Cannot read the temporary report file."));
+  }
+  return payload;
+}
+
+std::string Server::Probability(const std::vector<std::string>& args) {
+  RequireArgs(args, 1, 1);
+  if (!settings_.probability_analysis())
+    SCRAM_THROW(IllegalOperation("Probability analysis is not requested."));
+  const core::RiskAnalysis& analysis = GetAnalysis();
+  std::ostringstream out = MakeStream();
+  for (const core::RiskAnalysis::Result& result : analysis.results()) {
+    if (!result.probability_analysis)
+      continue;
+    struct {
+      std::string operator()(const mef::Gate* gate) { return gate->id(); }
+      std::string operator()(const std::pair<const mef::InitiatingEvent&,
+                                             const mef::Sequence&>& sequence) {
+        return sequence.second.name();
+      }
+    } extractor;
+    out << std::visit(extractor, result.id.target) << " "
+        << result.probability_analysis->p_total() << "\n";
+  }
+  return out.str();
+}
+
+std::string Server::Importance(const std::vector<std::string>& args) {
+  RequireArgs(args, 2, 2);
+  if (!settings_.importance_analysis())
+    SCRAM_THROW(IllegalOperation("Importance analysis is not requested."));
+  const core::RiskAnalysis& analysis = GetAnalysis();
+  for (const core::RiskAnalysis::Result& result : analysis.results()) {
+    const auto* gate = std::get_if<const mef::Gate*>(&result.id.target);
+    if (!gate || (*gate)->id() != args[1] || !result.importance_analysis)
+      continue;
+    std::ostringstream out = MakeStream();
+    for (const core::ImportanceRecord& record :
+         result.importance_analysis->importance()) {
+      out << record.event.id() << " " << record.factors.occurrence << " "
+          << record.factors.mif << " " << record.factors.cif << " "
+          << record.factors.dif << " " << record.factors.raw << " "
+          << record.factors.rrw << "\n";
+    }
+    return out.str();
+  }
+  SCRAM_THROW(mef::UndefinedElement()) << mef::errinfo_reference(args[1]);
+}
+
+Server::Session& Server::GetSession() {
+  if (!session_)
+    SCRAM_THROW(IllegalOperation("No model is loaded."));
+  return *session_;
+}
+
+const core::RiskAnalysis& Server::GetAnalysis() {
+  Session& session = GetSession();
+  if (session.analysis && session.stale) {
+    bool qualitative_reusable =
+        settings_.probability_analysis() &&
+        (settings_.approximation() == core::Approximation::kNone ||
+         settings_.cut_off() == 0) &&
+        session.analysis->event_tree_results().empty() &&
+        session.model->alignments().empty();
+    if (qualitative_reusable) {
+      session.analysis->Requantify();
+    } else {
+      session.analysis.reset();
+    }
+  }
+  if (!session.analysis) {
+    session.analysis =
+        std::make_unique<core::RiskAnalysis>(session.model.get(), settings_);
+    session.analysis->Analyze();
+  }
+  session.stale = false;
+  return *session.analysis;
+}
+
+}  // namespace scram
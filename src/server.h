@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Long-running analysis server with a cache of initialized models.
+
+#pragma once
+
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "expression/constant.h"
+#include "model.h"
+#include "risk_analysis.h"
+#include "settings.h"
+
+namespace scram {
+
+/// Server of analysis requests against cached models.
+///
+/// The models are initialized once per set of input files,
+/// and the analysis results are kept
+/// until the model changes.
+/// The models are initialized anew if the contents of the files change.
+/// Changes in basic-event probabilities only requantify the cached results
+/// without rebuilding the graphs and BDDs
+/// if the qualitative results do not depend on the probabilities,
+/// i.e., the exact probability calculation or no cut-off.
+///
+/// The requests are lines of whitespace-separated words:
+///
+///   - load FILE...  (Initializes or selects the cached model;
+///     the model is reloaded, dropping the changes by the requests,
+///     if the files have changed or include other files)
+///   - set-probability EVENT VALUE  (Sets a basic-event probability)
+///   - set-house EVENT true|false  (Sets a house-event state)
+///   - analyze  (Reports the results in the XML report format)
+///   - probability  (Lists the total probabilities as "NAME VALUE" lines)
+///   - importance GATE  (Lists the importance factors
+///     as "EVENT OCCURRENCE MIF CIF DIF RAW RRW" lines)
+///   - quit
+///
+/// The response starts with a status line,
+/// either "ok SIZE" followed by SIZE bytes of the payload,
+/// or "error MESSAGE".
+class Server {
+ public:
+  /// @param[in] settings  The analysis settings for all requests.
+  /// @param[in] allow_extern  Allow external libraries in the models.
+  explicit Server(const core::Settings& settings, bool allow_extern = false)
+      : settings_(settings), allow_extern_(allow_extern), session_(nullptr) {}
+
+  /// Serves the requests until the end of the input or the quit request.
+  ///
+  /// @param[in] in  The stream of request lines.
+  /// @param[out] out  The stream of responses flushed after each request.
+  void Serve(std::istream& in, std::ostream& out);
+
+  /// Processes a single request.
+  ///
+  /// @param[in] request  The request line.
+  ///
+  /// @returns The response with the status line.
+  std::string Process(const std::string& request);
+
+ private:
+  /// The cached model with its analysis state.
+  struct Session {
+    std::unique_ptr<mef::Model> model;  ///< The initialized model.
+    /// The content hashes of the input files
+    /// with nullopt for the files with XInclude directives.
+    std::vector<std::optional<std::size_t>> hashes;
+    /// The analysis of the model or nullptr if the model structure changed.
+    std::unique_ptr<core::RiskAnalysis> analysis;
+    bool stale = false;  ///< The probabilities changed since the analysis.
+    /// The constant probabilities set by the requests.
+    std::unordered_map<const mef::BasicEvent*,
+                       std::unique_ptr<mef::ConstantExpression>>
+        probabilities;
+  };
+
+  /// Request handlers.
+  ///
+  /// @param[in] args  The request words with the command as the first.
+  ///
+  /// @returns The response payload.
+  ///
+  /// @throws Error  The request is invalid.
+  /// @{
+  std::string Load(const std::vector<std::string>& args);
+  std::string SetProbability(const std::vector<std::string>& args);
+  std::string SetHouse(const std::vector<std::string>& args);
+  std::string Analyze(const std::vector<std::string>& args);
+  std::string Probability(const std::vector<std::string>& args);
+  std::string Importance(const std::vector<std::string>& args);
+  /// @}
+
+  /// @returns The current session.
+  ///
+  /// @throws IllegalOperation  No model is loaded.
+  Session& GetSession();
+
+  /// @returns The up-to-date analysis of the current session.
+  ///
+  /// @throws IllegalOperation  No model is loaded.
+  const core::RiskAnalysis& GetAnalysis();
+
+  const core::Settings settings_;  ///< The settings for all analyses.
+  const bool allow_extern_;  ///< Permission for external libraries.
+  /// The cached models by the input files.
+  std::map<std::vector<std::string>, Session> sessions_;
+  Session* session_;  ///< The current session.
+};
+
+}  // namespace scram
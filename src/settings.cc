@@ -20,6 +20,7 @@
 
 #include "settings.h"
 
+#include <algorithm>
 #include <string>
 
 #include <boost/range/algorithm.hpp>
@@ -104,6 +105,73 @@ Settings& Settings::cut_off(double prob) {
   return *this;
 }
 
+Settings& Settings::bound_tolerance(double tolerance) {
+  if (tolerance < 0 || tolerance > 1)
+    SCRAM_THROW(SettingsError(
+        "The tolerance for probability bounds should be in [0, 1] range."))
+        << errinfo_value(std::to_string(tolerance));
+
+  bound_tolerance_ = tolerance;
+  return *this;
+}
+
+Settings& Settings::top_products(int k) {
+  if (k < 0)
+    SCRAM_THROW(
+        SettingsError("The number of top products cannot be less than 0."))
+        << errinfo_value(std::to_string(k));
+
+  top_products_ = k;
+  if (top_products_)
+    probability_analysis_ = true;
+  return *this;
+}
+
+Settings& Settings::num_threads(int n) {
+  if (n < 1)
+    SCRAM_THROW(SettingsError("The number of threads cannot be less than 1."))
+        << errinfo_value(std::to_string(n));
+
+  num_threads_ = n;
+  return *this;
+}
+
+Settings& Settings::preprocessing_passes(std::string_view passes) {
+  std::vector<PreprocessingPass> result;
+  while (!passes.empty()) {
+    std::string_view name = passes.substr(0, passes.find(','));
+    passes.remove_prefix(std::min(name.size() + 1, passes.size()));
+    auto it = boost::find(kPreprocessingPassToString, name);
+    if (it == std::end(kPreprocessingPassToString))
+      SCRAM_THROW(SettingsError("The preprocessing pass is not recognized."))
+          << errinfo_value(std::string(name));
+
+    result.push_back(static_cast<PreprocessingPass>(
+        std::distance(kPreprocessingPassToString, it)));
+  }
+  return preprocessing_passes(std::move(result));
+}
+
+Settings& Settings::preprocessing_policy(std::string_view value) {
+  auto it = boost::find(kPreprocessingPolicyToString, value);
+  if (it == std::end(kPreprocessingPolicyToString))
+    SCRAM_THROW(SettingsError("The preprocessing policy is not recognized."))
+        << errinfo_value(std::string(value));
+
+  return preprocessing_policy(static_cast<PreprocessingPolicy>(
+      std::distance(kPreprocessingPolicyToString, it)));
+}
+
+Settings& Settings::sampling(std::string_view value) {
+  auto it = boost::find(kSamplingToString, value);
+  if (it == std::end(kSamplingToString))
+    SCRAM_THROW(SettingsError("The sampling strategy is not recognized."))
+        << errinfo_value(std::string(value));
+
+  return sampling(
+      static_cast<Sampling>(std::distance(kSamplingToString, it)));
+}
+
 Settings& Settings::num_trials(int n) {
   if (n < 1)
     SCRAM_THROW(SettingsError("The number of trials cannot be less than 1."))
@@ -113,6 +181,25 @@ Settings& Settings::num_trials(int n) {
   return *this;
 }
 
+Settings& Settings::target_precision(double precision) {
+  if (precision < 0 || precision >= 1)
+    SCRAM_THROW(
+        SettingsError("The target precision should be in [0, 1) range."))
+        << errinfo_value(std::to_string(precision));
+
+  target_precision_ = precision;
+  return *this;
+}
+
+Settings& Settings::time_budget(double seconds) {
+  if (seconds < 0)
+    SCRAM_THROW(SettingsError("The time budget cannot be negative."))
+        << errinfo_value(std::to_string(seconds));
+
+  time_budget_ = seconds;
+  return *this;
+}
+
 Settings& Settings::num_quantiles(int n) {
   if (n < 1)
     SCRAM_THROW(SettingsError("The number of quantiles cannot be less than 1."))
@@ -23,6 +23,8 @@
 #include <cstdint>
 
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace scram::core {
 
@@ -33,10 +35,49 @@ enum class Algorithm : std::uint8_t { kBdd = 0, kZbdd, kMocus };
 const char* const kAlgorithmToString[] = {"bdd", "zbdd", "mocus"};
 
 /// Quantitative analysis approximations.
-enum class Approximation : std::uint8_t { kNone = 0, kRareEvent, kMcub };
+enum class Approximation : std::uint8_t {
+  kNone = 0,
+  kRareEvent,
+  kMcub,
+  kBonferroni
+};
 
 /// String representations for approximations.
-const char* const kApproximationToString[] = {"none", "rare-event", "mcub"};
+const char* const kApproximationToString[] = {"none", "rare-event", "mcub",
+                                              "bonferroni"};
+
+/// Optional graph optimization passes of preprocessing.
+enum class PreprocessingPass : std::uint8_t {
+  kCoalescence = 0,
+  kMergeCommonArgs,
+  kDistributivity,
+  kBooleanOptimization,
+  kDecomposition
+};
+
+/// String representations for preprocessing passes.
+const char* const kPreprocessingPassToString[] = {
+    "coalescence", "merge-common-args", "distributivity",
+    "boolean-optimization", "decomposition"};
+
+/// Policies to apply the preprocessing passes.
+enum class PreprocessingPolicy : std::uint8_t {
+  kAll = 0,  ///< Every pass is applied as listed.
+  kAuto  ///< Passes that stop reducing the graph are skipped.
+};
+
+/// String representations for preprocessing policies.
+const char* const kPreprocessingPolicyToString[] = {"all", "auto"};
+
+/// Sampling strategies for Monte Carlo simulations.
+enum class Sampling : std::uint8_t {
+  kMonteCarlo = 0,  ///< Independent pseudo-random draws.
+  kLatinHypercube,  ///< Stratified draws with random pairing of strata.
+  kSobol  ///< Randomly shifted low-discrepancy Sobol sequence.
+};
+
+/// String representations for sampling strategies.
+const char* const kSamplingToString[] = {"mc", "lhs", "sobol"};
 
 /// Builder for analysis settings.
 /// Analysis facilities are guaranteed not to throw or fail
@@ -131,6 +172,115 @@ class Settings {
   /// @throws SettingsError  The probability is not in the [0, 1] range.
   Settings& cut_off(double prob);
 
+  /// @returns The relative gap between the probability bounds
+  ///          sufficient to stop the Bonferroni approximation.
+  double bound_tolerance() const { return bound_tolerance_; }
+
+  /// Sets the tolerance for the gap between
+  /// the lower and upper bounds of the total probability
+  /// relative to the upper bound.
+  ///
+  /// @param[in] tolerance  The relative gap in the [0, 1] range.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The tolerance is not in the [0, 1] range.
+  Settings& bound_tolerance(double tolerance);
+
+  /// @returns The number of the most probable products to report.
+  ///          0 if all products are requested.
+  int top_products() const { return top_products_; }
+
+  /// Sets the number of the most probable products to report.
+  /// The most probable products are found without full enumeration;
+  /// therefore, the request implies probability analysis.
+  ///
+  /// @param[in] k  A non-negative number; 0 for all products.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is less than 0.
+  Settings& top_products(int k);
+
+  /// @returns The number of threads for parallel analysis steps.
+  int num_threads() const { return num_threads_; }
+
+  /// Sets the number of threads
+  /// for the parallel preprocessing of independent modules.
+  ///
+  /// @param[in] n  A natural number; 1 for the sequential analysis.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is less than 1.
+  Settings& num_threads(int n);
+
+  /// @returns The ordered graph optimization passes of preprocessing.
+  const std::vector<PreprocessingPass>& preprocessing_passes() const {
+    return preprocessing_passes_;
+  }
+
+  /// Sets the graph optimization passes of preprocessing.
+  /// The passes are applied in the given order
+  /// every time the preprocessor optimizes the graph structure.
+  /// The same pass may appear more than once.
+  ///
+  /// @param[in] passes  The ordered passes; empty for no optimization.
+  ///
+  /// @returns Reference to this object.
+  Settings& preprocessing_passes(std::vector<PreprocessingPass> passes) {
+    preprocessing_passes_ = std::move(passes);
+    return *this;
+  }
+
+  /// Provides a convenient wrapper for the passes
+  /// from a comma-separated list of pass names.
+  ///
+  /// @param[in] passes  The ordered string representations of the passes.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  A pass is not recognized.
+  Settings& preprocessing_passes(std::string_view passes);
+
+  /// @returns The policy to apply the preprocessing passes.
+  PreprocessingPolicy preprocessing_policy() const {
+    return preprocessing_policy_;
+  }
+
+  /// Sets the policy to apply the preprocessing passes.
+  ///
+  /// @param[in] value  The policy kind.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The policy is not recognized.
+  /// @{
+  Settings& preprocessing_policy(PreprocessingPolicy value) noexcept {
+    preprocessing_policy_ = value;
+    return *this;
+  }
+  Settings& preprocessing_policy(std::string_view value);
+  /// @}
+
+  /// @returns The sampling strategy for Monte Carlo simulations.
+  Sampling sampling() const { return sampling_; }
+
+  /// Sets the sampling strategy for Monte Carlo simulations.
+  ///
+  /// @param[in] value  The sampling strategy.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The strategy is not recognized.
+  /// @{
+  Settings& sampling(Sampling value) noexcept {
+    sampling_ = value;
+    return *this;
+  }
+  Settings& sampling(std::string_view value);
+  /// @}
+
   /// @returns The number of trials for Monte-Carlo simulations.
   int num_trials() const { return num_trials_; }
 
@@ -143,6 +293,56 @@ class Settings {
   /// @throws SettingsError  The number is less than 1.
   Settings& num_trials(int n);
 
+  /// @returns The target relative half-width of the 95% confidence intervals
+  ///          for the sequential Monte Carlo simulations.
+  ///          0 if the simulations run all the trials.
+  double target_precision() const { return target_precision_; }
+
+  /// Sets the target precision for the sequential Monte Carlo simulations.
+  /// The simulations stop early once the 95% confidence intervals
+  /// of the mean and the 5th and 95th percentiles
+  /// are narrower than the target relative to their estimates.
+  ///
+  /// @param[in] precision  The relative half-width in [0, 1) range.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The precision is not in [0, 1) range.
+  Settings& target_precision(double precision);
+
+  /// @returns The wall-clock budget in seconds for Monte Carlo simulations.
+  ///          0 if the simulations are not limited in time.
+  double time_budget() const { return time_budget_; }
+
+  /// Sets the wall-clock budget for the sequential Monte Carlo simulations.
+  ///
+  /// @param[in] seconds  A non-negative duration; 0 for no limit.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The duration is negative.
+  Settings& time_budget(double seconds);
+
+  /// @returns true if uncertainty analysis keeps the raw samples
+  ///          in addition to the streaming summary.
+  bool raw_samples() const { return raw_samples_; }
+
+  /// Sets the flag to keep the raw samples of Monte Carlo simulations.
+  /// The memory grows linearly with the number of trials.
+  ///
+  /// @param[in] flag  true to keep the samples.
+  ///
+  /// @returns Reference to this object.
+  Settings& raw_samples(bool flag) noexcept {
+    raw_samples_ = flag;
+    return *this;
+  }
+
+  /// @returns true if Monte Carlo simulations may stop before all the trials.
+  bool sequential_sampling() const {
+    return target_precision_ || time_budget_;
+  }
+
   /// @returns The number of quantiles for distributions.
   int num_quantiles() const { return num_quantiles_; }
 
@@ -220,7 +420,8 @@ class Settings {
   /// @returns Reference to this object.
   Settings& probability_analysis(bool flag) {
     if (!importance_analysis_ && !uncertainty_analysis_ &&
-        !safety_integrity_levels_) {
+        !sensitivity_analysis_ && !safety_integrity_levels_ &&
+        !top_products_ && !shared_bdd_) {
       probability_analysis_ = flag;
     }
     return *this;
@@ -274,6 +475,62 @@ class Settings {
     return *this;
   }
 
+  /// @returns true if global sensitivity analysis is requested.
+  bool sensitivity_analysis() const { return sensitivity_analysis_; }
+
+  /// Sets the flag for global sensitivity analysis.
+  /// Sensitivity analysis implies probability analysis,
+  /// so the probability analysis is turned on implicitly.
+  ///
+  /// @param[in] flag  True or false for turning on or off the analysis.
+  ///
+  /// @returns Reference to this object.
+  Settings& sensitivity_analysis(bool flag) {
+    sensitivity_analysis_ = flag;
+    if (sensitivity_analysis_)
+      probability_analysis_ = true;
+    return *this;
+  }
+
+  /// @returns true if event-tree sequences are quantified in a shared BDD.
+  bool shared_bdd() const { return shared_bdd_; }
+
+  /// Sets the flag for quantification of all sequences of an event tree
+  /// in a single BDD with one unique table and one computation table.
+  /// Only the sequence probabilities are calculated in this mode,
+  /// so the probability analysis is turned on implicitly.
+  /// The shared BDD cannot be turned off before the phase cofactors.
+  ///
+  /// @param[in] flag  True or false for turning on or off the shared BDD.
+  ///
+  /// @returns Reference to this object.
+  Settings& shared_bdd(bool flag) {
+    shared_bdd_ = flag || phase_cofactors_;
+    if (shared_bdd_)
+      probability_analysis_ = true;
+    return *this;
+  }
+
+  /// @returns true if alignment phases are quantified as BDD cofactors.
+  bool phase_cofactors() const { return phase_cofactors_; }
+
+  /// Sets the flag for quantification of alignment phases
+  /// as cofactors of one shared BDD per event tree.
+  /// The house events set by the phases are kept as BDD variables,
+  /// so the phases only differ in the values of these variables.
+  /// This mode requires the shared BDD for event-tree sequences,
+  /// which is turned on implicitly.
+  ///
+  /// @param[in] flag  True or false for turning on or off the cofactors.
+  ///
+  /// @returns Reference to this object.
+  Settings& phase_cofactors(bool flag) {
+    phase_cofactors_ = flag;
+    if (phase_cofactors_)
+      shared_bdd(true);
+    return *this;
+  }
+
   /// @returns true if CCF groups must be incorporated into analysis.
   bool ccf_analysis() const { return ccf_analysis_; }
 
@@ -297,13 +554,31 @@ class Settings {
   bool safety_integrity_levels_ = false;  ///< Calculation of the SIL metrics.
   bool importance_analysis_ = false;  ///< A flag for importance analysis.
   bool uncertainty_analysis_ = false;  ///< A flag for uncertainty analysis.
+  bool sensitivity_analysis_ = false;  ///< A flag for sensitivity analysis.
   bool ccf_analysis_ = false;  ///< A flag for common-cause analysis.
   bool prime_implicants_ = false;  ///< Calculation of prime implicants.
+  bool shared_bdd_ = false;  ///< Event-tree sequences in a shared BDD.
+  bool phase_cofactors_ = false;  ///< Alignment phases as BDD cofactors.
+  bool raw_samples_ = false;  ///< Keeping the raw Monte Carlo samples.
   /// Qualitative analysis algorithm.
   Algorithm algorithm_ = Algorithm::kBdd;
   /// The approximations for calculations.
   Approximation approximation_ = Approximation::kNone;
+  /// The policy to apply the preprocessing passes.
+  PreprocessingPolicy preprocessing_policy_ = PreprocessingPolicy::kAll;
+  /// The graph optimization passes of preprocessing.
+  std::vector<PreprocessingPass> preprocessing_passes_ = {
+      PreprocessingPass::kCoalescence,
+      PreprocessingPass::kMergeCommonArgs,
+      PreprocessingPass::kDistributivity,
+      PreprocessingPass::kBooleanOptimization,
+      PreprocessingPass::kDecomposition,
+      PreprocessingPass::kCoalescence};
+  /// The sampling strategy for Monte Carlo simulations.
+  Sampling sampling_ = Sampling::kMonteCarlo;
   int limit_order_ = 20;  ///< Limit on the order of products.
+  int top_products_ = 0;  ///< The number of the most probable products.
+  int num_threads_ = 1;  ///< The number of threads for parallel analysis.
   int seed_ = 0;  ///< The seed for the pseudo-random number generator.
   int num_trials_ = 1e3;  ///< The number of trials for Monte Carlo simulations.
   int num_quantiles_ = 20;  ///< The number of quantiles for distributions.
@@ -311,6 +586,9 @@ class Settings {
   double mission_time_ = 8760;  ///< System mission time.
   double time_step_ = 0;  ///< The time step for probability analyses.
   double cut_off_ = 1e-8;  ///< The cut-off probability for products.
+  double bound_tolerance_ = 0.01;  ///< The relative gap of probability bounds.
+  double target_precision_ = 0;  ///< The target precision for sampling.
+  double time_budget_ = 0;  ///< The time budget in seconds for sampling.
 };
 
 }  // namespace scram::core
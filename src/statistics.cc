@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the streaming sample summaries.
+
+#include "statistics.h"
+
+#include <cassert>
+#include <cmath>
+
+#include <algorithm>
+#include <iterator>
+
+#include <boost/math/constants/constants.hpp>
+
+namespace scram::core {
+
+namespace {
+
+/// The number of buffered values per compression unit before merging.
+const int kBufferFactor = 5;
+
+}  // namespace
+
+SampleSummary::SampleSummary(double compression) : compression_(compression) {
+  assert(compression_ > 0);
+}
+
+void SampleSummary::Add(double value) noexcept {
+  if (!count_) {
+    min_ = max_ = value;
+  } else {
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+  ++count_;
+  double delta = value - mean_;
+  mean_ += delta / count_;
+  sum_squares_ += delta * (value - mean_);
+
+  buffer_.push_back({value, 1});
+  if (buffer_.size() >= kBufferFactor * compression_)
+    Compress();
+}
+
+void SampleSummary::Merge(const SampleSummary& other) noexcept {
+  if (!other.count_)
+    return;
+  if (!count_) {
+    min_ = other.min_;
+    max_ = other.max_;
+  } else {
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+  std::int64_t count = count_ + other.count_;
+  double delta = other.mean_ - mean_;
+  sum_squares_ += other.sum_squares_ +
+                  delta * delta * count_ / count * other.count_;
+  mean_ += delta * other.count_ / count;
+  count_ = count;
+
+  buffer_.insert(buffer_.end(), other.centroids_.begin(),
+                 other.centroids_.end());
+  buffer_.insert(buffer_.end(), other.buffer_.begin(), other.buffer_.end());
+  if (buffer_.size() >= kBufferFactor * compression_)
+    Compress();
+}
+
+void SampleSummary::Compress() const noexcept {
+  if (buffer_.empty())
+    return;
+  buffer_.insert(buffer_.end(), centroids_.begin(), centroids_.end());
+  std::sort(buffer_.begin(), buffer_.end(),
+            [](const Centroid& lhs, const Centroid& rhs) {
+              return lhs.mean < rhs.mean;
+            });
+  centroids_.clear();
+
+  // The arcsine scale function keeps the centroids small at the tails.
+  using boost::math::double_constants::half_pi;
+  const double kNormalizer = compression_ / (4 * half_pi);
+  auto scale = [kNormalizer](double q) {
+    return kNormalizer * std::asin(2 * q - 1);
+  };
+  auto inverse_scale = [kNormalizer](double k) {
+    return (std::sin(std::clamp(k / kNormalizer, -half_pi, half_pi)) + 1) / 2;
+  };
+  double total = count_;
+  double prefix = 0;  // The weight before the current centroid.
+  Centroid current = buffer_.front();
+  double q_limit = inverse_scale(scale(0) + 1);
+  for (auto it = std::next(buffer_.begin()); it != buffer_.end(); ++it) {
+    if ((prefix + current.weight + it->weight) / total <= q_limit) {
+      current.weight += it->weight;
+      current.mean += (it->mean - current.mean) * it->weight / current.weight;
+    } else {
+      centroids_.push_back(current);
+      prefix += current.weight;
+      q_limit = inverse_scale(scale(prefix / total) + 1);
+      current = *it;
+    }
+  }
+  centroids_.push_back(current);
+  buffer_.clear();
+}
+
+double SampleSummary::Quantile(double p) const noexcept {
+  assert(count_ && "Empty summary.");
+  if (p <= 0)
+    return min_;
+  if (p >= 1)
+    return max_;
+  Compress();
+  double index = p * count_;
+  const Centroid& first = centroids_.front();
+  if (index < first.weight / 2)
+    return min_ + (first.mean - min_) * index / (first.weight / 2);
+
+  double cumulative = first.weight / 2;
+  for (int i = 0; i < centroids_.size() - 1; ++i) {
+    const Centroid& left = centroids_[i];
+    const Centroid& right = centroids_[i + 1];
+    double span = (left.weight + right.weight) / 2;
+    if (index < cumulative + span)
+      return left.mean + (right.mean - left.mean) * (index - cumulative) / span;
+    cumulative += span;
+  }
+  const Centroid& last = centroids_.back();
+  double tail = std::min(index - cumulative, last.weight / 2);
+  return last.mean + (max_ - last.mean) * tail / (last.weight / 2);
+}
+
+double SampleSummary::Cdf(double value) const noexcept {
+  assert(count_ && "Empty summary.");
+  if (value < min_)
+    return 0;
+  if (value >= max_)
+    return 1;
+  Compress();
+  const Centroid& first = centroids_.front();
+  if (value < first.mean)
+    return first.weight / 2 * (value - min_) / (first.mean - min_) / count_;
+
+  double cumulative = first.weight / 2;
+  for (int i = 0; i < centroids_.size() - 1; ++i) {
+    const Centroid& left = centroids_[i];
+    const Centroid& right = centroids_[i + 1];
+    double span = (left.weight + right.weight) / 2;
+    if (value < right.mean) {
+      return (cumulative +
+              span * (value - left.mean) / (right.mean - left.mean)) /
+             count_;
+    }
+    cumulative += span;
+  }
+  const Centroid& last = centroids_.back();
+  return (cumulative +
+          last.weight / 2 * (value - last.mean) / (max_ - last.mean)) /
+         count_;
+}
+
+std::vector<std::pair<double, double>> SampleSummary::Histogram(
+    int num_bins) const noexcept {
+  assert(count_ && "Empty summary.");
+  assert(num_bins > 0);
+  std::vector<std::pair<double, double>> histogram;
+  double width = (max_ - min_) / num_bins;
+  double prev_cdf = 0;
+  for (int i = 0; i < num_bins; ++i) {
+    double lower = min_ + i * width;
+    double cdf = i == num_bins - 1 ? 1 : Cdf(lower + width);
+    histogram.emplace_back(lower, cdf - prev_cdf);
+    prev_cdf = cdf;
+  }
+  histogram.emplace_back(max_, 0);
+  return histogram;
+}
+
+}  // namespace scram::core
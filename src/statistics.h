@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Streaming summaries of samples for Monte Carlo simulations.
+
+#pragma once
+
+#include <cstdint>
+
+#include <utility>
+#include <vector>
+
+namespace scram::core {
+
+/// Mergeable streaming summary of a sample
+/// with constant memory in the number of values.
+///
+/// The moments are accumulated with the Welford algorithm,
+/// and the distribution is approximated with a merging t-digest
+/// that keeps the tails more accurate than the middle.
+/// Summaries of disjoint samples (e.g., from different workers)
+/// combine into the summary of the union.
+class SampleSummary {
+ public:
+  /// The default compression of the t-digest.
+  static constexpr double kDefaultCompression = 200;
+
+  /// @param[in] compression  The t-digest size-accuracy parameter;
+  ///                         the number of centroids is about this value.
+  explicit SampleSummary(double compression = kDefaultCompression);
+
+  /// Adds a value to the summary.
+  ///
+  /// @param[in] value  A finite sample value.
+  void Add(double value) noexcept;
+
+  /// Merges another summary into this one.
+  ///
+  /// @param[in] other  The summary of a disjoint sample.
+  void Merge(const SampleSummary& other) noexcept;
+
+  /// @returns The number of values in the summary.
+  std::int64_t count() const { return count_; }
+
+  /// @returns The mean of the values; 0 for empty summaries.
+  double mean() const { return mean_; }
+
+  /// @returns The unbiased variance of the values.
+  double variance() const {
+    return count_ > 1 ? sum_squares_ / (count_ - 1) : 0;
+  }
+
+  /// @returns The smallest value.
+  double min() const { return min_; }
+
+  /// @returns The largest value.
+  double max() const { return max_; }
+
+  /// Estimates a quantile of the distribution.
+  ///
+  /// @param[in] p  The cumulative probability in [0, 1].
+  ///
+  /// @returns The estimated value at the probability.
+  ///
+  /// @pre The summary is not empty.
+  double Quantile(double p) const noexcept;
+
+  /// Estimates the cumulative distribution function.
+  ///
+  /// @param[in] value  The value of the distribution.
+  ///
+  /// @returns The estimated fraction of values below the given value.
+  ///
+  /// @pre The summary is not empty.
+  double Cdf(double value) const noexcept;
+
+  /// Estimates the histogram with equal bins between min and max values.
+  ///
+  /// @param[in] num_bins  The number of bins.
+  ///
+  /// @returns Lower bounds of the bins with the fractions of values,
+  ///          and the max value with 0 fraction as the closing bound.
+  ///
+  /// @pre The summary is not empty.
+  std::vector<std::pair<double, double>> Histogram(int num_bins) const
+      noexcept;
+
+ private:
+  /// A cluster of values with their mean and count.
+  struct Centroid {
+    double mean;  ///< The mean of the values.
+    double weight;  ///< The number of values.
+  };
+
+  /// Merges the buffered values into the sorted centroids.
+  void Compress() const noexcept;
+
+  double compression_;  ///< The t-digest compression parameter.
+  std::int64_t count_ = 0;  ///< The number of values.
+  double mean_ = 0;  ///< The running mean.
+  double sum_squares_ = 0;  ///< The sum of squared deviations from the mean.
+  double min_ = 0;  ///< The smallest value.
+  double max_ = 0;  ///< The largest value.
+  /// The centroids sorted by their means (after compression).
+  mutable std::vector<Centroid> centroids_;
+  mutable std::vector<Centroid> buffer_;  ///< Values not yet merged.
+};
+
+}  // namespace scram::core
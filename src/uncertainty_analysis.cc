@@ -20,39 +20,151 @@
 
 #include "uncertainty_analysis.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <unordered_set>
 
-#include <boost/accumulators/accumulators.hpp>
-#include <boost/accumulators/statistics/density.hpp>
-#include <boost/accumulators/statistics/extended_p_square_quantile.hpp>
-#include <boost/accumulators/statistics/mean.hpp>
-#include <boost/accumulators/statistics/stats.hpp>
-#include <boost/accumulators/statistics/variance.hpp>
+#include <boost/random/sobol.hpp>
 
 #include "event.h"
 #include "expression.h"
+#include "expression/random_deviate.h"
 #include "logger.h"
 
 namespace scram::core {
 
+/// Stratified or quasi-random points in the unit hypercube
+/// with a dimension per random deviate.
+/// The points are generated in blocks
+/// to keep the memory bounded for long simulations.
+class UncertaintyAnalysis::Design {
+ public:
+  /// The maximum number of coordinates in a single block of points.
+  static constexpr int kMaxBlockSize = 1 << 22;
+
+  /// @param[in] sampling  The sampling strategy other than plain Monte Carlo.
+  /// @param[in] deviates  The unique random deviates to drive.
+  Design(Sampling sampling, std::vector<mef::RandomDeviate*> deviates)
+      : sampling_(sampling), deviates_(std::move(deviates)) {
+    assert(sampling_ != Sampling::kMonteCarlo);
+    assert(!deviates_.empty());
+    if (sampling_ == Sampling::kSobol) {
+      int dimension = std::min<int>(
+          deviates_.size(), boost::random::default_sobol_table::max_dimension);
+      if (dimension < deviates_.size())
+        LOG(WARNING) << "Sobol sequence is limited to " << dimension
+                     << " dimensions; the rest are sampled randomly.";
+      sobol_.emplace(dimension);
+      // The random digital shift keeps the net properties of the sequence.
+      for (int i = 0; i < dimension; ++i)
+        shifts_.push_back(mef::RandomDeviate::rng()());
+    }
+  }
+
+  /// Restores the pseudo-random draws of the deviates.
+  ~Design() noexcept {
+    for (mef::RandomDeviate* deviate : deviates_)
+      deviate->quantile(0);
+  }
+
+  /// Starts a new batch of trials.
+  /// Latin hypercube strata span the batch (or its blocks).
+  ///
+  /// @param[in] num_trials  The number of trials in the batch.
+  void Start(int num_trials) noexcept {
+    remaining_ = num_trials;
+    points_.clear();
+    next_ = 0;
+  }
+
+  /// Places the deviates at the next point of the design.
+  void Apply() noexcept {
+    assert(remaining_ > 0 && "Sampling beyond the batch.");
+    if (next_ == points_.size())
+      Generate();
+    for (mef::RandomDeviate* deviate : deviates_)
+      deviate->quantile(points_[next_++]);
+    --remaining_;
+  }
+
+ private:
+  /// @returns A uniform value in (0, 1) from a 32-bit integer.
+  static double ToUnit(std::uint32_t value) noexcept {
+    return std::ldexp(value + 0.5, -32);
+  }
+
+  /// Generates the next block of points for the remaining trials.
+  void Generate() noexcept {
+    int dimension = deviates_.size();
+    int num_points =
+        std::min(remaining_, std::max(1, kMaxBlockSize / dimension));
+    points_.resize(static_cast<std::size_t>(num_points) * dimension);
+    next_ = 0;
+    std::mt19937& rng = mef::RandomDeviate::rng();
+    if (sampling_ == Sampling::kLatinHypercube) {
+      std::vector<int> strata(num_points);
+      for (int j = 0; j < dimension; ++j) {
+        std::iota(strata.begin(), strata.end(), 0);
+        std::shuffle(strata.begin(), strata.end(), rng);
+        for (int i = 0; i < num_points; ++i)
+          points_[i * dimension + j] = (strata[i] + ToUnit(rng())) / num_points;
+      }
+    } else {
+      assert(sampling_ == Sampling::kSobol);
+      int sobol_dimension = shifts_.size();
+      for (int i = 0; i < num_points; ++i) {
+        double* point = &points_[i * dimension];
+        for (int j = 0; j < sobol_dimension; ++j)
+          point[j] = ToUnit((*sobol_)() ^ shifts_[j]);
+        for (int j = sobol_dimension; j < dimension; ++j)
+          point[j] = ToUnit(rng());
+      }
+    }
+  }
+
+  Sampling sampling_;  ///< The sampling strategy.
+  std::vector<mef::RandomDeviate*> deviates_;  ///< The design dimensions.
+  std::vector<double> points_;  ///< The block of points in row-major order.
+  std::size_t next_ = 0;  ///< The next coordinate in the block.
+  int remaining_ = 0;  ///< The number of trials left in the batch.
+  /// The low-discrepancy sequence for Sobol sampling.
+  std::optional<boost::random::sobol_engine<std::uint32_t, 32>> sobol_;
+  std::vector<std::uint32_t> shifts_;  ///< The digital shift per dimension.
+};
+
 UncertaintyAnalysis::UncertaintyAnalysis(
     const ProbabilityAnalysis* prob_analysis)
     : Analysis(prob_analysis->settings()),
       mean_(0),
       sigma_(0),
-      error_factor_(1) {}
+      error_factor_(1),
+      num_trials_(0),
+      precision_(std::numeric_limits<double>::infinity()),
+      start_time_(0) {}
+
+UncertaintyAnalysis::~UncertaintyAnalysis() noexcept = default;
 
 void UncertaintyAnalysis::Analyze() noexcept {
   CLOCK(analysis_time);
-  CLOCK(sample_time);
+  start_time_ = TIME_STAMP();
   LOG(DEBUG3) << "Sampling probabilities...";
   // Sample probabilities and generate data.
-  std::vector<double> samples = this->Sample();
-  LOG(DEBUG3) << "Finished sampling probabilities in " << DUR(sample_time);
+  this->Sample();
+  design_.reset();
+  num_trials_ = summary_.count();
+  LOG(DEBUG3) << "Finished sampling " << num_trials_ << " probabilities in "
+              << DUR(start_time_);
+  if (Analysis::settings().sequential_sampling()) {
+    precision_ = CalculatePrecision(summary_);
+    LOG(DEBUG4) << "Achieved precision: " << precision_;
+  }
 
   {
     TIMER(DEBUG3, "Calculating statistics");
-    CalculateStatistics(samples);  // Perform statistical analysis.
+    CalculateStatistics();  // Perform statistical analysis.
   }
 
   Analysis::AddAnalysisTime(DUR(analysis_time));
@@ -70,6 +182,22 @@ UncertaintyAnalysis::GatherDeviateExpressions(const Pdag* graph) noexcept {
   return deviate_expressions;
 }
 
+void UncertaintyAnalysis::PrepareDesign(
+    const std::vector<std::pair<int, mef::Expression&>>&
+        deviate_expressions) noexcept {
+  if (Analysis::settings().sampling() == Sampling::kMonteCarlo)
+    return;
+  std::vector<mef::RandomDeviate*> deviates;
+  std::unordered_set<mef::Expression*> visited;
+  for (const auto& expression : deviate_expressions)
+    mef::GatherDeviates(&expression.second, &deviates, &visited);
+  if (!deviates.empty()) {
+    LOG(DEBUG4) << "Sampling design dimensions: " << deviates.size();
+    design_ = std::make_unique<Design>(Analysis::settings().sampling(),
+                                       std::move(deviates));
+  }
+}
+
 void UncertaintyAnalysis::SampleExpressions(
     const std::vector<std::pair<int, mef::Expression&>>& deviate_expressions,
     Pdag::IndexMap<double>* p_vars) noexcept {
@@ -77,6 +205,9 @@ void UncertaintyAnalysis::SampleExpressions(
   for (const auto& expression : deviate_expressions)
     expression.second.Reset();
 
+  if (design_)
+    design_->Apply();
+
   // Sample all expressions with distributions.
   for (const auto& expression : deviate_expressions) {
     double prob = expression.second.Sample();
@@ -84,40 +215,77 @@ void UncertaintyAnalysis::SampleExpressions(
   }
 }
 
-void UncertaintyAnalysis::CalculateStatistics(
-    const std::vector<double>& samples) noexcept {
-  using namespace boost;  // NOLINT
-  using namespace boost::accumulators;  // NOLINT
-  using histogram_type =
-      iterator_range<std::vector<std::pair<double, double>>::iterator>;
+int UncertaintyAnalysis::NextBatchSize() noexcept {
+  int batch_size = [this] {
+    int max_trials = Analysis::settings().num_trials();
+    int num_samples = summary_.count();
+    if (!Analysis::settings().sequential_sampling())
+      return max_trials - num_samples;
+
+    if (num_samples >= max_trials)
+      return 0;
+    if (num_samples >= kMinBatchSize) {
+      double time_budget = Analysis::settings().time_budget();
+      if (time_budget && DUR(start_time_) >= time_budget) {
+        LOG(DEBUG4) << "Sampling is out of the time budget.";
+        return 0;
+      }
+      double target = Analysis::settings().target_precision();
+      if (target && CalculatePrecision(summary_) <= target) {
+        LOG(DEBUG4) << "Sampling has converged.";
+        return 0;
+      }
+    }
+    return std::min(std::max(kMinBatchSize, num_samples / 10),
+                    max_trials - num_samples);
+  }();
+  if (design_)
+    design_->Start(batch_size);
+  return batch_size;
+}
+
+double UncertaintyAnalysis::CalculatePrecision(
+    const SampleSummary& summary) noexcept {
+  const double kZ = 1.96;  // The 95% confidence level.
+  // The interval half-width relative to the estimate.
+  auto relative = [](double half_width, double estimate) {
+    if (!half_width)
+      return 0.0;
+    return estimate ? half_width / estimate
+                    : std::numeric_limits<double>::infinity();
+  };
+  double n = summary.count();
+  if (n < 2)
+    return std::numeric_limits<double>::infinity();
+
+  double precision =
+      relative(kZ * std::sqrt(summary.variance() / n), summary.mean());
+
+  // Distribution-free intervals of percentiles with order statistics.
+  for (double p : {0.05, 0.95}) {
+    double spread = kZ * std::sqrt(p * (1 - p) / n);
+    double lower = summary.Quantile(p - spread);
+    double upper = summary.Quantile(p + spread);
+    precision =
+        std::max(precision, relative((upper - lower) / 2, summary.Quantile(p)));
+  }
+  return precision;
+}
+
+void UncertaintyAnalysis::CalculateStatistics() noexcept {
   quantiles_.clear();
   int num_quantiles = Analysis::settings().num_quantiles();
   double delta = 1.0 / num_quantiles;
-  for (int i = 0; i < num_quantiles; ++i) {
-    quantiles_.push_back(delta * (i + 1));
-  }
-  int num_trials = Analysis::settings().num_trials();
-  accumulator_set<double, stats<tag::mean, tag::variance, tag::density,
-                                tag::extended_p_square_quantile>>
-      acc(tag::density::num_bins = Analysis::settings().num_bins(),
-          tag::density::cache_size = num_trials,
-          extended_p_square_probabilities = quantiles_);
-  for (double sample : samples) {
-    acc(sample);
-  }
-  histogram_type hist = density(acc);
-  for (int i = 1; i < hist.size(); i++) {
-    distribution_.push_back(hist[i]);
-  }
-  mean_ = boost::accumulators::mean(acc);
-  sigma_ = std::sqrt(num_trials * variance(acc) / (num_trials - 1));
-  error_factor_ = std::exp(1.96 * sigma_);
-  confidence_interval_.first = mean_ - sigma_ * 1.96 / std::sqrt(num_trials);
-  confidence_interval_.second = mean_ + sigma_ * 1.96 / std::sqrt(num_trials);
+  for (int i = 0; i < num_quantiles; ++i)
+    quantiles_.push_back(summary_.Quantile(delta * (i + 1)));
 
-  for (int i = 0; i < num_quantiles; ++i) {
-    quantiles_[i] = quantile(acc, quantile_probability = quantiles_[i]);
-  }
+  distribution_ = summary_.Histogram(Analysis::settings().num_bins());
+  mean_ = summary_.mean();
+  sigma_ = std::sqrt(summary_.variance());
+  error_factor_ = std::exp(1.96 * sigma_);
+  double half_width = sigma_ * 1.96 / std::sqrt(summary_.count());
+  confidence_interval_.first = mean_ - half_width;
+  confidence_interval_.second = mean_ + half_width;
 }
 
 }  // namespace scram::core
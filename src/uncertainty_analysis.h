@@ -21,15 +21,19 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <utility>
 #include <vector>
 
 #include "analysis.h"
 #include "probability_analysis.h"
 #include "settings.h"
+#include "statistics.h"
 
 namespace scram::mef {  // Decouple from the implementation dependence.
 class Expression;
+class RandomDeviate;
 }  // namespace scram::mef
 
 namespace scram::core {
@@ -46,7 +50,7 @@ class UncertaintyAnalysis : public Analysis {
   /// @param[in] prob_analysis  Completed probability analysis.
   explicit UncertaintyAnalysis(const ProbabilityAnalysis* prob_analysis);
 
-  virtual ~UncertaintyAnalysis() = default;
+  virtual ~UncertaintyAnalysis() noexcept;
 
   /// Performs quantitative analysis on the total probability.
   ///
@@ -75,16 +79,64 @@ class UncertaintyAnalysis : public Analysis {
   /// @returns Quantiles of the distribution.
   const std::vector<double>& quantiles() const { return quantiles_; }
 
- protected:
+  /// @returns The streaming summary of the samples.
+  const SampleSummary& summary() const { return summary_; }
+
+  /// @returns The raw samples in the order of trials
+  ///          if requested by the settings; empty otherwise.
+  const std::vector<double>& samples() const { return samples_; }
+
   /// Gathers deviate expressions of variables.
   ///
   /// @param[in] graph  PDAG with the variables.
   ///
   /// @returns The gathered deviate expressions with variable indices.
-  std::vector<std::pair<int, mef::Expression&>>
+  static std::vector<std::pair<int, mef::Expression&>>
   GatherDeviateExpressions(const Pdag* graph) noexcept;
 
+  /// @returns The number of performed trials.
+  ///          It may be less than the number of trials in the settings
+  ///          if the sequential sampling stopped early.
+  int num_trials() const { return num_trials_; }
+
+  /// @returns The achieved relative half-width of the 95% confidence intervals
+  ///          of the mean and the 5th and 95th percentiles,
+  ///          or infinity if the sampling is not sequential.
+  double precision() const { return precision_; }
+
+ protected:
+  /// The smallest number of trials per batch in sequential sampling.
+  static constexpr int kMinBatchSize = 100;
+
+  /// Decides the size of the next batch of trials.
+  /// Fixed sampling runs all the trials in a single batch.
+  /// Sequential sampling grows batches geometrically
+  /// and stops once the target precision is reached
+  /// or the time budget is exhausted.
+  ///
+  /// @returns The number of trials to run next; 0 to stop sampling.
+  int NextBatchSize() noexcept;
+
+  /// Records the result of a trial.
+  ///
+  /// @param[in] value  The sampled total probability.
+  void AddSample(double value) noexcept {
+    summary_.Add(value);
+    if (Analysis::settings().raw_samples())
+      samples_.push_back(value);
+  }
+
+  /// Prepares the sampling design for the deviate expressions.
+  /// The random deviates within the expressions
+  /// become the dimensions of the design
+  /// for stratified and quasi-random sampling.
+  ///
+  /// @param[in] deviate_expressions  A collection of deviate expressions.
+  void PrepareDesign(const std::vector<std::pair<int, mef::Expression&>>&
+                         deviate_expressions) noexcept;
+
   /// Samples uncertain probabilities.
+  /// The samples follow the sampling strategy of the analysis settings.
   ///
   /// @param[in] deviate_expressions  A collection of deviate expressions.
   /// @param[in,out] p_vars  Indices to probabilities mapping with values.
@@ -95,15 +147,22 @@ class UncertaintyAnalysis : public Analysis {
  private:
   /// Performs Monte Carlo Simulation
   /// by sampling the probability distributions
-  /// and providing the final sampled values of the final probability.
-  ///
-  /// @returns Sampled values.
-  virtual std::vector<double> Sample() noexcept = 0;
+  /// and recording the sampled values of the final probability.
+  virtual void Sample() noexcept = 0;
 
-  /// Calculates statistical values from the final distribution.
+  /// Stratified or quasi-random sampling design.
+  class Design;
+
+  /// Calculates statistical values from the summary of the samples.
+  void CalculateStatistics() noexcept;
+
+  /// Calculates the relative half-width of the 95% confidence intervals
+  /// of the mean and the 5th and 95th percentiles.
+  ///
+  /// @param[in] summary  The summary of the gathered samples.
   ///
-  /// @param[in] samples  Gathered samples for statistical analysis.
-  void CalculateStatistics(const std::vector<double>& samples) noexcept;
+  /// @returns The widest relative half-width of the intervals.
+  static double CalculatePrecision(const SampleSummary& summary) noexcept;
 
   double mean_;  ///< The mean of the final distribution.
   double sigma_;  ///< The standard deviation of the final distribution.
@@ -114,6 +173,13 @@ class UncertaintyAnalysis : public Analysis {
   std::vector<std::pair<double, double>> distribution_;
   /// The quantiles of the distribution.
   std::vector<double> quantiles_;
+  int num_trials_;  ///< The number of performed trials.
+  double precision_;  ///< The achieved precision of the estimates.
+  std::uint64_t start_time_;  ///< The start of sampling for the time budget.
+  /// The design for sampling strategies other than plain Monte Carlo.
+  std::unique_ptr<Design> design_;
+  SampleSummary summary_;  ///< The streaming summary of the samples.
+  std::vector<double> samples_;  ///< The optional raw samples.
 };
 
 /// Uncertainty analysis facility.
@@ -131,29 +197,28 @@ class UncertaintyAnalyzer : public UncertaintyAnalysis {
       : UncertaintyAnalysis(prob_analyzer), prob_analyzer_(prob_analyzer) {}
 
  private:
-  /// @returns Samples of the total probability.
-  std::vector<double> Sample() noexcept override;
+  /// Samples the total probability.
+  void Sample() noexcept override;
 
   /// Calculator of the total probability.
   ProbabilityAnalyzer<Calculator>* prob_analyzer_;
 };
 
 template <class Calculator>
-std::vector<double> UncertaintyAnalyzer<Calculator>::Sample() noexcept {
+void UncertaintyAnalyzer<Calculator>::Sample() noexcept {
   std::vector<std::pair<int, mef::Expression&>> deviate_expressions =
       UncertaintyAnalysis::GatherDeviateExpressions(prob_analyzer_->graph());
+  UncertaintyAnalysis::PrepareDesign(deviate_expressions);
   Pdag::IndexMap<double> p_vars = prob_analyzer_->p_vars();  // Private copy!
-  std::vector<double> samples;
-  samples.reserve(Analysis::settings().num_trials());
-
-  for (int i = 0; i < Analysis::settings().num_trials(); ++i) {
-    UncertaintyAnalysis::SampleExpressions(deviate_expressions, &p_vars);
-    double result = prob_analyzer_->CalculateTotalProbability(p_vars);
-    assert(result >= 0 && result <= 1);
-    samples.push_back(result);
-  }
 
-  return samples;
+  while (int batch_size = UncertaintyAnalysis::NextBatchSize()) {
+    for (int i = 0; i < batch_size; ++i) {
+      UncertaintyAnalysis::SampleExpressions(deviate_expressions, &p_vars);
+      double result = prob_analyzer_->CalculateTotalProbability(p_vars);
+      assert(result >= 0 && result <= 1);
+      UncertaintyAnalysis::AddSample(result);
+    }
+  }
 }
 
 }  // namespace scram::core
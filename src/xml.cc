@@ -20,14 +20,53 @@
 
 #include "xml.h"
 
+#include <fstream>
+#include <iterator>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
+
 #include <libxml/xinclude.h>
 
+#include <zlib.h>
+
 namespace scram::xml {
 
+namespace {
+
+/// Parses a gzip-compressed XML document with zlib
+/// regardless of the compression support in the XML library.
+///
+/// @param[in] file_path  The path to the compressed document file.
+///
+/// @returns The document or nullptr with the XML library error.
+///
+/// @throws IOError  The file is not available.
+xmlDoc* ReadGzipFile(const std::string& file_path) {
+  gzFile file = gzopen(file_path.c_str(), "rb");
+  if (!file) {
+    SCRAM_THROW(IOError("Cannot open the compressed file."))
+        << boost::errinfo_file_name(file_path) << boost::errinfo_errno(errno)
+        << boost::errinfo_file_open_mode("rb");
+  }
+  return xmlReadIO(  // Closes the file in any case.
+      [](void* context, char* buffer, int len) {
+        return gzread(static_cast<gzFile>(context), buffer, len);
+      },
+      [](void* context) {
+        return gzclose(static_cast<gzFile>(context)) == Z_OK ? 0 : -1;
+      },
+      file, file_path.c_str(), nullptr, kParserOptions);
+}
+
+}  // namespace
+
 Document::Document(const std::string& file_path, Validator* validator)
     : doc_(nullptr, &xmlFreeDoc) {
   xmlResetLastError();
-  doc_.reset(xmlReadFile(file_path.c_str(), nullptr, kParserOptions));
+  doc_.reset(boost::ends_with(file_path, ".gz")
+                 ? ReadGzipFile(file_path)
+                 : xmlReadFile(file_path.c_str(), nullptr, kParserOptions));
   xmlErrorPtr xml_error = xmlGetLastError();
   if (xml_error) {
     if (xml_error->domain == xmlErrorDomain::XML_FROM_IO) {
@@ -45,8 +84,7 @@ Document::Document(const std::string& file_path, Validator* validator)
 }
 
 Validator::Validator(const std::string& rng_file)
-    : schema_(nullptr, &xmlRelaxNGFree),
-      valid_ctxt_(nullptr, &xmlRelaxNGFreeValidCtxt) {
+    : schema_(nullptr, &xmlRelaxNGFree) {
   xmlResetLastError();
   std::unique_ptr<xmlRelaxNGParserCtxt, decltype(&xmlRelaxNGFreeParserCtxt)>
       parser_ctxt(xmlRelaxNGNewParserCtxt(rng_file.c_str()),
@@ -58,9 +96,52 @@ Validator::Validator(const std::string& rng_file)
   if (!schema_)
     SCRAM_THROW(detail::GetError<ParseError>());
 
-  valid_ctxt_.reset(xmlRelaxNGNewValidCtxt(schema_.get()));
-  if (!valid_ctxt_)
-    SCRAM_THROW(detail::GetError<LogicError>());
+}
+
+std::optional<std::size_t> HashDocument(const std::string& file_path) {
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file) {
+    SCRAM_THROW(IOError("The file is not accessible."))
+        << boost::errinfo_file_name(file_path);
+  }
+  std::string content((std::istreambuf_iterator<char>(file)),
+                      std::istreambuf_iterator<char>());
+  if (content.find(kXIncludeNamespace) != std::string::npos)
+    return {};
+  return std::hash<std::string>()(content);
+}
+
+std::shared_ptr<const Document> DocumentCache::Get(const std::string& file_path,
+                                                   Validator* validator) {
+  namespace fs = boost::filesystem;
+  std::optional<std::size_t> hash = HashDocument(file_path);
+  if (!hash)  // The content hash does not cover the included files.
+    return std::make_shared<const Document>(file_path, validator);
+
+  Entry* entry = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<Entry>& slot = entries_[fs::canonical(file_path).string()];
+    if (!slot)
+      slot = std::make_unique<Entry>();
+    entry = slot.get();  // Entries are never removed.
+  }
+  std::lock_guard<std::mutex> lock(entry->mutex);
+  if (!entry->document || entry->hash != *hash) {
+    entry->document = std::make_shared<const Document>(file_path, validator);
+    entry->hash = *hash;
+  }
+  return entry->document;
+}
+
+int DocumentCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int num_documents = 0;
+  for (const auto& [path, entry] : entries_) {
+    std::lock_guard<std::mutex> entry_lock(entry->mutex);
+    num_documents += static_cast<bool>(entry->document);
+  }
+  return num_documents;
 }
 
 }  // namespace scram::xml
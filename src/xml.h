@@ -38,10 +38,12 @@
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <unordered_map>
 
 #include <boost/exception/errinfo_at_line.hpp>
 #include <boost/exception/errinfo_errno.hpp>
@@ -395,6 +397,9 @@ const int kParserOptions = XML_PARSE_XINCLUDE | XML_PARSE_NOBASEFIX |
                            XML_PARSE_NONET | XML_PARSE_NOXINCNODE |
                            XML_PARSE_COMPACT | XML_PARSE_HUGE;
 
+/// The namespace of XInclude directives.
+const char kXIncludeNamespace[] = "http://www.w3.org/2001/XInclude";
+
 class Validator;  // Forward declaration for validation upon DOM constructions.
 
 /// XML DOM tree document.
@@ -402,6 +407,7 @@ class Document {
  public:
   /// Parses XML input document.
   /// All XInclude directives are processed into the final document.
+  /// Files with ".gz" extension are decompressed on the fly.
   ///
   /// @param[in] file_path  The path to the document file.
   /// @param[in] validator  Optional validator against the RNG schema.
@@ -443,24 +449,85 @@ class Validator {
   explicit Validator(const std::string& rng_file);
 
   /// Validates XML DOM documents against the schema.
+  /// The validation is thread-safe
+  /// with a new validation context per call.
   ///
   /// @param[in] doc  The initialized XML DOM document.
   ///
   /// @throws ValidityError  The document failed schema validation.
+  /// @throws LogicError  The XML library functions have failed internally.
   void validate(const Document& doc) {
     xmlResetLastError();
-    int ret = xmlRelaxNGValidateDoc(valid_ctxt_.get(),
+    std::unique_ptr<xmlRelaxNGValidCtxt, decltype(&xmlRelaxNGFreeValidCtxt)>
+        valid_ctxt(xmlRelaxNGNewValidCtxt(schema_.get()),
+                   &xmlRelaxNGFreeValidCtxt);
+    if (!valid_ctxt)
+      SCRAM_THROW(detail::GetError<LogicError>());
+    int ret = xmlRelaxNGValidateDoc(valid_ctxt.get(),
                                     const_cast<xmlDoc*>(doc.get()));
     if (ret != 0)
       SCRAM_THROW(detail::GetError<ValidityError>());
   }
 
  private:
-  /// The schema used by the validation context.
+  /// The schema shared by the validation contexts.
   std::unique_ptr<xmlRelaxNG, decltype(&xmlRelaxNGFree)> schema_;
-  /// The validation context.
-  std::unique_ptr<xmlRelaxNGValidCtxt, decltype(&xmlRelaxNGFreeValidCtxt)>
-      valid_ctxt_;
+};
+
+/// Hashes the content of a document file
+/// to detect its modifications.
+///
+/// @param[in] file_path  The path to the document file.
+///
+/// @returns The content hash,
+///          or nullopt if the document has XInclude directives
+///          because the hash would not cover the included files.
+///
+/// @throws IOError  The file is not available.
+std::optional<std::size_t> HashDocument(const std::string& file_path);
+
+/// Thread-safe cache of parsed and validated documents
+/// to share the common input files among independent initializations.
+/// The documents are identified by their canonical paths
+/// and content hashes,
+/// so modified files are parsed again.
+/// Documents with XInclude directives are parsed anew and not cached
+/// because the hashes do not cover the included files.
+///
+/// @pre The documents are not modified by the users.
+class DocumentCache {
+ public:
+  /// Finds the cached document or parses and caches a new one.
+  ///
+  /// @param[in] file_path  The path to the document file.
+  /// @param[in] validator  The validator against the RNG schema.
+  ///
+  /// @returns The shared document.
+  ///
+  /// @pre The same validator is used for all the documents.
+  ///
+  /// @throws IOError  The file is not available.
+  /// @throws ParseError  There are XML parsing failures.
+  /// @throws XIncludeError  XInclude resolution has failed.
+  /// @throws ValidityError  The XML file is not valid.
+  std::shared_ptr<const Document> Get(const std::string& file_path,
+                                      Validator* validator);
+
+  /// @returns The number of cached documents.
+  int size() const;
+
+ private:
+  /// The cache entry with its own lock
+  /// to parse different documents concurrently.
+  struct Entry {
+    std::mutex mutex;  ///< The lock for parsing.
+    std::size_t hash = 0;  ///< The content hash of the parsed file.
+    std::shared_ptr<const Document> document;  ///< The parsed document.
+  };
+
+  mutable std::mutex mutex_;  ///< The lock for the entry table.
+  /// The documents by canonical file paths.
+  std::unordered_map<std::string, std::unique_ptr<Entry>> entries_;
 };
 
 }  // namespace scram::xml
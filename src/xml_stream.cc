@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the compressed output of XML streams.
+
+#include "xml_stream.h"
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <zlib.h>
+
+#ifdef SCRAM_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace scram::xml {
+
+Compression CompressionFromPath(const std::string& file_path) noexcept {
+  if (boost::ends_with(file_path, ".gz"))
+    return Compression::kGzip;
+  if (boost::ends_with(file_path, ".zst"))
+    return Compression::kZstd;
+  return Compression::kNone;
+}
+
+namespace detail {
+
+/// Streaming compressor of chunks of data into a file.
+class Compressor {
+ public:
+  virtual ~Compressor() = default;
+
+  /// Compresses the data into the file.
+  ///
+  /// @param[in] data  The data to compress.
+  /// @param[in] size  The number of bytes in the data.
+  /// @param[in] finish  The indicator of the last chunk of the data.
+  /// @param[in,out] file  The destination file.
+  ///
+  /// @returns false if the compression has failed.
+  virtual bool Write(const char* data, std::size_t size, bool finish,
+                     std::FILE* file) noexcept = 0;
+
+ protected:
+  static constexpr std::size_t kChunkSize = 1 << 16;  ///< The output chunk.
+
+  unsigned char chunk_[kChunkSize];  ///< The compressed output buffer.
+};
+
+namespace {
+
+/// The gzip format compressor with zlib.
+class GzipCompressor : public Compressor {
+ public:
+  /// The compression level.
+  /// Reports are highly redundant,
+  /// so the fastest level is close to the best ratio.
+  static const int kLevel = Z_BEST_SPEED;
+
+  /// @throws StreamError  The zlib stream initialization has failed.
+  GzipCompressor() : stream_() {
+    const int kGzipWindowBits = 15 + 16;  // The gzip header and trailer.
+    if (deflateInit2(&stream_, kLevel, Z_DEFLATED, kGzipWindowBits, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+      throw StreamError("Failed to initialize the gzip compression.");
+    }
+  }
+
+  ~GzipCompressor() override { deflateEnd(&stream_); }
+
+  bool Write(const char* data, std::size_t size, bool finish,
+             std::FILE* file) noexcept override {
+    stream_.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(data));  // Old API.
+    stream_.avail_in = size;
+    do {
+      stream_.next_out = chunk_;
+      stream_.avail_out = kChunkSize;
+      if (deflate(&stream_, finish ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR)
+        return false;
+      std::fwrite(chunk_, 1, kChunkSize - stream_.avail_out, file);
+    } while (stream_.avail_out == 0);
+    assert(stream_.avail_in == 0);
+    return true;
+  }
+
+ private:
+  z_stream stream_;  ///< The deflate stream state.
+};
+
+#ifdef SCRAM_WITH_ZSTD
+/// The Zstandard format compressor.
+class ZstdCompressor : public Compressor {
+ public:
+  /// @throws StreamError  The context allocation has failed.
+  ZstdCompressor() : context_(ZSTD_createCCtx(), &ZSTD_freeCCtx) {
+    if (!context_)
+      throw StreamError("Failed to initialize the zstd compression.");
+  }
+
+  bool Write(const char* data, std::size_t size, bool finish,
+             std::FILE* file) noexcept override {
+    ZSTD_inBuffer input = {data, size, 0};
+    for (;;) {
+      ZSTD_outBuffer output = {chunk_, kChunkSize, 0};
+      std::size_t remaining =
+          ZSTD_compressStream2(context_.get(), &output, &input,
+                               finish ? ZSTD_e_end : ZSTD_e_continue);
+      if (ZSTD_isError(remaining))
+        return false;
+      std::fwrite(chunk_, 1, output.pos, file);
+      if (finish ? remaining == 0 : input.pos == input.size)
+        return true;
+    }
+  }
+
+ private:
+  std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context_;  ///< State.
+};
+#endif
+
+}  // namespace
+
+FileStream::FileStream(std::FILE* file, Compression compression)
+    : file_(file),
+      buffer_(new char[kBufferSize]),
+      pos_(buffer_.get()),
+      end_(buffer_.get() + kBufferSize) {
+  switch (compression) {
+    case Compression::kNone:
+      break;
+    case Compression::kGzip:
+      compressor_ = std::make_unique<GzipCompressor>();
+      break;
+    case Compression::kZstd:
+#ifdef SCRAM_WITH_ZSTD
+      compressor_ = std::make_unique<ZstdCompressor>();
+      break;
+#else
+      throw StreamError("The zstd compression is not supported in this build.");
+#endif
+  }
+}
+
+FileStream::~FileStream() noexcept { close(); }
+
+void FileStream::close() noexcept {
+  if (closed_)
+    return;
+  flush();
+  if (compressor_ && !error_)
+    error_ = !compressor_->Write(nullptr, 0, /*finish=*/true, file_);
+  closed_ = true;
+}
+
+void FileStream::Put(const char* data, std::size_t size) noexcept {
+  assert(!closed_ && "Writing into the closed stream.");
+  if (!compressor_) {
+    std::fwrite(data, 1, size, file_);
+  } else if (!error_) {
+    error_ = !compressor_->Write(data, size, /*finish=*/false, file_);
+  }
+}
+
+}  // namespace detail
+
+}  // namespace scram::xml
@@ -21,10 +21,16 @@
 #pragma once
 
 #include <cassert>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 
 #include <algorithm>
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
 #include <exception>
+#include <memory>
 #include <string>
 
 #include <boost/exception/errinfo_errno.hpp>
@@ -38,6 +44,19 @@ struct StreamError : public Error {
   using Error::Error;
 };
 
+/// Compression formats of the XML output.
+enum class Compression : std::uint8_t { kNone = 0, kGzip, kZstd };
+
+/// String representations of the compression formats in the same order.
+const char* const kCompressionToString[] = {"none", "gzip", "zstd"};
+
+/// Deduces the compression format from the output file extension.
+///
+/// @param[in] file_path  The path to the output file.
+///
+/// @returns kGzip for ".gz", kZstd for ".zst", kNone otherwise.
+Compression CompressionFromPath(const std::string& file_path) noexcept;
+
 namespace detail {  // XML streaming helpers.
 
 const char kIndentChar = ' ';  ///< The whitespace character.
@@ -99,48 +118,131 @@ class Indenter {
   char spaces[kMaxIndent + 1];  ///< The indentation and terminator.
 };
 
-/// Adaptor for stdio FILE stream with write generic interface.
+class Compressor;  // Streaming compressor of the output.
+
+/// Buffered adaptor for stdio FILE stream with write generic interface.
+///
+/// The output is accumulated in a large user-space buffer
+/// and handed over to the FILE stream in big chunks
+/// instead of a library call per character or number.
+/// The chunks are optionally compressed on the way to the file.
 ///
 /// @note Write operations do not return any error code or throw exceptions.
 ///       If any IO errors happen,
-///       the FILE handler contains the error information.
+///       the FILE handler contains the error information
+///       (after the flush).
 class FileStream {
  public:
+  /// The size of the output buffer.
+  static constexpr std::size_t kBufferSize = 1 << 18;
+
+  /// The maximum number of characters in a number representation.
+  static constexpr std::size_t kMaxNumberSize = 32;
+
   /// @param[in] file  The output file stream.
-  explicit FileStream(std::FILE* file) : file_(file) {}
+  /// @param[in] compression  The compression format of the output.
+  ///
+  /// @throws StreamError  The compression is not supported or initialized.
+  explicit FileStream(std::FILE* file,
+                      Compression compression = Compression::kNone);
+
+  /// Closes the stream if it is still open.
+  ~FileStream() noexcept;
+
+  FileStream(const FileStream&) = delete;
+  FileStream& operator=(const FileStream&) = delete;
 
   /// @returns The destination file stream.
   std::FILE* file() { return file_; }
 
+  /// @returns true if the compression of the output has failed.
+  bool error() const { return error_; }
+
+  /// Writes the buffered data into the file stream.
+  void flush() noexcept {
+    Put(buffer_.get(), pos_ - buffer_.get());
+    pos_ = buffer_.get();
+  }
+
+  /// Flushes the buffered data and finishes the compressed stream.
+  ///
+  /// @post No more data can be written.
+  void close() noexcept;
+
+  /// Writes a sequence of characters into the file.
+  ///
+  /// @param[in] data  The characters (not necessarily null-terminated).
+  /// @param[in] size  The number of characters to write.
+  void write(const char* data, std::size_t size) {
+    if (size > static_cast<std::size_t>(end_ - pos_)) {
+      flush();
+      if (size > kBufferSize) {  // Too big for the buffer.
+        Put(data, size);
+        return;
+      }
+    }
+    pos_ = std::copy_n(data, size, pos_);
+  }
+
   /// Writes a value into file.
   /// @{
-  void write(const std::string& value) { write(value.c_str()); }
-  void write(const char* value) { std::fputs(value, file_); }
-  void write(const char value) { std::fputc(value, file_); }
+  void write(const std::string& value) { write(value.data(), value.size()); }
+  void write(const char* value) { write(value, std::strlen(value)); }
+  void write(const char value) {
+    if (pos_ == end_)
+      flush();
+    *pos_++ = value;
+  }
   void write(int value) {
     if (value < 0) {
-      std::fputc('-', file_);
-      value = -value;
+      write('-');
+      write(-static_cast<std::size_t>(value));
+    } else {
+      write(static_cast<std::size_t>(value));
     }
-    write(static_cast<std::size_t>(value));
   }
   void write(std::size_t value) {
-    char temp[20];
-    char* p = temp;
+    char* p = Reserve() + kMaxNumberSize;  // Digits are put backwards.
+    char* last = p;
     do {
-      *p++ = value % 10 + '0';
+      *--p = value % 10 + '0';
       value /= 10;
     } while (value > 0);
-
-    do {
-      std::fputc(*--p, file_);
-    } while (p != temp);
+    pos_ = std::copy(p, last, pos_);
+  }
+  void write(double value) {
+    char* first = Reserve();
+#if defined(__cpp_lib_to_chars)  // The shortest round-trip representation.
+    pos_ = std::to_chars(first, first + kMaxNumberSize, value).ptr;
+#else
+    pos_ = first + std::snprintf(first, kMaxNumberSize, "%g", value);
+#endif
   }
-  void write(double value) { std::fprintf(file_, "%g", value); }
   /// @}
 
  private:
+  /// Makes room in the buffer for a number representation.
+  ///
+  /// @returns The current position in the buffer.
+  char* Reserve() noexcept {
+    if (static_cast<std::size_t>(end_ - pos_) < kMaxNumberSize)
+      flush();
+    return pos_;
+  }
+
+  /// Writes the data into the file through the compressor if any.
+  ///
+  /// @param[in] data  The characters to write.
+  /// @param[in] size  The number of characters.
+  void Put(const char* data, std::size_t size) noexcept;
+
   std::FILE* file_;  ///< The destination file.
+  std::unique_ptr<Compressor> compressor_;  ///< Optional compression.
+  bool error_ = false;  ///< The compression failure indicator.
+  bool closed_ = false;  ///< The stream is finished.
+  std::unique_ptr<char[]> buffer_;  ///< The output buffer.
+  char* pos_;  ///< The end of the buffered data.
+  char* end_;  ///< The end of the buffer.
 };
 
 /// Convenience wrapper to provide C++ stream-like interface.
@@ -352,39 +454,28 @@ class StreamElement {
   void PutValue(bool value) { out_ << (value ? "true" : "false"); }
   void PutValue(const std::string& value) { PutValue(value.c_str()); }
   void PutValue(const char* value) {
-    bool has_special_chars = [value]() mutable {  // 2x faster than strpbrk.
-      for (;; ++value) {
-        switch (*value) {
-          case '\0':
-            return false;
-          case '&':
-          case '<':
-          case '"':
-            return true;
-        }
-      }
-    }();
-
-    if (!has_special_chars) {  // The most common case.
-      out_ << value;
-    } else {
-      for (;; ++value) {
-        switch (*value) {
-          case '\0':
-            return;
-          case '&':
-            out_ << "&amp;";
-            break;
-          case '<':
-            out_ << "&lt;";
-            break;
-          case '"':
-            out_ << "&quot;";
-            break;
-          default:
-            out_ << *value;
-        }
+    // The runs of ordinary characters are written in bulk.
+    for (const char* run = value;; ++value) {
+      const char* escape = nullptr;
+      switch (*value) {
+        case '\0':
+          out_.write(run, value - run);
+          return;
+        case '&':
+          escape = "&amp;";
+          break;
+        case '<':
+          escape = "&lt;";
+          break;
+        case '"':
+          escape = "&quot;";
+          break;
+        default:
+          continue;
       }
+      out_.write(run, value - run);
+      out_ << escape;
+      run = value + 1;
     }
   }
   /// @}
@@ -413,13 +504,17 @@ class Stream {
   ///
   /// @param[in] out  The stream destination.
   /// @param[in] indent  Option to indent output for readability.
+  /// @param[in] compression  The compression format of the output.
   ///
   /// @note This output file has clean error state.
-  explicit Stream(std::FILE* out, bool indent = true)
+  ///
+  /// @throws StreamError  The compression is not supported.
+  explicit Stream(std::FILE* out, bool indent = true,
+                  Compression compression = Compression::kNone)
       : indenter_(indent),
         has_root_(false),
         uncaught_exceptions_(std::uncaught_exceptions()),
-        out_(out) {
+        out_(out, compression) {
     assert(!std::ferror(out) && "Unclean error state in output destination.");
     out_ << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
   }
@@ -428,9 +523,13 @@ class Stream {
   ///
   /// @post The exception is thrown only if no other exception is on flight.
   ~Stream() noexcept(false) {
-    int err = std::ferror(out_.file());
-    if (err && (std::uncaught_exceptions() == uncaught_exceptions_))
+    out_.close();
+    if (std::uncaught_exceptions() != uncaught_exceptions_)
+      return;
+    if (int err = std::ferror(out_.file()))
       SCRAM_THROW(IOError("FILE error on write")) << boost::errinfo_errno(err);
+    if (out_.error())
+      SCRAM_THROW(IOError("Compression error on write"));
   }
 
   /// Creates a root element for the document.
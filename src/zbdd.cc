@@ -23,8 +23,11 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <numeric>
+#include <queue>
 
 #include <boost/range/algorithm.hpp>
+#include <boost/range/algorithm_ext.hpp>
 
 #include "ext/algorithm.h"
 #include "ext/find_iterator.h"
@@ -36,14 +39,23 @@ namespace scram::core {
 /// Runs assertions on ZBDD structure.
 ///
 /// @param[in] full  A flag for full test including submodules.
-#define CHECK_ZBDD(full)      \
-  ClearMarks(root_, full);    \
-  TestStructure(root_, full); \
-  ClearMarks(root_, full)
+#define CHECK_ZBDD(full) TestStructure(root_, full, SetNode::NewMark())
 #else
 #define CHECK_ZBDD(full)  ///< No checks on release.
 #endif
 
+void Zbdd::LogCacheStatistics() const noexcept {
+  auto log_cache = [](const char* name, const auto& table) {
+    LOG(DEBUG4) << name << " table hits/misses: " << table.hits() << "/"
+                << table.misses();
+  };
+  log_cache("AND", and_table_);
+  log_cache("OR", or_table_);
+  log_cache("Subsume", subsume_table_);
+  log_cache("Minimal", minimal_results_);
+  log_cache("Prune", prune_results_);
+}
+
 void Zbdd::Log() noexcept {
   CHECK_ZBDD(false);
   LOG(DEBUG4) << "# of ZBDD nodes created: " << set_id_ - 1;
@@ -52,11 +64,12 @@ void Zbdd::Log() noexcept {
   LOG(DEBUG4) << "# of entries in OR table: " << or_table_.size();
   LOG(DEBUG4) << "# of entries in subsume table: " << subsume_table_.size();
   LOG(DEBUG4) << "# of entries in minimal table: " << minimal_results_.size();
-  ClearMarks(root_, false);
-  LOG(DEBUG4) << "# of SetNodes in ZBDD: " << CountSetNodes(root_);
-  ClearMarks(root_, false);
-  LOG(DEBUG4) << "# of products: " << CountProducts(root_, false);
-  ClearMarks(root_, false);
+  LOG(DEBUG4) << "# of entries in prune table: " << prune_results_.size();
+  LogCacheStatistics();
+  LOG(DEBUG4) << "# of SetNodes in ZBDD: "
+              << CountSetNodes(root_, SetNode::NewMark());
+  LOG(DEBUG4) << "# of products: "
+              << CountProducts(root_, false, SetNode::NewMark());
 }
 
 Zbdd::Zbdd(Bdd* bdd, const Settings& settings) noexcept
@@ -97,6 +110,7 @@ void Zbdd::Analyze(const Pdag* graph) noexcept {
   if (graph)
     ApplySubstitutions(graph->substitutions());
 
+  LogCacheStatistics();
   Freeze();  // Complete cleanup of the memory.
   LOG(DEBUG3) << "G" << module_index_ << " analysis time: " << DUR(zbdd_time);
 }
@@ -108,6 +122,11 @@ Zbdd::Zbdd(const Settings& settings, bool coherent, int module_index) noexcept
       root_(kEmpty_),
       coherent_(coherent),
       module_index_(module_index),
+      and_table_(1000, GetCacheCapacity<ComputeTable>()),
+      or_table_(1000, GetCacheCapacity<ComputeTable>()),
+      minimal_results_(1000, GetCacheCapacity<UnaryCache>()),
+      subsume_table_(1000, GetCacheCapacity<PairCache>()),
+      prune_results_(1000, GetCacheCapacity<PairCache>()),
       set_id_(2) {}
 
 Zbdd::Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
@@ -448,9 +467,9 @@ Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
   if (arg_one->id() == arg_two->id())
     return Prune(arg_one, limit_order);
 
-  VertexPtr& result = and_table_[GetResultKey(arg_one, arg_two, limit_order)];
-  if (result)
-    return result;  // Already computed.
+  Triplet key = GetResultKey(arg_one, arg_two, limit_order);
+  if (auto it = ext::find(and_table_, key))
+    return it->second;  // Already computed.
 
   SetNodePtr set_one = SetNode::Ptr(arg_one);
   SetNodePtr set_two = SetNode::Ptr(arg_two);
@@ -460,9 +479,10 @@ Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
              set_one->index() < set_two->index()) {
     std::swap(set_one, set_two);
   }
-  result = Apply<kAnd>(set_one, set_two, limit_order);
+  VertexPtr result = Apply<kAnd>(set_one, set_two, limit_order);
   assert(result->terminal() ||
          SetNode::Ref(result).max_set_order() <= limit_order);
+  and_table_.emplace(key, result);
   return result;
 }
 
@@ -516,9 +536,9 @@ Zbdd::VertexPtr Zbdd::Apply<kOr>(const VertexPtr& arg_one,
   if (arg_one->id() == arg_two->id())
     return Prune(arg_one, limit_order);
 
-  VertexPtr& result = or_table_[GetResultKey(arg_one, arg_two, limit_order)];
-  if (result)
-    return result;  // Already computed.
+  Triplet key = GetResultKey(arg_one, arg_two, limit_order);
+  if (auto it = ext::find(or_table_, key))
+    return it->second;  // Already computed.
 
   SetNodePtr set_one = SetNode::Ptr(arg_one);
   SetNodePtr set_two = SetNode::Ptr(arg_two);
@@ -528,9 +548,10 @@ Zbdd::VertexPtr Zbdd::Apply<kOr>(const VertexPtr& arg_one,
              set_one->index() < set_two->index()) {
     std::swap(set_one, set_two);
   }
-  result = Apply<kOr>(set_one, set_two, limit_order);
+  VertexPtr result = Apply<kOr>(set_one, set_two, limit_order);
   assert(result->terminal() ||
          SetNode::Ref(result).max_set_order() <= limit_order);
+  or_table_.emplace(key, result);
   return result;
 }
 
@@ -616,19 +637,19 @@ Zbdd::VertexPtr Zbdd::Minimize(const VertexPtr& vertex) noexcept {
   SetNodePtr node = SetNode::Ptr(vertex);
   if (node->minimal())
     return vertex;
-  VertexPtr& result = minimal_results_[vertex->id()];
-  if (result)
-    return result;
+  if (auto it = ext::find(minimal_results_, vertex->id()))
+    return it->second;
   VertexPtr high = Minimize(node->high());
   VertexPtr low = Minimize(node->low());
   high = Subsume(high, low);
   assert(high->id() != low->id() && "Subsume failed!");
   if (high->terminal() && !Terminal<SetNode>::Ref(high).value()) {
-    result = low;  // Reduction rule.
-    return result;
+    minimal_results_.emplace(vertex->id(), low);  // Reduction rule.
+    return low;
   }
-  result = FindOrAddVertex(node, high, low);
-  SetNode::Ref(result).minimal(true);
+  SetNodePtr result = FindOrAddVertex(node, high, low);
+  result->minimal(true);
+  minimal_results_.emplace(vertex->id(), result);
   return result;
 }
 
@@ -638,16 +659,17 @@ Zbdd::VertexPtr Zbdd::Subsume(const VertexPtr& high,
     return Terminal<SetNode>::Ref(low).value() ? kEmpty_ : high;
   if (high->terminal())
     return high;  // No need to reduce terminal sets.
-  VertexPtr& computed = subsume_table_[{high->id(), low->id()}];
-  if (computed)
-    return computed;
+  std::pair<int, int> key{high->id(), low->id()};
+  if (auto it = ext::find(subsume_table_, key))
+    return it->second;
 
   SetNodePtr high_node = SetNode::Ptr(high);
   SetNodePtr low_node = SetNode::Ptr(low);
   if (high_node->order() > low_node->order() ||
       (high_node->order() == low_node->order() &&
        high_node->index() < low_node->index())) {
-    computed = Subsume(high, low_node->low());
+    VertexPtr computed = Subsume(high, low_node->low());
+    subsume_table_.emplace(key, computed);
     return computed;
   }
   VertexPtr subhigh;
@@ -666,14 +688,14 @@ Zbdd::VertexPtr Zbdd::Subsume(const VertexPtr& high,
     sublow = Subsume(high_node->low(), low);
   }
   if (subhigh->terminal() && !Terminal<SetNode>::Ref(subhigh).value()) {
-    computed = sublow;
-    return computed;
+    subsume_table_.emplace(key, sublow);
+    return sublow;
   }
   assert(subhigh->id() != sublow->id());
   SetNodePtr new_high = FindOrAddVertex(high_node, subhigh, sublow);
   new_high->minimal(high_node->minimal());
-  computed = new_high;
-  return computed;
+  subsume_table_.emplace(key, new_high);
+  return new_high;
 }
 
 Zbdd::VertexPtr Zbdd::Prune(const VertexPtr& vertex, int limit_order) noexcept {
@@ -686,15 +708,16 @@ Zbdd::VertexPtr Zbdd::Prune(const VertexPtr& vertex, int limit_order) noexcept {
   if (node->max_set_order() <= limit_order)
     return node;
 
-  VertexPtr& result = prune_results_[{node->id(), limit_order}];
-  if (result)
-    return result;
+  std::pair<int, int> key{node->id(), limit_order};
+  if (auto it = ext::find(prune_results_, key))
+    return it->second;
 
   int limit_high = limit_order - !MayBeUnity(*node);
-  result = GetReducedVertex(node, Prune(node->high(), limit_high),
-                            Prune(node->low(), limit_order));
+  VertexPtr result = GetReducedVertex(node, Prune(node->high(), limit_high),
+                                      Prune(node->low(), limit_order));
   if (!result->terminal())
     SetNode::Ref(result).minimal(node->minimal());
+  prune_results_.emplace(key, result);
   return result;
 }
 
@@ -781,73 +804,359 @@ void Zbdd::ApplySubstitutions(
   root_ = Minimize(root_);
 }
 
-int Zbdd::CountSetNodes(const VertexPtr& vertex) noexcept {
+int Zbdd::CountSetNodes(const VertexPtr& vertex, int mark) noexcept {
   if (vertex->terminal())
     return 0;
   SetNode& node = SetNode::Ref(vertex);
-  if (node.mark())
+  if (node.mark() == mark)
     return 0;
-  node.mark(true);
-  return 1 + CountSetNodes(node.high()) + CountSetNodes(node.low());
+  node.mark(mark);
+  return 1 + CountSetNodes(node.high(), mark) + CountSetNodes(node.low(), mark);
 }
 
-std::int64_t Zbdd::CountProducts(const VertexPtr& vertex,
-                                 bool modules) noexcept {
+std::int64_t Zbdd::CountProducts(const VertexPtr& vertex, bool modules,
+                                 int mark) noexcept {
   if (vertex->terminal())
     return Terminal<SetNode>::Ref(vertex).value();
 
   SetNode& node = SetNode::Ref(vertex);
-  if (node.mark())
+  if (node.mark() == mark)
     return node.count();
-  node.mark(true);
+  node.mark(mark);
   std::int64_t multiplier = 1;  // Multiplier of the module.
   if (modules && node.module()) {
     Zbdd* module = modules_.find(node.index())->second.get();
-    multiplier = module->CountProducts(module->root_, true);
+    multiplier = module->CountProducts(module->root_, true, mark);
   }
-  node.count(multiplier * CountProducts(node.high(), modules) +
-             CountProducts(node.low(), modules));
+  node.count(multiplier * CountProducts(node.high(), modules, mark) +
+             CountProducts(node.low(), modules, mark));
   return node.count();
 }
 
-void Zbdd::ClearMarks(const VertexPtr& vertex, bool modules) noexcept {
+std::size_t Zbdd::size() const {
+  const std::vector<std::int64_t>& counts = distribution();
+  return std::accumulate(counts.begin(), counts.end(), std::int64_t(0));
+}
+
+const std::vector<std::int64_t>& Zbdd::distribution() const {
+  return GetProductDistribution(root_, kSettings_.limit_order());
+}
+
+void Zbdd::GetProduct(std::int64_t index, std::vector<int>* product) const {
+  assert(index >= 0 && index < size() && "The product index is out of range.");
+  product->clear();
+  std::vector<std::int64_t> weights(kSettings_.limit_order() + 1, 1);
+  [[maybe_unused]] std::int64_t residual = GetProduct(
+      root_, index, weights, kSettings_.limit_order(), product);
+  assert(residual == 0 && "Miscounted products.");
+}
+
+std::vector<int> Zbdd::GatherLiterals() const {
+  std::vector<int> literals;
+  std::unordered_map<const SetNode*, int> budgets;
+  GatherLiterals(root_, kSettings_.limit_order(), kSettings_.limit_order(),
+                 &budgets, &literals);
+  return literals;
+}
+
+namespace {
+
+/// @returns The smallest order with products in the distribution.
+/// @returns -1 if there are no products.
+int GetMinOrder(const std::vector<std::int64_t>& distribution) noexcept {
+  auto it = boost::find_if(distribution, [](std::int64_t count) {
+    return count != 0;
+  });
+  return it == distribution.end() ? -1 : it - distribution.begin();
+}
+
+/// @returns The probability of a literal with a variable index.
+double GetLiteralProbability(int index,
+                             const Pdag::IndexMap<double>& p_vars) noexcept {
+  return index > 0 ? p_vars[index] : 1 - p_vars[-index];
+}
+
+/// @returns The total number of weighted products.
+std::int64_t GetWeightedCount(const std::vector<std::int64_t>& distribution,
+                              const std::vector<std::int64_t>& weights,
+                              int shift = 0) noexcept {
+  std::int64_t count = 0;
+  for (int i = 0; i < distribution.size() && i + shift < weights.size(); ++i)
+    count += distribution[i] * weights[i + shift];
+  return count;
+}
+
+}  // namespace
+
+const std::vector<std::int64_t>& Zbdd::GetProductDistribution(
+    const VertexPtr& vertex, int limit_order) const noexcept {
+  static const std::vector<std::int64_t> kBaseCounts = {1};
+  static const std::vector<std::int64_t> kEmptyCounts;
   if (vertex->terminal())
-    return;
+    return Terminal<SetNode>::Ref(vertex).value() ? kBaseCounts : kEmptyCounts;
   SetNode& node = SetNode::Ref(vertex);
-  if (!node.mark())
+  if (node.count())
+    return product_distributions_[node.count() - 1];
+
+  const std::vector<std::int64_t>& high =
+      GetProductDistribution(node.high(), limit_order);
+  const std::vector<std::int64_t>& low =
+      GetProductDistribution(node.low(), limit_order);
+  std::vector<std::int64_t> counts(low);
+  auto add = [&counts](int order, std::int64_t count) {
+    if (counts.size() <= order)
+      counts.resize(order + 1);
+    counts[order] += count;
+  };
+  if (node.module()) {
+    const Zbdd& module = *modules_.find(node.index())->second;
+    const std::vector<std::int64_t>& module_counts =
+        module.GetProductDistribution(module.root_, limit_order);
+    for (int i = 0; i < module_counts.size(); ++i) {
+      for (int j = 0; j < high.size() && i + j <= limit_order; ++j)
+        add(i + j, module_counts[i] * high[j]);
+    }
+  } else {
+    for (int j = 0; j < high.size() && j < limit_order; ++j)
+      add(j + 1, high[j]);
+  }
+  product_distributions_.push_back(std::move(counts));
+  node.count(product_distributions_.size());
+  return product_distributions_.back();
+}
+
+std::int64_t Zbdd::GetProduct(const VertexPtr& vertex, std::int64_t index,
+                              const std::vector<std::int64_t>& weights,
+                              int limit_order,
+                              std::vector<int>* product) const noexcept {
+  if (vertex->terminal()) {
+    assert(Terminal<SetNode>::Ref(vertex).value() && "Unexpected Empty set.");
+    assert(index < weights.front() && "Miscounted product completions.");
+    return index;
+  }
+  const SetNode& node = SetNode::Ref(vertex);
+  const std::vector<std::int64_t>& high =
+      GetProductDistribution(node.high(), limit_order);
+  if (node.module()) {
+    const Zbdd& module = *modules_.find(node.index())->second;
+    const std::vector<std::int64_t>& module_counts =
+        module.GetProductDistribution(module.root_, limit_order);
+    // The module products are the outer loop of the high branch iteration.
+    std::vector<std::int64_t> module_weights(weights.size());
+    for (int i = 0; i < module_weights.size(); ++i)
+      module_weights[i] = GetWeightedCount(high, weights, i);
+    std::int64_t num_high = GetWeightedCount(module_counts, module_weights);
+    if (index < num_high) {
+      int start = product->size();
+      index = module.GetProduct(module.root_, index, module_weights,
+                                limit_order, product);
+      std::vector<std::int64_t> high_weights(
+          weights.begin() + (product->size() - start), weights.end());
+      return GetProduct(node.high(), index, high_weights, limit_order,
+                        product);
+    }
+    index -= num_high;
+  } else {
+    std::int64_t num_high = GetWeightedCount(high, weights, 1);
+    if (index < num_high) {
+      product->push_back(node.index());
+      std::vector<std::int64_t> high_weights(weights.begin() + 1,
+                                             weights.end());
+      return GetProduct(node.high(), index, high_weights, limit_order,
+                        product);
+    }
+    index -= num_high;
+  }
+  return GetProduct(node.low(), index, weights, limit_order, product);
+}
+
+void Zbdd::GatherLiterals(const VertexPtr& vertex, int budget, int limit_order,
+                          std::unordered_map<const SetNode*, int>* budgets,
+                          std::vector<int>* literals) const noexcept {
+  if (vertex->terminal())
     return;
-  node.mark(false);
-  if (modules && node.module()) {
-    Zbdd* module = modules_.find(node.index())->second.get();
-    module->ClearMarks(module->root_, true);
+  const SetNode& node = SetNode::Ref(vertex);
+  if (auto [it, inserted] = budgets->emplace(&node, budget); !inserted) {
+    if (it->second >= budget)
+      return;
+    it->second = budget;
+  }
+  int min_high = GetMinOrder(GetProductDistribution(node.high(), limit_order));
+  if (min_high >= 0) {
+    if (node.module()) {
+      const Zbdd& module = *modules_.find(node.index())->second;
+      int min_module = GetMinOrder(
+          module.GetProductDistribution(module.root_, limit_order));
+      if (min_module >= 0 && min_module + min_high <= budget) {
+        module.GatherLiterals(module.root_, budget - min_high, limit_order,
+                              budgets, literals);
+        GatherLiterals(node.high(), budget - min_module, limit_order, budgets,
+                       literals);
+      }
+    } else if (min_high < budget) {
+      literals->push_back(node.index());
+      GatherLiterals(node.high(), budget - 1, limit_order, budgets, literals);
+    }
+  }
+  GatherLiterals(node.low(), budget, limit_order, budgets, literals);
+}
+
+std::vector<std::vector<int>>
+Zbdd::GetTopProducts(int k, const Pdag::IndexMap<double>& p_vars) const {
+  /// A partial product with the pending sub-graphs to complete it.
+  struct Path {
+    double bound;  ///< The max probability of the complete product.
+    double p;  ///< The probability of the partial product.
+    std::vector<int> product;  ///< The literals of the partial product.
+    /// The sub-graphs with their owner ZBDD to draw products from.
+    std::vector<std::pair<const Zbdd*, const VertexPtr*>> pending;
+  };
+  auto compare = [](const Path& lhs, const Path& rhs) {
+    return lhs.bound < rhs.bound;
+  };
+  std::priority_queue<Path, std::vector<Path>, decltype(compare)> queue(
+      compare);
+  std::unordered_map<const SetNode*, double> bounds;
+  int limit_order = kSettings_.limit_order();
+  auto push = [&queue, &bounds, &p_vars, limit_order](Path path) {
+    path.bound = path.p;
+    int min_order = path.product.size();
+    for (const auto& [zbdd, vertex] : path.pending) {
+      int min_pending =
+          GetMinOrder(zbdd->GetProductDistribution(*vertex, limit_order));
+      if (min_pending < 0)
+        return;  // No products within the cut-off order.
+      min_order += min_pending;
+      path.bound *= zbdd->GetProbabilityBound(*vertex, p_vars, &bounds);
+    }
+    if (min_order > limit_order)
+      return;
+    boost::remove_erase_if(path.pending, [](const auto& sub_graph) {
+      return (*sub_graph.second)->terminal();  // Only the Base set is left.
+    });
+    queue.push(std::move(path));
+  };
+
+  std::vector<std::vector<int>> products;
+  push({0, 1, {}, {{this, &root_}}});
+  while (!queue.empty() && products.size() < k) {
+    Path path = queue.top();
+    queue.pop();
+    if (path.pending.empty()) {
+      products.push_back(std::move(path.product));
+      continue;
+    }
+    auto [zbdd, vertex] = path.pending.back();
+    path.pending.pop_back();
+    const SetNode& node = SetNode::Ref(*vertex);
+    Path high = path;
+    high.pending.emplace_back(zbdd, &node.high());
+    if (node.module()) {
+      const Zbdd& module = *zbdd->modules_.find(node.index())->second;
+      high.pending.emplace_back(&module, &module.root_);
+    } else {
+      high.product.push_back(node.index());
+      high.p *= GetLiteralProbability(node.index(), p_vars);
+    }
+    push(std::move(high));
+    path.pending.emplace_back(zbdd, &node.low());
+    push(std::move(path));
+  }
+  return products;
+}
+
+double Zbdd::GetProbabilitySum(const Pdag::IndexMap<double>& p_vars) const {
+  std::unordered_map<const SetNode*, std::vector<double>> distributions;
+  const std::vector<double>& p_orders = GetProbabilityDistribution(
+      root_, kSettings_.limit_order(), p_vars, &distributions);
+  return std::accumulate(p_orders.begin(), p_orders.end(), 0.0);
+}
+
+double Zbdd::GetProbabilityBound(
+    const VertexPtr& vertex, const Pdag::IndexMap<double>& p_vars,
+    std::unordered_map<const SetNode*, double>* bounds) const noexcept {
+  if (vertex->terminal())
+    return Terminal<SetNode>::Ref(vertex).value();
+  const SetNode& node = SetNode::Ref(vertex);
+  if (auto it = bounds->find(&node); it != bounds->end())
+    return it->second;
+  double p_high = GetProbabilityBound(node.high(), p_vars, bounds);
+  if (node.module()) {
+    const Zbdd& module = *modules_.find(node.index())->second;
+    p_high *= module.GetProbabilityBound(module.root_, p_vars, bounds);
+  } else {
+    p_high *= GetLiteralProbability(node.index(), p_vars);
+  }
+  double bound =
+      std::max(p_high, GetProbabilityBound(node.low(), p_vars, bounds));
+  bounds->emplace(&node, bound);
+  return bound;
+}
+
+const std::vector<double>& Zbdd::GetProbabilityDistribution(
+    const VertexPtr& vertex, int limit_order,
+    const Pdag::IndexMap<double>& p_vars,
+    std::unordered_map<const SetNode*, std::vector<double>>* distributions)
+    const noexcept {
+  static const std::vector<double> kBaseSum = {1};
+  static const std::vector<double> kEmptySum;
+  if (vertex->terminal())
+    return Terminal<SetNode>::Ref(vertex).value() ? kBaseSum : kEmptySum;
+  const SetNode& node = SetNode::Ref(vertex);
+  if (auto it = distributions->find(&node); it != distributions->end())
+    return it->second;
+
+  const std::vector<double>& high =
+      GetProbabilityDistribution(node.high(), limit_order, p_vars,
+                                 distributions);
+  std::vector<double> sums(GetProbabilityDistribution(
+      node.low(), limit_order, p_vars, distributions));
+  auto add = [&sums](int order, double p) {
+    if (sums.size() <= order)
+      sums.resize(order + 1);
+    sums[order] += p;
+  };
+  if (node.module()) {
+    const Zbdd& module = *modules_.find(node.index())->second;
+    const std::vector<double>& module_sums = module.GetProbabilityDistribution(
+        module.root_, limit_order, p_vars, distributions);
+    for (int i = 0; i < module_sums.size(); ++i) {
+      for (int j = 0; j < high.size() && i + j <= limit_order; ++j)
+        add(i + j, module_sums[i] * high[j]);
+    }
+  } else {
+    double p = GetLiteralProbability(node.index(), p_vars);
+    for (int j = 0; j < high.size() && j < limit_order; ++j)
+      add(j + 1, p * high[j]);
   }
-  ClearMarks(node.high(), modules);
-  ClearMarks(node.low(), modules);
+  return distributions->emplace(&node, std::move(sums)).first->second;
 }
 
-void Zbdd::ClearCounts(const VertexPtr& vertex, bool modules) noexcept {
+void Zbdd::ClearCounts(const VertexPtr& vertex, bool modules,
+                       int mark) noexcept {
   if (vertex->terminal())
     return;
   SetNode& node = SetNode::Ref(vertex);
-  if (node.mark())
+  if (node.mark() == mark)
     return;
-  node.mark(true);
+  node.mark(mark);
   node.count(0);
   if (modules && node.module()) {
     Zbdd* module = modules_.find(node.index())->second.get();
-    module->ClearCounts(module->root_, true);
+    module->ClearCounts(module->root_, true, mark);
   }
-  ClearCounts(node.high(), modules);
-  ClearCounts(node.low(), modules);
+  ClearCounts(node.high(), modules, mark);
+  ClearCounts(node.low(), modules, mark);
 }
 
-void Zbdd::TestStructure(const VertexPtr& vertex, bool modules) noexcept {
+void Zbdd::TestStructure(const VertexPtr& vertex, bool modules,
+                         int mark) noexcept {
   if (vertex->terminal())
     return;
   SetNode& node = SetNode::Ref(vertex);
-  if (node.mark())
+  if (node.mark() == mark)
     return;
-  node.mark(true);
+  node.mark(mark);
   assert(node.index() && "Illegal index for a node.");
   assert(node.order() && "Improper order for nodes.");
   assert(node.high() && node.low() && "Malformed node high/low pointers.");
@@ -874,10 +1183,10 @@ void Zbdd::TestStructure(const VertexPtr& vertex, bool modules) noexcept {
   if (modules && node.module()) {
     Zbdd* module = modules_.find(node.index())->second.get();
     assert(!module->root_->terminal() && "Terminal modules must be removed.");
-    module->TestStructure(module->root_, true);
+    module->TestStructure(module->root_, true, mark);
   }
-  TestStructure(node.high(), modules);
-  TestStructure(node.low(), modules);
+  TestStructure(node.high(), modules, mark);
+  TestStructure(node.low(), modules, mark);
 }
 
 namespace zbdd {
@@ -20,9 +20,11 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 #include <array>
+#include <deque>
 #include <map>
 #include <memory>
 #include <unordered_map>
@@ -354,9 +356,54 @@ class Zbdd : private boost::noncopyable {
 
   /// @returns The number of *products* in the ZBDD.
   ///
-  /// @note This is not cheap.
-  ///       The complexity is O(N) on the number of *sets* in ZBDD.
-  std::size_t size() const { return std::distance(begin(), end()); }
+  /// @note The first call counts products over ZBDD nodes (not sets).
+  ///       The complexity is O(N * L^2)
+  ///       on the number of nodes and the limit order.
+  std::size_t size() const;
+
+  /// @returns The number of products by their order (index).
+  ///          The zero order is reserved for the Base set.
+  ///
+  /// @note The counts are computed lazily and cached per SetNode.
+  const std::vector<std::int64_t>& distribution() const;
+
+  /// Retrieves a product by its position in the iteration order
+  /// without enumerating the preceding products.
+  ///
+  /// @param[in] index  The position of the product in [0, size()).
+  /// @param[out] product  The container for the indices of the product.
+  ///
+  /// @post The product is identical to the dereferenced iterator
+  ///       advanced 'index' times from the beginning.
+  void GetProduct(std::int64_t index, std::vector<int>* product) const;
+
+  /// Collects literals appearing in the products
+  /// without enumerating the products.
+  ///
+  /// @returns Indices of the literals in the products (may repeat).
+  std::vector<int> GatherLiterals() const;
+
+  /// Finds the most probable products
+  /// with the best-first search over the ZBDD paths
+  /// guided by the max probabilities of the sub-graph products.
+  ///
+  /// @param[in] k  The max number of products to find.
+  /// @param[in] p_vars  Probabilities of the variables.
+  ///
+  /// @returns Up to k products in non-increasing order of probabilities.
+  ///
+  /// @note Only the most probable paths are expanded
+  ///       instead of the enumeration of all the products.
+  std::vector<std::vector<int>>
+  GetTopProducts(int k, const Pdag::IndexMap<double>& p_vars) const;
+
+  /// Sums the probabilities of the products
+  /// without enumerating the products.
+  ///
+  /// @param[in] p_vars  Probabilities of the variables.
+  ///
+  /// @returns The sum of the product probabilities.
+  double GetProbabilitySum(const Pdag::IndexMap<double>& p_vars) const;
 
   /// @returns true for ZBDD with no products.
   bool empty() const { return begin() == end(); }
@@ -364,6 +411,9 @@ class Zbdd : private boost::noncopyable {
   /// @returns true if the ZBDD represents a base/unity set.
   bool base() const { return root_ == kBase_; }
 
+  /// @returns Analysis setting with this ZBDD.
+  const Settings& settings() const { return kSettings_; }
+
  protected:
   /// The common constructor to initialize member variables.
   ///
@@ -381,9 +431,6 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] vertex  A vertex already registered in this ZBDD.
   void root(const VertexPtr& vertex) { root_ = vertex; }
 
-  /// @returns Analysis setting with this ZBDD.
-  const Settings& settings() const { return kSettings_; }
-
   /// @returns A set of registered and fully processed modules;
   const std::map<int, std::unique_ptr<Zbdd>>& modules() const {
     return modules_;
@@ -523,6 +570,9 @@ class Zbdd : private boost::noncopyable {
   void ApplySubstitutions(
       const std::vector<Pdag::Substitution>& substitutions) noexcept;
 
+  /// Logs the hit/miss statistics of the memoization tables.
+  void LogCacheStatistics() const noexcept;
+
   /// Clears all memoization tables.
   void ClearTables() noexcept {
     and_table_.clear();
@@ -536,6 +586,8 @@ class Zbdd : private boost::noncopyable {
   /// Releases all possible memory from memoization and unique tables.
   ///
   /// @pre No more graph modifications after the freeze.
+  ///
+  /// @post Node counts are clear for caching of product distributions.
   void Freeze() noexcept {
     unique_table_.Release();
     Zbdd::ClearTables();
@@ -543,6 +595,8 @@ class Zbdd : private boost::noncopyable {
     or_table_.reserve(0);
     minimal_results_.reserve(0);
     subsume_table_.reserve(0);
+    prune_results_.reserve(0);
+    ClearCounts(root_, false, SetNode::NewMark());
   }
 
   /// Joins a ZBDD representing a module gate.
@@ -567,7 +621,24 @@ class Zbdd : private boost::noncopyable {
 
  private:
   using SetNodeWeakPtr = WeakIntrusivePtr<SetNode>;  ///< Pointer for tables.
-  using ComputeTable = TripletTable<VertexPtr>;  ///< General computation table.
+  /// General computation table.
+  using ComputeTable = CacheTable<VertexPtr, Triplet, TripletHash>;
+  /// Computation table for operations with two integer arguments.
+  using PairCache = CacheTable<VertexPtr>;
+  /// Computation table for unary operations.
+  using UnaryCache = CacheTable<VertexPtr, int>;
+
+  /// The memory budget in bytes for each memoization table.
+  /// The tables are lossy (direct-mapped) beyond this limit.
+  static constexpr std::size_t kCacheBudget_ = 64 << 20;
+
+  /// @tparam Table  The memoization table type.
+  ///
+  /// @returns The maximum number of entries in the table within the budget.
+  template <class Table>
+  static constexpr int GetCacheCapacity() noexcept {
+    return kCacheBudget_ / sizeof(typename Table::value_type);
+  }
   /// Module entry in the tables with its original gate index.
   using ModuleEntry = std::pair<const int, std::unique_ptr<Zbdd>>;
 
@@ -800,51 +871,104 @@ class Zbdd : private boost::noncopyable {
   /// excluding the nodes in the modules.
   ///
   /// @param[in] vertex  The root vertex to start counting.
+  /// @param[in] mark  The new traversal mark.
   ///
   /// @returns The total number of SetNode vertices
   ///          including vertices in modules.
-  ///
-  /// @pre SetNode marks are clear (false).
-  int CountSetNodes(const VertexPtr& vertex) noexcept;
+  int CountSetNodes(const VertexPtr& vertex, int mark) noexcept;
 
   /// Counts the total number of sets in ZBDD.
   ///
   /// @param[in] vertex  The root vertex of ZBDD.
   /// @param[in] modules  Unroll sets with modules.
+  /// @param[in] mark  The new traversal mark.
   ///
   /// @returns The number of products in ZBDD.
-  ///
-  /// @pre SetNode marks are clear (false).
-  std::int64_t CountProducts(const VertexPtr& vertex, bool modules) noexcept;
+  std::int64_t CountProducts(const VertexPtr& vertex, bool modules,
+                             int mark) noexcept;
 
-  /// Cleans up non-terminal vertex marks
-  /// by setting them to "false".
+  /// Counts products by their order (index) with the cut-off.
+  /// The results are cached in the frozen ZBDD
+  /// with SetNode counts referencing the cache slots.
   ///
-  /// @param[in] vertex  The root vertex of the graph.
-  /// @param[in] modules  Clear marks in modules as well.
-  ///
-  /// @pre The graph is marked "true" contiguously.
-  void ClearMarks(const VertexPtr& vertex, bool modules) noexcept;
+  /// @param[in] vertex  The root vertex of the ZBDD.
+  /// @param[in] limit_order  The cut-off order of the host ZBDD products.
+  ///
+  /// @returns The number of products by order from the vertex.
+  ///          The size of the result never exceeds (limit_order + 1).
+  ///
+  /// @pre The ZBDD is frozen.
+  /// @pre Module products are counted with the same cut-off order.
+  const std::vector<std::int64_t>& GetProductDistribution(
+      const VertexPtr& vertex, int limit_order) const noexcept;
+
+  /// Finds a product by its position in the weighted iteration order.
+  ///
+  /// @param[in] vertex  The root vertex of the (sub-)ZBDD.
+  /// @param[in] index  The position of the product in the weighted order.
+  /// @param[in] weights  The number of host product completions
+  ///                     for each order of the vertex product.
+  /// @param[in] limit_order  The cut-off order of the host ZBDD products.
+  /// @param[in,out] product  The product to append the literals to.
+  ///
+  /// @returns The residual position within the host product completions.
+  std::int64_t GetProduct(const VertexPtr& vertex, std::int64_t index,
+                          const std::vector<std::int64_t>& weights,
+                          int limit_order,
+                          std::vector<int>* product) const noexcept;
+
+  /// Collects literals of the products restricted by the order budget.
+  ///
+  /// @param[in] vertex  The root vertex of the (sub-)ZBDD.
+  /// @param[in] budget  The max order of the vertex products.
+  /// @param[in] limit_order  The cut-off order of the host ZBDD products.
+  /// @param[in,out] budgets  The max budgets of the visited nodes.
+  /// @param[in,out] literals  The collection of literal indices.
+  void GatherLiterals(const VertexPtr& vertex, int budget, int limit_order,
+                      std::unordered_map<const SetNode*, int>* budgets,
+                      std::vector<int>* literals) const noexcept;
+
+  /// Computes the max probability of products in the sub-graph
+  /// regardless of the cut-off order.
+  ///
+  /// @param[in] vertex  The root vertex of the (sub-)ZBDD.
+  /// @param[in] p_vars  Probabilities of the variables.
+  /// @param[in,out] bounds  The memoized max probabilities of the nodes.
+  ///
+  /// @returns The upper bound for the product probabilities.
+  double GetProbabilityBound(
+      const VertexPtr& vertex, const Pdag::IndexMap<double>& p_vars,
+      std::unordered_map<const SetNode*, double>* bounds) const noexcept;
+
+  /// Sums the probabilities of products by their order.
+  ///
+  /// @param[in] vertex  The root vertex of the (sub-)ZBDD.
+  /// @param[in] limit_order  The cut-off order of the host ZBDD products.
+  /// @param[in] p_vars  Probabilities of the variables.
+  /// @param[in,out] distributions  The memoized sums of the nodes.
+  ///
+  /// @returns The sums of product probabilities indexed by the order.
+  const std::vector<double>& GetProbabilityDistribution(
+      const VertexPtr& vertex, int limit_order,
+      const Pdag::IndexMap<double>& p_vars,
+      std::unordered_map<const SetNode*, std::vector<double>>* distributions)
+      const noexcept;
 
   /// Cleans up non-terminal vertex count fields
   /// by setting them to 0.
   ///
   /// @param[in] vertex  The root vertex of the graph.
   /// @param[in] modules  Clear counts in modules as well.
-  ///
-  /// @pre The graph node marks are clear.
-  ///
-  /// @post Traversed marks are set to 'true'.
-  void ClearCounts(const VertexPtr& vertex, bool modules) noexcept;
+  /// @param[in] mark  The new traversal mark.
+  void ClearCounts(const VertexPtr& vertex, bool modules, int mark) noexcept;
 
   /// Checks ZBDD graphs for errors in the structure.
   /// Errors are assertions that fail at runtime.
   ///
   /// @param[in] vertex  The root vertex of ZBDD.
   /// @param[in] modules  Test modules as well.
-  ///
-  /// @pre SetNode marks are clear (false).
-  void TestStructure(const VertexPtr& vertex, bool modules) noexcept;
+  /// @param[in] mark  The new traversal mark.
+  void TestStructure(const VertexPtr& vertex, bool modules, int mark) noexcept;
 
   const Settings kSettings_;  ///< Analysis settings.
   VertexPtr root_;  ///< The root vertex of ZBDD.
@@ -855,25 +979,32 @@ class Zbdd : private boost::noncopyable {
   /// The key consists of (index, id_high, id_low) triplet.
   UniqueTable<SetNode> unique_table_;
 
-  /// Table of processed computations over sets.
+  /// Bounded computed tables of processed computations over sets.
   /// The argument sets are recorded with their IDs (not vertex indices).
   /// In order to keep only unique computations,
   /// the argument IDs must be ordered.
   /// The key is {min_id, max_id, max_order}.
+  ///
+  /// @note The IDs are never reused, so stale entries cannot alias.
+  ///       Lost entries are simply recomputed.
   /// @{
   ComputeTable and_table_;
   ComputeTable or_table_;
   /// @}
 
   /// Memoization of minimal ZBDD vertices.
-  std::unordered_map<int, VertexPtr> minimal_results_;
+  UnaryCache minimal_results_;
   /// The results of subsume operations over sets.
-  PairTable<VertexPtr> subsume_table_;
+  PairCache subsume_table_;
   /// The results of pruning operations.
-  PairTable<VertexPtr> prune_results_;
+  PairCache prune_results_;
 
   std::map<int, std::unique_ptr<Zbdd>> modules_;  ///< Module graphs.
   int set_id_;  ///< Identification assignment for new set graphs.
+
+  /// Cached product distributions of the frozen ZBDD nodes.
+  /// The SetNode count is the 1-based slot in this container.
+  mutable std::deque<std::vector<std::int64_t>> product_distributions_;
 };
 
 namespace zbdd {
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batch.h"
+
+#include <fstream>
+
+#include <catch2/catch.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include "env.h"
+#include "error.h"
+
+namespace fs = boost::filesystem;
+
+namespace scram::test {
+
+TEST_CASE("BatchTest.SharedDocuments", "[batch]") {
+  static xml::Validator validator(env::report_schema());
+  fs::path unique_name = "scram_batch_test-" + fs::unique_path().string();
+  fs::path output_dir = fs::temp_directory_path() / unique_name;
+  fs::create_directory(output_dir);
+  std::vector<std::string> projects = {
+      "tests/input/fta/full_configuration.xml",
+      "tests/input/fta/pi_configuration.xml",
+      "tests/input/fta/invalid_configuration.xml"};
+  Batch batch(2);
+  CHECK(batch.Run(projects, output_dir.string()) == 1);
+  CHECK(batch.documents().size() == 1);
+  for (const char* report :
+       {"full_configuration.xml", "pi_configuration.xml"}) {
+    INFO(report);
+    REQUIRE(fs::exists(output_dir / report));
+    CHECK_NOTHROW(xml::Document((output_dir / report).string(), &validator));
+  }
+  CHECK_FALSE(fs::exists(output_dir / "invalid_configuration.xml"));
+  fs::remove_all(output_dir);
+}
+
+// The included files are not covered by the content hashes.
+TEST_CASE("BatchTest.IncludedDocuments", "[batch]") {
+  fs::path unique_name = "scram_batch_test-" + fs::unique_path().string();
+  fs::path dir = fs::temp_directory_path() / unique_name;
+  fs::create_directory(dir);
+  auto write = [&dir](const char* file, const std::string& content) {
+    std::ofstream(dir / file) << content;
+  };
+  auto included_name = [](const xml::Document& document) {
+    return std::string(document.root().child()->attribute("name"));
+  };
+  write("main.xml",
+        R"(<opsa-mef xmlns:xi="http://www.w3.org/2001/XInclude">)"
+        R"(<xi:include href="part.xml"/></opsa-mef>)");
+  write("part.xml", R"(<define-parameter name="a"/>)");
+  xml::DocumentCache cache;
+  std::string main_file = (dir / "main.xml").string();
+  CHECK(included_name(*cache.Get(main_file, nullptr)) == "a");
+  write("part.xml", R"(<define-parameter name="b"/>)");
+  CHECK(included_name(*cache.Get(main_file, nullptr)) == "b");
+  CHECK(cache.size() == 0);
+  fs::remove_all(dir);
+}
+
+TEST_CASE("BatchTest.InvalidSetup", "[batch]") {
+  CHECK_THROWS_AS(Batch(0), SettingsError);
+  CHECK_THROWS_AS(Batch(1).Run({"tests/input/fta/full_configuration.xml",
+                                "tests/input/fta/full_configuration.xml"},
+                               "."),
+                  IOError);
+}
+
+}  // namespace scram::test
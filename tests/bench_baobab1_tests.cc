@@ -53,6 +53,29 @@ TEST_P(RiskAnalysisTest, Baobab1L8) {
   EXPECT_EQ(distr, ProductDistribution());
 }
 
+TEST_P(RiskAnalysisTest, Baobab1L8NoOptimizationPasses) {
+  std::vector<std::string> input_files = {
+      "input/Baobab/baobab1.xml", "input/Baobab/baobab1-basic-events.xml"};
+  settings.limit_order(8).preprocessing_passes("");
+  ASSERT_NO_THROW(ProcessInputFiles(input_files));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_EQ(25892, products().size());
+  std::vector<int> distr = {0, 1, 1, 70, 400, 2212, 14748, 8460};
+  EXPECT_EQ(distr, ProductDistribution());
+}
+
+TEST_P(RiskAnalysisTest, Baobab1L8AutoPreprocessing) {
+  std::vector<std::string> input_files = {
+      "input/Baobab/baobab1.xml", "input/Baobab/baobab1-basic-events.xml"};
+  settings.limit_order(8).preprocessing_policy("auto").preprocessing_passes(
+      "decomposition,boolean-optimization,coalescence,merge-common-args");
+  ASSERT_NO_THROW(ProcessInputFiles(input_files));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_EQ(25892, products().size());
+  std::vector<int> distr = {0, 1, 1, 70, 400, 2212, 14748, 8460};
+  EXPECT_EQ(distr, ProductDistribution());
+}
+
 TEST_P(RiskAnalysisTest, Baobab1L4Importance) {
   std::vector<std::string> input_files = {
       "input/Baobab/baobab1.xml", "input/Baobab/baobab1-basic-events.xml"};
@@ -17,6 +17,9 @@
 
 #include "risk_analysis_tests.h"
 
+#include <cmath>
+#include <map>
+
 namespace scram::core::test {
 
 // Benchmark Tests for BSCU fault tree from XFTA.
@@ -51,6 +54,76 @@ TEST_P(RiskAnalysisTest, BSCU) {
     EXPECT_NEAR(0.117, mean(), 5e-3);
     EXPECT_NEAR(0.183, sigma(), 5e-3);
   }
+  // The precision is estimated only for sequential sampling.
+  CHECK_FALSE(std::isfinite(
+      analysis->results().front().uncertainty_analysis->precision()));
+}
+
+// Sequential sampling stops early at the target precision.
+TEST_P(RiskAnalysisTest, BSCUSequential) {
+  std::string tree_input = "input/BSCU/BSCU.xml";
+  settings.uncertainty_analysis(true);
+  settings.num_trials(1e6).target_precision(0.05);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  const auto& result = *analysis->results().front().uncertainty_analysis;
+  CHECK(result.num_trials() < 1e6);
+  CHECK(result.precision() <= 0.05);
+  if (settings.approximation() == Approximation::kRareEvent) {
+    EXPECT_NEAR(0.137, mean(), 1e-2);
+  } else {
+    EXPECT_NEAR(0.117, mean(), 1e-2);
+  }
+}
+
+// Stratified and quasi-random sampling converge with fewer trials.
+TEST_P(RiskAnalysisTest, BSCUSampling) {
+  std::string tree_input = "input/BSCU/BSCU.xml";
+  settings.uncertainty_analysis(true);
+  settings.num_trials(1000);
+  for (Sampling sampling : {Sampling::kLatinHypercube, Sampling::kSobol}) {
+    settings.sampling(sampling);
+    ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+    ASSERT_NO_THROW(analysis->Analyze());
+    if (settings.approximation() == Approximation::kRareEvent) {
+      EXPECT_NEAR(0.134, mean(), 2e-3);
+    } else {
+      EXPECT_NEAR(0.115, mean(), 2e-3);
+    }
+  }
+}
+
+// The Sobol indices of the uncertain basic events.
+TEST_P(RiskAnalysisTest, BSCUSensitivity) {
+  std::string tree_input = "input/BSCU/BSCU.xml";
+  settings.sensitivity_analysis(true);
+  settings.num_trials(5000).seed(42);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  const auto& result = *analysis->results().front().sensitivity_analysis;
+  CHECK(result.variance() > 0);
+  REQUIRE(result.indices().size() == 8);
+  std::map<std::string, const SensitivityRecord*> records;
+  for (const SensitivityRecord& entry : result.indices()) {
+    INFO("event: " << entry.event.id());
+    CHECK(entry.total >= 0);
+    CHECK(entry.total <= 1.1);
+    CHECK(entry.first_order <= entry.total + 0.1);
+    records.emplace(entry.event.id(), &entry);
+  }
+  // The electronic failures share the failure rate parameter.
+  const SensitivityRecord& electronic = *records["System1ElectronicFailure"];
+  CHECK(records["System2ElectronicFailure"]->total == electronic.total);
+  const SensitivityRecord& power = *records["LossOfSystem1PowerSupply"];
+  if (settings.approximation() == Approximation::kRareEvent) {
+    CHECK(electronic.total == Approx(0.70).margin(0.1));
+    CHECK(power.total == Approx(0.29).margin(0.1));
+  } else {
+    CHECK(electronic.total == Approx(0.77).margin(0.1));
+    CHECK(power.total == Approx(0.23).margin(0.1));
+  }
+  CHECK(electronic.first_order == Approx(electronic.total).margin(0.15));
+  CHECK(records["ValidityMonitorFailure"]->total < 0.05);
 }
 
 }  // namespace scram::core::test
@@ -38,4 +38,20 @@ TEST_P(RiskAnalysisTest, ne574) {
   EXPECT_EQ(mcs, products());
 }
 
+// The top-level modules of this tree are preprocessed in parallel.
+TEST_P(RiskAnalysisTest, ne574ParallelPreprocessing) {
+  std::string tree_input = "input/ne574/ne574.xml";
+  settings.probability_analysis(true);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  std::set<std::set<std::string>> serial_products = products();
+  double serial_p_total = p_total();
+
+  settings.num_threads(4);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_EQ(serial_products, products());
+  EXPECT_DOUBLE_EQ(serial_p_total, p_total());
+}
+
 }  // namespace scram::core::test
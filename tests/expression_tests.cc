@@ -583,6 +583,57 @@ TEST_CASE("ExpressionTest.Histogram", "[mef::expression]") {
   CHECK_FALSE(dev->Sample() == sampled_value);
 }
 
+// Samples placed with the inverse distribution functions.
+TEST_CASE("ExpressionTest.DeviateQuantile", "[mef::expression]") {
+  OpenExpression min(1);
+  OpenExpression max(5);
+  UniformDeviate uniform(&min, &max);
+  uniform.quantile(0.25);
+  CHECK(uniform.Sample() == Approx(2));
+
+  OpenExpression mean(10);
+  OpenExpression sigma(2);
+  NormalDeviate normal(&mean, &sigma);
+  normal.quantile(0.975);
+  CHECK(normal.Sample() == Approx(10 + 1.959964 * 2));
+  normal.Reset();
+  normal.quantile(0.5);
+  CHECK(normal.Sample() == Approx(10));
+
+  OpenExpression mu(0);
+  OpenExpression scale(1);
+  LognormalDeviate lognormal(&mu, &scale);
+  lognormal.quantile(0.5);
+  CHECK(lognormal.Sample() == Approx(1));
+
+  OpenExpression b0(0);
+  OpenExpression b1(1);
+  OpenExpression b2(3);
+  OpenExpression w1(2);
+  OpenExpression w2(1);
+  Histogram histogram({&b0, &b1, &b2}, {&w1, &w2});  // Masses 2/3 and 1/3.
+  histogram.quantile(0.25);
+  CHECK(histogram.Sample() == Approx(0.375));
+  histogram.Reset();
+  histogram.quantile(0.75);
+  CHECK(histogram.Sample() == Approx(1.5));
+  // The quantile function agrees with the mean of the distribution.
+  const int kNumPoints = 1000;
+  double sum = 0;
+  for (int i = 0; i < kNumPoints; ++i) {
+    histogram.Reset();
+    histogram.quantile((i + 0.5) / kNumPoints);
+    sum += histogram.Sample();
+  }
+  CHECK(sum / kNumPoints == Approx(histogram.value()));
+
+  histogram.Reset();
+  histogram.quantile(0);  // Back to pseudo-random draws.
+  double sampled_value = histogram.Sample();
+  CHECK(sampled_value >= 0);
+  CHECK(sampled_value <= 3);
+}
+
 // Test for negation of an expression.
 TEST_CASE("ExpressionTest.Neg", "[mef::expression]") {
   OpenExpression expression(10, 8);
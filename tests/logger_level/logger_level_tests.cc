@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// The binary is built with SCRAM_LOG_MAX_LEVEL=4 (DEBUG2).
+
+#define CATCH_CONFIG_MAIN
+
+#include "logger.h"
+
+#include <type_traits>
+
+#include <catch2/catch.hpp>
+
+namespace scram::test {
+
+TEST_CASE("LoggerTest.CompiledLevels", "[logger]") {
+  static_assert(kMaxLogLevel == DEBUG2);
+  static_assert(std::is_empty_v<Timer<DEBUG3>>);
+  static_assert(!std::is_empty_v<Timer<DEBUG2>>);
+  LogLevel report_level = Logger::report_level();
+  Logger::report_level(DEBUG5);
+  int num_evaluations = 0;
+  LOG(DEBUG2) << "Compiled in: " << ++num_evaluations;
+  LOG(DEBUG3) << "Eliminated: " << ++num_evaluations;
+  Logger::report_level(report_level);
+  CHECK(num_evaluations == 1);
+}
+
+}  // namespace scram::test
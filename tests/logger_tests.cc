@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logger.h"
+
+#include <cstdio>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <catch2/catch.hpp>
+
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+namespace scram::test {
+
+namespace {
+
+// Redirects the standard error into a temporary file for its lifetime.
+class StderrCapture {
+ public:
+  StderrCapture()
+      : path_(fs::temp_directory_path() /
+              ("scram_logger_test-" + fs::unique_path().string())),
+        level_(Logger::report_level()) {
+    std::fflush(stderr);
+    stderr_ = dup(fileno(stderr));
+    std::FILE* file = std::fopen(path_.string().c_str(), "w");
+    dup2(fileno(file), fileno(stderr));
+    std::fclose(file);
+    Logger::report_level(DEBUG5);
+  }
+
+  ~StderrCapture() {
+    Logger::report_level(level_);
+    std::fflush(stderr);
+    dup2(stderr_, fileno(stderr));
+    close(stderr_);
+    fs::remove(path_);
+  }
+
+  // Returns the output written so far.
+  std::string str() const {
+    std::fflush(stderr);
+    std::ifstream file(path_.string());
+    return std::string(std::istreambuf_iterator<char>(file),
+                       std::istreambuf_iterator<char>());
+  }
+
+ private:
+  fs::path path_;  // The temporary file for the output.
+  LogLevel level_;  // The original report level.
+  int stderr_;  // The duplicate of the original standard error.
+};
+
+}  // namespace
+
+TEST_CASE("LoggerTest.ConcurrentProducers", "[logger]") {
+  const int kNumThreads = 4;
+  const int kNumRecords = 3000;  // More than the queue capacity.
+  StderrCapture capture;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([i] {
+      for (int j = 0; j < kNumRecords; ++j)
+        LOG(DEBUG1) << "producer-" << i << " record-" << j << ";";
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  Logger::Flush();
+  std::string output = capture.str();
+  for (int i = 0; i < kNumThreads; ++i) {
+    INFO("producer-" << i);
+    std::string::size_type pos = 0;
+    for (int j = 0; j < kNumRecords; ++j) {
+      std::string record = "producer-" + std::to_string(i) + " record-" +
+                           std::to_string(j) + ";";
+      pos = output.find(record, pos);
+      REQUIRE(pos != std::string::npos);
+    }
+  }
+}
+
+TEST_CASE("LoggerTest.OrderAfterFlush", "[logger]") {
+  StderrCapture capture;
+  LOG(INFO) << "first";
+  Logger::Flush();
+  CHECK(capture.str().find("first") != std::string::npos);
+  std::thread([] { LOG(INFO) << "second"; }).join();
+  Logger::Flush();
+  std::string output = capture.str();
+  REQUIRE(output.find("second") != std::string::npos);
+  CHECK(output.find("first") < output.find("second"));
+}
+
+TEST_CASE("LoggerTest.ImmediateWarnings", "[logger]") {
+  StderrCapture capture;
+  LOG(DEBUG1) << "queued";
+  LOG(WARNING) << "immediate";
+  std::string output = capture.str();  // No flush.
+  REQUIRE(output.find("immediate") != std::string::npos);
+  REQUIRE(output.find("queued") != std::string::npos);
+  CHECK(output.find("queued") < output.find("immediate"));
+}
+
+}  // namespace scram::test
@@ -103,6 +103,39 @@ TEST_CASE("PdagTest.Cardinality", "[mef::pdag]") {
   }
 }
 
+TEST_CASE("PdagTest.MultipleDefinitions", "[pdag]") {
+  Pdag graph;
+  auto var_one = graph.MakeNode<Variable>();
+  auto var_two = graph.MakeNode<Variable>();
+  auto root = graph.MakeNode<Gate>(kOr);
+  auto gate_one = graph.MakeNode<Gate>(kAnd);
+  auto gate_two = graph.MakeNode<Gate>(kAnd);
+  for (const GatePtr& gate : {gate_one, gate_two}) {
+    gate->AddArg(var_one);
+    gate->AddArg(var_two);
+    root->AddArg(gate);
+  }
+  graph.root(root);
+
+  auto multi_def = graph.GetMultipleDefinitions();
+  REQUIRE(multi_def.size() == 1);
+  GatePtr original = multi_def.begin()->first;
+  REQUIRE(multi_def.begin()->second.size() == 1);
+  GatePtr duplicate = multi_def.begin()->second.front().lock();
+  CHECK((original == gate_one || original == gate_two));
+  CHECK((duplicate == gate_one || duplicate == gate_two));
+  CHECK(original != duplicate);
+  CHECK(graph.GetMultipleDefinitions().empty());  // No changes.
+
+  duplicate->type(kOr);
+  CHECK(graph.GetMultipleDefinitions().empty());
+  original->type(kOr);  // Only the changed gate is tested.
+  multi_def = graph.GetMultipleDefinitions();
+  REQUIRE(multi_def.size() == 1);
+  CHECK(multi_def.begin()->first == duplicate);
+  CHECK(multi_def.begin()->second.front().lock() == original);
+}
+
 static_assert(kNumConnectives == 8, "New gate types are not considered!");
 
 class GateTest {
@@ -116,6 +149,9 @@ class GateTest {
       vars_.emplace_back(new Variable(&graph));  // Extra.
   }
 
+ private:
+  Pdag graph;  // The manager of unique indices and the pool of new nodes.
+
  protected:
   /// Sets up the main gate with the default variables.
   ///
@@ -148,7 +184,6 @@ class GateTest {
   VariablePtr var_three;
 
  private:
-  Pdag graph;  // The manager of unique indices.
   std::vector<VariablePtr> vars_;  // For convenience only.
 };
 
@@ -37,17 +37,260 @@
 // Better as well as worse performance are reported
 // as test failures to indicate the change.
 //
+// The time thresholds are hardware dependent and noisy;
+// therefore, the analysis phases are also measured
+// with the hardware performance counters on Linux
+// (instructions retired, cache misses, branch misses)
+// and the peak resident set size.
+// The measurements are recorded into a JSON baseline file
+// given by SCRAM_PERF_RECORD environment variable.
+// If SCRAM_PERF_BASELINE environment variable gives the baseline file,
+// the instruction counts are compared against the baseline
+// instead of the time thresholds,
+// and only the regressions beyond the tolerance are test failures.
+// The time thresholds still apply
+// if the counters are not available (perf_event_open is restricted)
+// or the baseline has no record of the test.
+//
 // NOTE: Running all the tests may take considerable time.
 // NOTE: Running tests several times is recommended
 //       to take into account the random variation of time results.
 
 #include "performance_tests.h"
 
+#include <cstdlib>
+#include <cstring>
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <boost/filesystem.hpp>
+// The property tree still uses the global Bind placeholders.
+#define BOOST_BIND_GLOBAL_PLACEHOLDERS
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include "bdd.h"
+#include "xml_stream.h"
 #include "zbdd.h"
 
 namespace scram::core::test {
 
+namespace {
+
+#ifdef __linux__
+// The counted hardware events in the order of the counter descriptors.
+const std::array<std::uint64_t, 3> kEvents = {
+    PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES};
+
+// Opens a disabled counter of user-space events
+// of the process and its threads created after the opening.
+//
+// @returns The file descriptor or -1 if the counter is not available.
+int OpenCounter(std::uint64_t event) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = event;
+  attr.disabled = 1;
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+#endif
+
+// Resets the peak resident set size of the process if supported.
+void ResetPeakRss() { std::ofstream("/proc/self/clear_refs") << "5"; }
+
+// @returns The peak resident set size of the process in KiB,
+//          or 0 if not available.
+long ReadPeakRss() {
+  std::ifstream status("/proc/self/status");
+  std::string key;
+  while (status >> key) {
+    if (key == "VmHWM:") {
+      long peak = 0;
+      status >> peak;
+      return peak;
+    }
+  }
+  return 0;
+}
+
+// The phase measurements of tests by the test names.
+using Baseline = std::map<std::string, PerformanceTest::Phases>;
+
+// @returns The optional value of the baseline record field.
+std::optional<std::uint64_t> GetCount(const boost::property_tree::ptree& tree,
+                                      const char* key) {
+  if (auto value = tree.get_optional<std::uint64_t>(key))
+    return *value;
+  return {};
+}
+
+// @returns The records of the baseline file.
+Baseline LoadBaseline(const std::string& path) {
+  namespace pt = boost::property_tree;
+  pt::ptree tree;
+  pt::read_json(path, tree);
+  Baseline baseline;
+  for (const pt::ptree::value_type& test : tree) {
+    for (const pt::ptree::value_type& phase : test.second) {
+      PerfCounters::Sample& sample = baseline[test.first][phase.first];
+      sample.instructions = GetCount(phase.second, "instructions");
+      sample.cache_misses = GetCount(phase.second, "cache_misses");
+      sample.branch_misses = GetCount(phase.second, "branch_misses");
+      sample.peak_rss = phase.second.get("peak_rss", 0L);
+      sample.seconds = phase.second.get("seconds", 0.0);
+    }
+  }
+  return baseline;
+}
+
+// Writes the JSON string with the escaped special characters.
+void WriteString(const std::string& value, std::ostream& out) {
+  out << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\')
+      out << '\\';
+    out << c;
+  }
+  out << '"';
+}
+
+// Overwrites the baseline file with the records.
+void SaveBaseline(const Baseline& baseline, const std::string& path) {
+  std::ofstream out(path);
+  out << "{";
+  const char* test_separator = "\n";
+  for (const auto& [test, phases] : baseline) {
+    out << test_separator << "  ";
+    WriteString(test, out);
+    out << ": {";
+    const char* phase_separator = "\n";
+    for (const auto& [phase, sample] : phases) {
+      out << phase_separator << "    ";
+      WriteString(phase, out);
+      out << ": {";
+      if (sample.instructions)
+        out << "\"instructions\": " << *sample.instructions << ", ";
+      if (sample.cache_misses)
+        out << "\"cache_misses\": " << *sample.cache_misses << ", ";
+      if (sample.branch_misses)
+        out << "\"branch_misses\": " << *sample.branch_misses << ", ";
+      out << "\"peak_rss\": " << sample.peak_rss
+          << ", \"seconds\": " << sample.seconds << "}";
+      phase_separator = ",\n";
+    }
+    out << "\n  }";
+    test_separator = ",\n";
+  }
+  out << "\n}\n";
+  if (!out)
+    FAIL("Cannot write the performance baseline: " << path);
+}
+
+}  // namespace
+
+PerfCounters::PerfCounters() {
+  fds_.fill(-1);
+#ifdef __linux__
+  for (int i = 0; i < fds_.size(); ++i)
+    fds_[i] = OpenCounter(kEvents[i]);
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+  for (int fd : fds_) {
+    if (fd != -1)
+      ::close(fd);
+  }
+#endif
+}
+
+void PerfCounters::Start() {
+  ResetPeakRss();
+#ifdef __linux__
+  for (int fd : fds_) {
+    if (fd != -1) {
+      ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+  start_time_ = std::chrono::steady_clock::now();
+}
+
+PerfCounters::Sample PerfCounters::Stop() {
+  Sample sample;
+  sample.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start_time_)
+                       .count();
+#ifdef __linux__
+  std::array<std::optional<std::uint64_t>*, 3> values = {
+      &sample.instructions, &sample.cache_misses, &sample.branch_misses};
+  for (int i = 0; i < fds_.size(); ++i) {
+    if (fds_[i] == -1)
+      continue;
+    ::ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+    std::uint64_t count = 0;
+    if (::read(fds_[i], &count, sizeof(count)) == sizeof(count))
+      *values[i] = count;
+  }
+#endif
+  sample.peak_rss = ReadPeakRss();
+  return sample;
+}
+
+void PerformanceTest::CheckCounters() {
+  std::string name = Catch::getResultCapture().getCurrentTestName();
+  if (const char* path = std::getenv("SCRAM_PERF_RECORD")) {
+    static Baseline records =
+        boost::filesystem::exists(path) ? LoadBaseline(path) : Baseline();
+    records[name] = phases_;
+    SaveBaseline(records, path);
+  }
+  const char* path = std::getenv("SCRAM_PERF_BASELINE");
+  if (!path)
+    return;
+  static const Baseline baseline = LoadBaseline(path);
+  auto it = baseline.find(name);
+  if (it == baseline.end()) {
+    WARN("No performance baseline for the test: " << name);
+    return;
+  }
+  for (const auto& [phase, expected] : it->second) {
+    auto measured = phases_.find(phase);
+    if (measured == phases_.end() || !measured->second.instructions ||
+        !expected.instructions) {
+      continue;
+    }
+    double ratio = static_cast<double>(*measured->second.instructions) /
+                   *expected.instructions;
+    INFO(phase << " instructions: " << *measured->second.instructions
+               << " (baseline " << *expected.instructions << ")");
+    CHECK(ratio <= 1 + kInstructionTolerance);
+    if (ratio < 1 - kInstructionTolerance)
+      WARN("The instruction count of " << phase << " has improved.");
+    compared_.insert(phase);
+  }
+  if (compared_.empty())
+    WARN("No instruction counts to compare; the time thresholds apply.");
+}
+
 // Regression check for performance assumptions of developers.
 #ifndef NDEBUG
 // Test for performance critical object sizes.
@@ -59,7 +302,7 @@ TEST_CASE("regression test BDD/ZBDD", "[object_size]") {
   CHECK(sizeof(Vertex<Ite>) == 16);
   CHECK(sizeof(NonTerminal<Ite>) == 48);
   CHECK(sizeof(Ite) == 64);
-  CHECK(sizeof(SetNode) == 56);
+  CHECK(sizeof(SetNode) == 64);
 }
 #endif
 
@@ -69,7 +312,8 @@ TEST_CASE_METHOD(PerformanceTest, "probability", "[.perf]") {
   std::string input = "input/ThreeMotor/three_motor.xml";
   settings.probability_analysis(true);
   REQUIRE_NOTHROW(Analyze({input}));
-  REQUIRE(ProbabilityCalculationTime() < p_time_std);
+  if (timed("probability"))
+    REQUIRE(ProbabilityCalculationTime() < p_time_std);
 }
 
 TEST_CASE_METHOD(PerformanceTest, "perf chinese", "[.perf]") {
@@ -78,7 +322,8 @@ TEST_CASE_METHOD(PerformanceTest, "perf chinese", "[.perf]") {
       "input/Chinese/chinese.xml", "input/Chinese/chinese-basic-events.xml"};
   settings.probability_analysis(false);
   REQUIRE_NOTHROW(Analyze(input_files));
-  REQUIRE(ProductGenerationTime() < mcs_time);
+  if (timed("products"))
+    REQUIRE(ProductGenerationTime() < mcs_time);
 }
 
 TEST_CASE_METHOD(PerformanceTest, "perf 200Event", "[.perf]") {
@@ -86,7 +331,8 @@ TEST_CASE_METHOD(PerformanceTest, "perf 200Event", "[.perf]") {
   std::string input = "input/Autogenerated/200_event.xml";
   REQUIRE_NOTHROW(Analyze({input}));
   CHECK(NumOfProducts() == 15347);
-  CHECK(ProductGenerationTime() < mcs_time);
+  if (timed("products"))
+    CHECK(ProductGenerationTime() < mcs_time);
 }
 
 TEST_CASE_METHOD(PerformanceTest, "perf Baobab1L7", "[.perf]") {
@@ -99,7 +345,8 @@ TEST_CASE_METHOD(PerformanceTest, "perf Baobab1L7", "[.perf]") {
   settings.limit_order(7);
   REQUIRE_NOTHROW(Analyze(input_files));
   CHECK(NumOfProducts() == 17432);
-  CHECK(ProductGenerationTime() == Approx(mcs_time).epsilon(delta));
+  if (timed("products"))
+    CHECK(ProductGenerationTime() == Approx(mcs_time).epsilon(delta));
 }
 
 TEST_CASE_METHOD(PerformanceTest, "perf CEA9601_L4", "[.perf]") {
@@ -112,7 +359,8 @@ TEST_CASE_METHOD(PerformanceTest, "perf CEA9601_L4", "[.perf]") {
   settings.limit_order(4).algorithm("bdd");
   REQUIRE_NOTHROW(Analyze(input_files));
   CHECK(NumOfProducts() == 54436);
-  CHECK(ProductGenerationTime() == Approx(mcs_time).epsilon(delta));
+  if (timed("products"))
+    CHECK(ProductGenerationTime() == Approx(mcs_time).epsilon(delta));
 }
 
 #ifdef NDEBUG
@@ -123,7 +371,8 @@ TEST_CASE_METHOD(PerformanceTest, "perf CEA9601_L5", "[.perf]") {
   settings.limit_order(5).algorithm("bdd");
   REQUIRE_NOTHROW(Analyze(input_files));
   CHECK(NumOfProducts() == 1615876);
-  CHECK(ProductGenerationTime() == Approx(mcs_time).epsilon(delta));
+  if (timed("products"))
+    CHECK(ProductGenerationTime() == Approx(mcs_time).epsilon(delta));
 }
 
 TEST_CASE_METHOD(PerformanceTest, "perf CEA9601_L3_ZBDD", "[.perf]") {
@@ -133,7 +382,8 @@ TEST_CASE_METHOD(PerformanceTest, "perf CEA9601_L3_ZBDD", "[.perf]") {
   settings.limit_order(3).algorithm("zbdd");
   REQUIRE_NOTHROW(Analyze(input_files));
   CHECK(NumOfProducts() == 1144);
-  CHECK(ProductGenerationTime() == Approx(mcs_time).epsilon(delta));
+  if (timed("products"))
+    CHECK(ProductGenerationTime() == Approx(mcs_time).epsilon(delta));
 }
 #endif
 
@@ -143,7 +393,8 @@ TEST_CASE_METHOD(PerformanceTest, "perf Baobab2", "[.perf]") {
                                        "input/Baobab/baobab2-basic-events.xml"};
   REQUIRE_NOTHROW(Analyze(input_files));
   CHECK(NumOfProducts() == 4805);
-  CHECK(ProductGenerationTime() < mcs_time);
+  if (timed("products"))
+    CHECK(ProductGenerationTime() < mcs_time);
 }
 
 TEST_CASE_METHOD(PerformanceTest, "perf Baobab1", "[.perf]") {
@@ -155,7 +406,8 @@ TEST_CASE_METHOD(PerformanceTest, "perf Baobab1", "[.perf]") {
                                        "input/Baobab/baobab1-basic-events.xml"};
   REQUIRE_NOTHROW(Analyze(input_files));
   CHECK(NumOfProducts() == 46188);
-  CHECK(ProductGenerationTime() == Approx(mcs_time).epsilon(delta));
+  if (timed("products"))
+    CHECK(ProductGenerationTime() == Approx(mcs_time).epsilon(delta));
 }
 
 TEST_CASE_METHOD(PerformanceTest, "perf Baobab1_ZBDD", "[.perf]") {
@@ -168,7 +420,56 @@ TEST_CASE_METHOD(PerformanceTest, "perf Baobab1_ZBDD", "[.perf]") {
   settings.algorithm("zbdd");
   REQUIRE_NOTHROW(Analyze(input_files));
   CHECK(NumOfProducts() == 46188);
-  CHECK(ProductGenerationTime() == Approx(mcs_time).epsilon(delta));
+  if (timed("products"))
+    CHECK(ProductGenerationTime() == Approx(mcs_time).epsilon(delta));
+}
+
+// Tests the performance of report writing
+// with a synthetic result of 10^6 products in the report layout.
+TEST_CASE("perf report 1e6 products", "[.perf]") {
+  double report_time = 3.5;
+#ifdef NDEBUG
+  report_time = 0.6;
+#endif
+  const int kNumProducts = 1e6;
+  const int kNumEvents = 1000;
+  std::vector<std::string> names;
+  for (int i = 0; i < kNumEvents; ++i)
+    names.push_back("BasicEvent" + std::to_string(i));
+
+  namespace fs = boost::filesystem;
+  fs::path temp_file = fs::temp_directory_path() /
+                       ("scram_report_perf-" + fs::unique_path().string());
+  INFO("output: " + temp_file.string());
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> fp(
+        std::fopen(temp_file.string().c_str(), "w"), &std::fclose);
+    REQUIRE(fp);
+    xml::Stream xml_stream(fp.get());
+    xml::StreamElement report = xml_stream.root("report");
+    xml::StreamElement results = report.AddChild("results");
+    xml::StreamElement sum_of_products = results.AddChild("sum-of-products");
+    sum_of_products.SetAttribute("name", "TopEvent")
+        .SetAttribute("basic-events", kNumEvents)
+        .SetAttribute("products", kNumProducts);
+    for (int i = 0; i < kNumProducts; ++i) {
+      int order = 1 + i % 4;
+      double p = 1.0 / (i + 7);
+      xml::StreamElement product = sum_of_products.AddChild("product");
+      product.SetAttribute("order", order)
+          .SetAttribute("probability", p)
+          .SetAttribute("contribution", p / 14.392726722864);
+      for (int j = 0; j < order; ++j) {
+        product.AddChild("basic-event")
+            .SetAttribute("name", names[(i * 7 + j * 13) % kNumEvents]);
+      }
+    }
+  }
+  std::chrono::duration<double> duration =
+      std::chrono::steady_clock::now() - start;
+  fs::remove(temp_file);
+  CHECK(duration.count() < report_time);
 }
 
 }  // namespace scram::core::test
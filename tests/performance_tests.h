@@ -17,20 +17,69 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
 #include <string>
 #include <vector>
 
 #include <catch2/catch.hpp>
 
+#include "bdd.h"
+#include "fault_tree.h"
 #include "fault_tree_analysis.h"
 #include "initializer.h"
+#include "mocus.h"
+#include "preprocessor.h"
 #include "probability_analysis.h"
-#include "risk_analysis.h"
+#include "zbdd.h"
 
 namespace scram::core::test {
 
+// Hardware performance counters of the process
+// with the fallback to the time and memory only
+// if the counters are not available (non-Linux, restricted perf_event_open).
+class PerfCounters {
+ public:
+  // The measurements of a single phase.
+  struct Sample {
+    std::optional<std::uint64_t> instructions;  // Instructions retired.
+    std::optional<std::uint64_t> cache_misses;  // Last-level cache misses.
+    std::optional<std::uint64_t> branch_misses;  // Mispredicted branches.
+    long peak_rss = 0;  // The peak resident set size in KiB.
+    double seconds = 0;  // The wall-clock time.
+  };
+
+  PerfCounters();
+  ~PerfCounters();
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  // Resets and starts the counting.
+  void Start();
+
+  // Stops the counting.
+  //
+  // @returns The measurements since the start.
+  Sample Stop();
+
+ private:
+  std::array<int, 3> fds_;  // The counter file descriptors or -1.
+  std::chrono::steady_clock::time_point start_time_;
+};
+
 class PerformanceTest {
  public:
+  // The measurements of the analysis phases by the phase names.
+  using Phases = std::map<std::string, PerfCounters::Sample>;
+
+  // The allowed relative variation of instruction counts.
+  static constexpr double kInstructionTolerance = 0.03;
+
   PerformanceTest() {
     settings.algorithm("mocus");
     delta = 0.10;  // % variation of values.
@@ -38,44 +87,109 @@ class PerformanceTest {
 
  protected:
   // Convenient function to manage analysis of one model in input files.
+  // The model must have a single top event.
+  // The initialization, product generation, and probability calculation
+  // phases are measured with the performance counters,
+  // recorded into the file given by SCRAM_PERF_RECORD environment variable,
+  // and compared with the baseline given by SCRAM_PERF_BASELINE.
   void Analyze(const std::vector<std::string>& input_files) {
-    {
-      model = mef::Initializer(input_files, settings).model();
-      analysis = std::make_unique<RiskAnalysis>(model.get(), settings);
+    counters_.Start();
+    model = mef::Initializer(input_files, settings).model();
+    phases_["initialize"] = counters_.Stop();
+    REQUIRE(model->fault_trees().size() == 1);
+    const mef::FaultTree& fault_tree = *model->fault_trees().begin();
+    REQUIRE(fault_tree.top_events().size() == 1);
+    const mef::Gate& top_event = *fault_tree.top_events().front();
+    switch (settings.algorithm()) {
+      case Algorithm::kBdd:
+        Analyze<Bdd>(top_event);
+        break;
+      case Algorithm::kZbdd:
+        Analyze<Zbdd>(top_event);
+        break;
+      case Algorithm::kMocus:
+        Analyze<Mocus>(top_event);
     }
-    analysis->Analyze();
+    CheckCounters();
+  }
+
+  // Indicates that the time thresholds of the phase are in effect
+  // because its instruction counts are not compared with the baseline.
+  bool timed(const std::string& phase) const {
+    return !compared_.count(phase);
   }
 
   // Total probability as a result of analysis.
   double p_total() {
-    assert(analysis->results().size() == 1);
-    assert(analysis->results().front().probability_analysis);
-    return analysis->results().front().probability_analysis->p_total();
+    assert(probability_analysis_);
+    return probability_analysis_->p_total();
   }
 
   // The number of products as a result of analysis.
-  int NumOfProducts() {
-    assert(analysis->results().size() == 1);
-    return analysis->results().front().fault_tree_analysis->products().size();
-  }
+  int NumOfProducts() { return fault_tree_analysis_->products().size(); }
 
   // Time taken to find products.
   double ProductGenerationTime() {
-    assert(analysis->results().size() == 1);
-    return analysis->results().front().fault_tree_analysis->analysis_time();
+    return fault_tree_analysis_->analysis_time();
   }
 
   // Time taken to calculate total probability.
   double ProbabilityCalculationTime() {
-    assert(analysis->results().size() == 1);
-    assert(analysis->results().front().probability_analysis);
-    return analysis->results().front().probability_analysis->analysis_time();
+    assert(probability_analysis_);
+    return probability_analysis_->analysis_time();
   }
 
   std::unique_ptr<mef::Model> model;
-  std::unique_ptr<RiskAnalysis> analysis;
   Settings settings;
   double delta;  // The range indicator for values.
+
+ private:
+  // Generates the products of the top event in the "products" phase
+  // and calculates the probability in the "probability" phase.
+  template <class Algorithm>
+  void Analyze(const mef::Gate& top_event) {
+    counters_.Start();
+    auto fta = std::make_unique<FaultTreeAnalyzer<Algorithm>>(
+        top_event, settings, model.get());
+    fta->Analyze();
+    phases_["products"] = counters_.Stop();
+    if (settings.probability_analysis()) {
+      switch (settings.approximation()) {
+        case Approximation::kNone:
+          Analyze<Algorithm, Bdd>(fta.get());
+          break;
+        case Approximation::kRareEvent:
+          Analyze<Algorithm, RareEventCalculator>(fta.get());
+          break;
+        case Approximation::kMcub:
+          Analyze<Algorithm, McubCalculator>(fta.get());
+          break;
+        case Approximation::kBonferroni:
+          Analyze<Algorithm, BonferroniCalculator>(fta.get());
+      }
+    }
+    fault_tree_analysis_ = std::move(fta);
+  }
+
+  template <class Algorithm, class Calculator>
+  void Analyze(FaultTreeAnalyzer<Algorithm>* fta) {
+    counters_.Start();
+    auto pa = std::make_unique<ProbabilityAnalyzer<Calculator>>(
+        fta, &model->mission_time());
+    pa->Analyze();
+    phases_["probability"] = counters_.Stop();
+    probability_analysis_ = std::move(pa);
+  }
+
+  // Records the phase measurements
+  // and checks the instruction counts against the baseline.
+  void CheckCounters();
+
+  PerfCounters counters_;
+  Phases phases_;  // The measurements of the last analysis.
+  std::set<std::string> compared_;  // The phases compared with the baseline.
+  std::unique_ptr<FaultTreeAnalysis> fault_tree_analysis_;
+  std::unique_ptr<ProbabilityAnalysis> probability_analysis_;
 };
 
 }  // namespace scram::core::test
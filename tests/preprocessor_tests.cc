@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "preprocessor.h"
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include "bdd.h"
+#include "event.h"
+#include "fault_tree_analysis.h"
+#include "settings.h"
+
+namespace scram::core::test {
+
+namespace {
+
+/// @returns The products of the analysis as sets of event names.
+std::set<std::set<std::string>> GetProducts(const FaultTreeAnalysis& fta) {
+  std::set<std::set<std::string>> products;
+  for (const Product& product : fta.products()) {
+    std::set<std::string> names;
+    for (const Literal& literal : product)
+      names.insert((literal.complement ? "not " : "") + literal.event.id());
+    products.insert(std::move(names));
+  }
+  return products;
+}
+
+}  // namespace
+
+// The failure of the common gate x makes the top gate a state destination,
+// so Boolean optimization introduces a new top gate (x | top').
+// The common variable w, shared by x and the top gate sub-graph,
+// is processed later
+// with the new gate on the frontier of its ancestors.
+TEST_CASE("PreprocessorTest.BooleanOptimizationNewDestinationGate",
+          "[preprocessor]") {
+  mef::BasicEvent a("a"), b("b"), d("d"), w("w");
+  mef::Gate x("x"), left("left"), right("right"), top("top");
+  x.formula(std::make_unique<mef::Formula>(mef::kAnd,
+                                           mef::Formula::ArgSet{&w, &d}));
+  left.formula(std::make_unique<mef::Formula>(mef::kOr,
+                                              mef::Formula::ArgSet{&x, &a}));
+  right.formula(std::make_unique<mef::Formula>(
+      mef::kOr, mef::Formula::ArgSet{&x, &b, &w}));
+  top.formula(std::make_unique<mef::Formula>(
+      mef::kAnd, mef::Formula::ArgSet{&left, &right}));
+
+  Settings settings;
+  settings.preprocessing_passes({PreprocessingPass::kBooleanOptimization});
+
+  SECTION("The destination is the root") {
+    FaultTreeAnalyzer<Bdd> fta(top, settings);
+    fta.Analyze();
+    // (w & d | a) & (w & d | b | w) = w & d | a & b | a & w
+    CHECK(GetProducts(fta) == std::set<std::set<std::string>>{
+                                  {"w", "d"}, {"a", "b"}, {"a", "w"}});
+  }
+
+  SECTION("The destination is a module") {
+    mef::BasicEvent e("e");
+    mef::Gate root("root");
+    root.formula(std::make_unique<mef::Formula>(
+        mef::kAnd, mef::Formula::ArgSet{&top, &e}));
+    FaultTreeAnalyzer<Bdd> fta(root, settings);
+    fta.Analyze();
+    CHECK(GetProducts(fta) ==
+          std::set<std::set<std::string>>{
+              {"w", "d", "e"}, {"a", "b", "e"}, {"a", "w", "e"}});
+  }
+}
+
+}  // namespace scram::core::test
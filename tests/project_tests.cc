@@ -68,17 +68,39 @@ TEST_CASE("ProjectTest.FullSettings", "[config]") {
   CHECK(settings.probability_analysis());
   CHECK(settings.importance_analysis());
   CHECK(settings.uncertainty_analysis());
+  CHECK(settings.sensitivity_analysis());
   CHECK(settings.ccf_analysis());
+  CHECK(settings.shared_bdd());
+  CHECK(settings.phase_cofactors());
+  CHECK(settings.raw_samples());
   CHECK(settings.safety_integrity_levels());
   CHECK(settings.approximation() == core::Approximation::kRareEvent);
   CHECK(settings.limit_order() == 11);
   CHECK(settings.mission_time() == 48);
   CHECK(settings.time_step() == 1);
   CHECK(settings.cut_off() == 0.009);
+  CHECK(settings.sampling() == core::Sampling::kLatinHypercube);
   CHECK(settings.num_trials() == 777);
+  CHECK(settings.target_precision() == 0.02);
+  CHECK(settings.time_budget() == 60);
   CHECK(settings.num_quantiles() == 13);
   CHECK(settings.num_bins() == 31);
   CHECK(settings.seed() == 97531);
+  CHECK(settings.num_threads() == 3);
+  CHECK(settings.preprocessing_policy() == core::PreprocessingPolicy::kAuto);
+  CHECK(settings.preprocessing_passes() ==
+        std::vector<core::PreprocessingPass>{
+            core::PreprocessingPass::kBooleanOptimization,
+            core::PreprocessingPass::kCoalescence});
+}
+
+TEST_CASE("ProjectTest.NoPreprocessingPasses", "[config]") {
+  std::string config_file =
+      "tests/input/fta/no_preprocessing_configuration.xml";
+  Project config(config_file);
+  const core::Settings& settings = config.settings();
+  CHECK(settings.preprocessing_policy() == core::PreprocessingPolicy::kAuto);
+  CHECK(settings.preprocessing_passes().empty());
 }
 
 TEST_CASE("ProjectTest.PrimeImplicantsSettings", "[config]") {
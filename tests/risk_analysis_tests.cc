@@ -17,12 +17,20 @@
 
 #include "risk_analysis_tests.h"
 
+#include <cstring>
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
 #include <utility>
 
 #include <boost/filesystem.hpp>
 
 #include "env.h"
 #include "error.h"
+#include "exporter.h"
 #include "initializer.h"
 #include "reporter.h"
 #include "xml.h"
@@ -72,10 +80,16 @@ void RiskAnalysisTest::CheckReport(const std::vector<std::string>& tree_input) {
 const std::set<std::set<std::string>>& RiskAnalysisTest::products() {
   assert(analysis->results().size() == 1);
   if (result_.products.empty()) {
-    for (const Product& product :
-         analysis->results().front().fault_tree_analysis->products()) {
+    const ProductContainer& container =
+        analysis->results().front().fault_tree_analysis->products();
+    int index = 0;
+    std::vector<int> data;
+    for (const Product& product : container) {
+      // Random access must agree with the iteration order.
+      CHECK(Convert(container.at(index++, &data)) == Convert(product));
       result_.products.emplace(Convert(product));
     }
+    CHECK(index == container.size());
   }
   return result_.products;
 }
@@ -97,10 +111,23 @@ const std::map<std::set<std::string>, double>&
 RiskAnalysisTest::product_probability() {
   assert(analysis->results().size() == 1);
   if (result_.product_probability.empty()) {
-    for (const Product& product :
-         analysis->results().front().fault_tree_analysis->products()) {
+    const ProductContainer& container =
+        analysis->results().front().fault_tree_analysis->products();
+    double sum = 0;
+    std::vector<double> probabilities;
+    for (const Product& product : container) {
       result_.product_probability.emplace(Convert(product), product.p());
+      sum += product.p();
+      probabilities.push_back(product.p());
+    }
+    CHECK(container.p_sum() == Approx(sum));
+    std::sort(probabilities.begin(), probabilities.end(), std::greater<>());
+    int i = 0;
+    for (const Product& product : container.top(container.size())) {
+      REQUIRE(i < probabilities.size());
+      CHECK(product.p() == Approx(probabilities[i++]));
     }
+    CHECK(i == probabilities.size());
   }
   return result_.product_probability;
 }
@@ -237,6 +264,29 @@ TEST_P(RiskAnalysisTest, AnalyzeWithProbability) {
   CHECK(product_probability().at(mcs_4) == Approx(0.2));
 }
 
+TEST_P(RiskAnalysisTest, AnalyzeTopProducts) {
+  std::string with_prob = "tests/input/fta/correct_tree_input_with_probs.xml";
+  std::set<std::string> mcs_1 = {"PumpOne", "PumpTwo"};
+  std::set<std::string> mcs_2 = {"PumpOne", "ValveTwo"};
+  settings.top_products(2);
+  REQUIRE_NOTHROW(ProcessInputFiles({with_prob}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+
+  const ProductContainer& container =
+      analysis->results().front().fault_tree_analysis->products();
+  CHECK(container.size() == 4);
+  CHECK(container.p_sum() == Approx(1.2));
+  std::vector<std::set<std::string>> top;
+  for (const Product& product : container.top(2)) {
+    std::set<std::string> ids;
+    for (const Literal& literal : product)
+      ids.insert(literal.event.id());
+    top.push_back(std::move(ids));
+  }
+  CHECK(top == std::vector<std::set<std::string>>{mcs_1, mcs_2});
+  CheckReport({with_prob});
+}
+
 // Test for exact probability calculation
 // regardless of the qualitative analysis algorithm.
 TEST_P(RiskAnalysisTest, EnforceExactProbability) {
@@ -247,6 +297,31 @@ TEST_P(RiskAnalysisTest, EnforceExactProbability) {
   CHECK(p_total() == Approx(0.646));
 }
 
+// Test for the Bonferroni bounds with early termination.
+TEST_P(RiskAnalysisTest, BonferroniBounds) {
+  if (settings.prime_implicants())
+    return;  // No approximations with prime implicants.
+  std::string with_prob = "tests/input/fta/correct_tree_input_with_probs.xml";
+  settings.probability_analysis(true).approximation("bonferroni");
+  settings.bound_tolerance(0);  // The complete inclusion-exclusion.
+  REQUIRE_NOTHROW(ProcessInputFiles({with_prob}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  auto bounds = analysis->results().front().probability_analysis->p_bounds();
+  REQUIRE(bounds);
+  CHECK(bounds->first == Approx(0.646));
+  CHECK(bounds->second == Approx(0.646));
+  CHECK(p_total() == Approx(0.646));
+
+  settings.bound_tolerance(1);  // Only the first term.
+  REQUIRE_NOTHROW(ProcessInputFiles({with_prob}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  bounds = analysis->results().front().probability_analysis->p_bounds();
+  REQUIRE(bounds);
+  CHECK(bounds->first == Approx(0.42));
+  CHECK(bounds->second == Approx(1));
+  CheckReport({with_prob});
+}
+
 TEST_P(RiskAnalysisTest, AnalyzeNestedFormula) {
   std::string nested_input = "tests/input/fta/nested_not.xml";
   REQUIRE_NOTHROW(ProcessInputFiles({nested_input}));
@@ -350,6 +425,32 @@ TEST_P(RiskAnalysisTest, AnalyzeMC) {
   std::string tree_input = "tests/input/fta/correct_tree_input_with_probs.xml";
   REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
   REQUIRE_NOTHROW(analysis->Analyze());
+  CHECK(analysis->results().front().uncertainty_analysis->num_trials() ==
+        settings.num_trials());
+  CHECK(analysis->results().front().uncertainty_analysis->samples().empty());
+}
+
+// Monte Carlo Analysis with the raw samples kept.
+TEST_P(RiskAnalysisTest, AnalyzeMCRawSamples) {
+  settings.uncertainty_analysis(true).raw_samples(true).num_trials(500);
+  std::string tree_input = "tests/input/fta/correct_tree_input_with_probs.xml";
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  const auto& result = *analysis->results().front().uncertainty_analysis;
+  REQUIRE(result.samples().size() == 500);
+  double sum = 0;
+  for (double sample : result.samples())
+    sum += sample;
+  CHECK(result.mean() == Approx(sum / 500));
+}
+
+// Sequential Monte Carlo stops with the first batch out of the time budget.
+TEST_P(RiskAnalysisTest, AnalyzeMCTimeBudget) {
+  settings.uncertainty_analysis(true).num_trials(1e6).time_budget(1e-9);
+  std::string tree_input = "tests/input/fta/correct_tree_input_with_probs.xml";
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  CHECK(analysis->results().front().uncertainty_analysis->num_trials() == 100);
 }
 
 TEST_P(RiskAnalysisTest, AnalyzeProbabilityOverTime) {
@@ -536,6 +637,13 @@ TEST_F(RiskAnalysisTest, ReportUncertaintyResults) {
   CheckReport({tree_input});
 }
 
+// Reporting of sensitivity analysis.
+TEST_F(RiskAnalysisTest, ReportSensitivityResults) {
+  std::string tree_input = "input/BSCU/BSCU.xml";
+  settings.sensitivity_analysis(true).num_trials(100);
+  CheckReport({tree_input});
+}
+
 // Reporting event tree analysis with an initiating event.
 TEST_F(RiskAnalysisTest, ReportInitiatingEventAnalysis) {
   const char* tree_input = "input/EventTrees/bcd.xml";
@@ -557,11 +665,149 @@ TEST_F(RiskAnalysisTest, ReportNegativeEvent) {
   CheckReport({tree_input});
 }
 
+// Reporting into a compressed file.
+TEST_F(RiskAnalysisTest, ReportGzip) {
+  static xml::Validator validator(env::report_schema());
+
+  std::string tree_input = "tests/input/fta/correct_tree_input_with_probs.xml";
+  settings.probability_analysis(true);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  fs::path unique_name = "scram_report_test-" + fs::unique_path().string();
+  fs::path temp_file = fs::temp_directory_path() / unique_name;
+  temp_file += ".xml.gz";
+  INFO("output: " + temp_file.string());
+  REQUIRE_NOTHROW(Reporter().Report(*analysis, temp_file.string()));
+  REQUIRE_NOTHROW(xml::Document(temp_file.string(), &validator));
+  fs::remove(temp_file);
+}
+
+// Exporting results into the columnar binary format.
+TEST_F(RiskAnalysisTest, ExportColumns) {
+  struct Column {
+    std::uint64_t offset;
+    std::uint64_t length;
+    std::uint32_t type;
+  };
+  std::string data;
+  std::map<std::string, Column> columns;
+  auto read = [&data](std::size_t pos, auto value) {
+    REQUIRE(pos + sizeof(value) <= data.size());
+    std::memcpy(&value, data.data() + pos, sizeof(value));
+    return value;
+  };
+  auto get = [&columns, &read](const std::string& name, auto type, int i) {
+    INFO("column: " + name);
+    REQUIRE(columns.count(name));
+    REQUIRE(i < columns[name].length);
+    return read(columns[name].offset + i * sizeof(type), type);
+  };
+  // Exports the analysis and loads the column directory.
+  auto export_columns = [this, &data, &columns, &read] {
+    fs::path unique_name = "scram_export_test-" + fs::unique_path().string();
+    fs::path temp_file = fs::temp_directory_path() / unique_name;
+    INFO("output: " + temp_file.string());
+    REQUIRE_NOTHROW(Exporter().Export(*analysis, temp_file.string()));
+    std::ifstream stream(temp_file.string(), std::ios::binary);
+    data.assign(std::istreambuf_iterator<char>(stream),
+                std::istreambuf_iterator<char>());
+    stream.close();
+    fs::remove(temp_file);
+
+    REQUIRE(data.size() > 80);
+    CHECK(data.compare(0, 8, "SCRAMCOL") == 0);
+    CHECK(read(8, std::uint32_t()) == Exporter::kVersion);
+    CHECK(read(12, std::uint32_t()) == 0x01020304);
+    CHECK(data.compare(data.size() - 8, 8, "SCRAMCOL") == 0);
+
+    columns.clear();
+    std::size_t pos = read(data.size() - 16, std::uint64_t());
+    auto num_columns = read(pos, std::uint64_t());
+    pos += 8;
+    for (std::uint64_t i = 0; i < num_columns; ++i) {
+      Column column{read(pos, std::uint64_t()), read(pos + 8, std::uint64_t()),
+                    read(pos + 16, std::uint32_t())};
+      auto name_size = read(pos + 20, std::uint32_t());
+      std::string name = data.substr(pos + 24, name_size);
+      pos += 24 + (name_size + 7) / 8 * 8;
+      CHECK(column.offset % 64 == 0);
+      columns.emplace(name, column);
+    }
+    CHECK(pos == data.size() - 16);
+  };
+
+  SECTION("Fault tree results") {
+    std::string tree_input =
+        "tests/input/fta/correct_tree_input_with_probs.xml";
+    settings.probability_analysis(true).importance_analysis(true);
+    REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+    REQUIRE_NOTHROW(analysis->Analyze());
+    export_columns();
+
+    const auto& result = analysis->results().front();
+    const auto& products = result.fault_tree_analysis->products();
+    int num_products = products.size();
+    CHECK(columns["results.probability"].length == 1);
+    CHECK(columns["products.result_offsets"].length == 2);
+    CHECK(get("products.result_offsets", std::int64_t(), 1) == num_products);
+    CHECK(columns["products.literal_offsets"].length == num_products + 1);
+    CHECK(columns["products.probability"].length == num_products);
+    CHECK(columns["products.probability"].type == Exporter::kFloat64);
+    int num_literals = 0;
+    int index = 0;
+    for (const Product& product : products) {
+      CHECK(get("products.probability", double(), index++) == product.p());
+      num_literals += product.order();
+    }
+    CHECK(get("products.literal_offsets", std::int64_t(), num_products) ==
+          num_literals);
+    CHECK(columns["products.event"].length == num_literals);
+    CHECK(columns["products.complement"].length == num_literals);
+    CHECK(get("results.probability", double(), 0) ==
+          Approx(result.probability_analysis->p_total()));
+    CHECK(columns["importance.event"].length ==
+          columns["importance.mif"].length);
+    CHECK(columns["events.name.offsets"].length ==
+          result.importance_analysis->importance().size() + 1);
+    CHECK(columns["samples.value"].length == 0);
+    CHECK(columns["sequences.probability"].length == 0);
+  }
+
+  SECTION("Shared BDD sequences and raw samples") {
+    std::string tree_input = "tests/input/eta/phase_cofactors.xml";
+    settings.phase_cofactors(true).probability_analysis(true);
+    settings.uncertainty_analysis(true).raw_samples(true).num_trials(100);
+    REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+    REQUIRE_NOTHROW(analysis->Analyze());
+    export_columns();
+
+    int num_results = analysis->results().size();
+    CHECK(columns["samples.result_offsets"].length == num_results + 1);
+    CHECK(columns["samples.value"].length == 100 * num_results);
+
+    int index = 0;
+    for (const RiskAnalysis::EtaResult& eta_result :
+         analysis->event_tree_results()) {
+      for (const EventTreeAnalysis::Result& result :
+           eta_result.event_tree_analysis->sequences()) {
+        CHECK(get("sequences.probability", double(), index++) ==
+              result.p_sequence);
+      }
+    }
+    CHECK(index == 9);
+    CHECK(columns["sequences.probability"].length == index);
+    CHECK(columns["sequences.name.offsets"].length == index + 1);
+    CHECK(columns["sequences.phase.offsets"].length == index + 1);
+  }
+}
+
 // Reporting of all possible analyses.
 TEST_F(RiskAnalysisTest, ReportAll) {
   std::string tree_input = "tests/input/fta/correct_tree_input_with_probs.xml";
-  settings.importance_analysis(true).uncertainty_analysis(true).ccf_analysis(
-      true);
+  settings.importance_analysis(true)
+      .uncertainty_analysis(true)
+      .sensitivity_analysis(true)
+      .ccf_analysis(true);
   CheckReport({tree_input});
 }
 
@@ -599,6 +845,57 @@ TEST_F(RiskAnalysisTest, ReportAlignmentEventTree) {
   CheckReport({dir + "attack_alignment.xml", dir + "attack.xml"});
 }
 
+TEST_F(RiskAnalysisTest, AlignmentPhaseCofactors) {
+  std::string tree_input = "tests/input/eta/phase_cofactors.xml";
+  std::map<std::string, std::map<std::string, double>> expected = {
+      {"Normal", {{"S1", 0.9}, {"S2", 0.1}, {"S3", 0.02}}},
+      {"TrainOne", {{"S1", 0}, {"S2", 1}, {"S3", 0.2}}},
+      {"TrainTwo", {{"S1", 0.9}, {"S2", 0.1}, {"S3", 0.02}}}};
+  for (bool cofactors : {false, true}) {
+    INFO("phase cofactors: " + std::to_string(cofactors));
+    settings.probability_analysis(true).phase_cofactors(cofactors);
+    REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+    REQUIRE_NOTHROW(analysis->Analyze());
+    REQUIRE(analysis->event_tree_results().size() == 3);
+    for (const RiskAnalysis::EtaResult& eta_result :
+         analysis->event_tree_results()) {
+      REQUIRE(eta_result.context);
+      const std::string& phase = eta_result.context->phase.name();
+      INFO("phase: " + phase);
+      const auto& sequences = eta_result.event_tree_analysis->sequences();
+      REQUIRE(sequences.size() == 3);
+      for (const EventTreeAnalysis::Result& result : sequences) {
+        INFO("sequence: " + result.sequence.name());
+        CHECK(result.p_sequence ==
+              Approx(expected[phase][result.sequence.name()]));
+      }
+    }
+  }
+}
+
+// The default mission time of 8760 hours makes the phases
+// take different branches of the event tree.
+TEST_F(RiskAnalysisTest, AlignmentPhaseDependentBranch) {
+  std::string tree_input = "tests/input/eta/phase_dependent_branch.xml";
+  std::map<std::string, double> expected = {{"Long", 0.1}, {"Short", 0.2}};
+  for (bool cofactors : {false, true}) {
+    INFO("phase cofactors: " + std::to_string(cofactors));
+    settings.probability_analysis(true).phase_cofactors(cofactors);
+    REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+    REQUIRE_NOTHROW(analysis->Analyze());
+    REQUIRE(analysis->event_tree_results().size() == 2);
+    for (const RiskAnalysis::EtaResult& eta_result :
+         analysis->event_tree_results()) {
+      REQUIRE(eta_result.context);
+      const std::string& phase = eta_result.context->phase.name();
+      INFO("phase: " + phase);
+      const auto& sequences = eta_result.event_tree_analysis->sequences();
+      REQUIRE(sequences.size() == 1);
+      CHECK(sequences.front().p_sequence == Approx(expected[phase]));
+    }
+  }
+}
+
 // NAND and NOR as a child cases.
 TEST_P(RiskAnalysisTest, ChildNandNorGates) {
   std::string tree_input = "tests/input/fta/children_nand_nor.xml";
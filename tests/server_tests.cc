@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server.h"
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+namespace scram::test {
+
+namespace {
+
+/// @returns The probability from the single-line probability response.
+double GetProbability(const std::string& response) {
+  std::istringstream in(response);
+  std::string status, name;
+  int size = 0;
+  double p = -1;
+  in >> status >> size >> name >> p;
+  INFO(response);
+  REQUIRE(status == "ok");
+  return p;
+}
+
+}  // namespace
+
+TEST_CASE("ServerTest.Requantify", "[server]") {
+  core::Settings settings;
+  settings.probability_analysis(true).importance_analysis(true);
+  Server server(settings);
+  CHECK(server.Process("probability").rfind("error ", 0) == 0);
+  CHECK(server.Process("load tests/input/fta/correct_tree_input_with_probs.xml")
+        == "ok 0\n");
+  CHECK(GetProbability(server.Process("probability")) == Approx(0.646));
+
+  CHECK(server.Process("set-probability ValveOne 0") == "ok 0\n");
+  CHECK(GetProbability(server.Process("probability")) == Approx(0.51));
+  CHECK(server.Process("set-probability ValveOne 0.4") == "ok 0\n");
+  CHECK(GetProbability(server.Process("probability")) == Approx(0.646));
+
+  std::string importance = server.Process("importance TopEvent");
+  CHECK(importance.rfind("ok ", 0) == 0);
+  CHECK(importance.find("\nPumpTwo 2 ") != std::string::npos);
+  std::string report = server.Process("analyze");
+  CHECK(report.rfind("ok ", 0) == 0);
+  CHECK(report.find("<sum-of-products") != std::string::npos);
+}
+
+TEST_CASE("ServerTest.RequantifyTopProducts", "[server]") {
+  core::Settings settings;
+  settings.top_products(1);
+  Server server(settings);
+  REQUIRE(server.Process(
+              "load tests/input/fta/correct_tree_input_with_probs.xml") ==
+          "ok 0\n");
+  std::string report = server.Process("analyze");
+  CHECK(report.find("<basic-event name=\"PumpOne\"/>") != std::string::npos);
+  CHECK(report.find("<basic-event name=\"ValveOne\"/>") == std::string::npos);
+
+  CHECK(server.Process("set-probability ValveOne 0.9") == "ok 0\n");
+  CHECK(server.Process("set-probability ValveTwo 0.9") == "ok 0\n");
+  report = server.Process("analyze");
+  CHECK(report.find("<basic-event name=\"ValveOne\"/>") != std::string::npos);
+  CHECK(report.find("<basic-event name=\"PumpOne\"/>") == std::string::npos);
+}
+
+TEST_CASE("ServerTest.ChangeStructure", "[server]") {
+  core::Settings settings;
+  settings.probability_analysis(true);
+  Server server(settings);
+  REQUIRE(server.Process("load tests/input/fta/constant_propagation.xml") ==
+          "ok 0\n");
+  CHECK(GetProbability(server.Process("probability")) == Approx(0.02));
+  CHECK(server.Process("set-house h2 true") == "ok 0\n");
+  CHECK(GetProbability(server.Process("probability")) == Approx(1));
+  CHECK(server.Process("set-house h2 false") == "ok 0\n");
+  CHECK(GetProbability(server.Process("probability")) == Approx(0.02));
+}
+
+TEST_CASE("ServerTest.ReloadChangedFiles", "[server]") {
+  std::ifstream original("tests/input/fta/correct_tree_input_with_probs.xml");
+  std::string content((std::istreambuf_iterator<char>(original)),
+                      std::istreambuf_iterator<char>());
+  fs::path input_file =
+      fs::temp_directory_path() /
+      ("scram_server_test-" + fs::unique_path().string() + ".xml");
+  std::ofstream(input_file.string()) << content;
+  core::Settings settings;
+  settings.probability_analysis(true);
+  Server server(settings);
+  std::string load = "load " + input_file.string();
+  REQUIRE(server.Process(load) == "ok 0\n");
+  CHECK(GetProbability(server.Process("probability")) == Approx(0.646));
+  CHECK(server.Process("set-probability ValveOne 0") == "ok 0\n");
+  REQUIRE(server.Process(load) == "ok 0\n");  // The cached session.
+  CHECK(GetProbability(server.Process("probability")) == Approx(0.51));
+
+  boost::replace_first(content, "<float value=\"0.4\"/>",
+                       "<float value=\"1\"/>");  // ValveOne
+  std::ofstream(input_file.string()) << content;
+  REQUIRE(server.Process(load) == "ok 0\n");
+  CHECK(GetProbability(server.Process("probability")) == Approx(0.85));
+  fs::remove(input_file);
+}
+
+TEST_CASE("ServerTest.InvalidRequests", "[server]") {
+  core::Settings settings;
+  settings.probability_analysis(true);
+  Server server(settings);
+  CHECK(server.Process("unknown").rfind("error ", 0) == 0);
+  CHECK(server.Process("load nonexistent.xml").rfind("error ", 0) == 0);
+  REQUIRE(server.Process("load tests/input/fta/constant_propagation.xml") ==
+          "ok 0\n");
+  CHECK(server.Process("set-probability A 2").rfind("error ", 0) == 0);
+  CHECK(server.Process("set-probability A x").rfind("error ", 0) == 0);
+  CHECK(server.Process("set-probability Z 0.5").rfind("error ", 0) == 0);
+  CHECK(server.Process("set-house h2 maybe").rfind("error ", 0) == 0);
+  CHECK(server.Process("importance Root").rfind("error ", 0) == 0);
+  CHECK(GetProbability(server.Process("probability")) == Approx(0.02));
+}
+
+TEST_CASE("ServerTest.Serve", "[server]") {
+  core::Settings settings;
+  settings.probability_analysis(true);
+  Server server(settings);
+  std::istringstream in(
+      "load tests/input/fta/constant_propagation.xml\n\nquit\nprobability\n");
+  std::ostringstream out;
+  server.Serve(in, out);
+  CHECK(out.str() == "ok 0\nok 0\n");
+}
+
+}  // namespace scram::test
@@ -34,9 +34,32 @@ TEST_CASE("SettingsTest IncorrectSetup", "[settings]") {
   // Incorrect cut-off probability.
   CHECK_THROWS_AS(s.cut_off(-1), SettingsError);
   CHECK_THROWS_AS(s.cut_off(10), SettingsError);
+  // Incorrect tolerance for probability bounds.
+  CHECK_THROWS_AS(s.bound_tolerance(-0.1), SettingsError);
+  CHECK_THROWS_AS(s.bound_tolerance(2), SettingsError);
+  // Incorrect number of top products.
+  CHECK_THROWS_AS(s.top_products(-1), SettingsError);
+  // Incorrect number of threads.
+  CHECK_THROWS_AS(s.num_threads(-1), SettingsError);
+  CHECK_THROWS_AS(s.num_threads(0), SettingsError);
+  // Incorrect preprocessing passes.
+  CHECK_THROWS_AS(s.preprocessing_passes("the-best"), SettingsError);
+  CHECK_THROWS_AS(s.preprocessing_passes("coalescence,,decomposition"),
+                  SettingsError);
+  CHECK_THROWS_AS(s.preprocessing_passes("coalescence decomposition"),
+                  SettingsError);
+  // Incorrect preprocessing policy.
+  CHECK_THROWS_AS(s.preprocessing_policy("some"), SettingsError);
+  // Incorrect sampling strategy.
+  CHECK_THROWS_AS(s.sampling("random"), SettingsError);
   // Incorrect number of trials.
   CHECK_THROWS_AS(s.num_trials(-10), SettingsError);
   CHECK_THROWS_AS(s.num_trials(0), SettingsError);
+  // Incorrect target precision.
+  CHECK_THROWS_AS(s.target_precision(-0.1), SettingsError);
+  CHECK_THROWS_AS(s.target_precision(1), SettingsError);
+  // Incorrect time budget.
+  CHECK_THROWS_AS(s.time_budget(-1), SettingsError);
   // Incorrect number of quantiles.
   CHECK_THROWS_AS(s.num_quantiles(-10), SettingsError);
   CHECK_THROWS_AS(s.num_quantiles(0), SettingsError);
@@ -67,6 +90,12 @@ TEST_CASE("SettingsTest CorrectSetup", "[settings]") {
   // Correct approximation argument.
   CHECK_NOTHROW(s.approximation("rare-event"));
   CHECK_NOTHROW(s.approximation("mcub"));
+  CHECK_NOTHROW(s.approximation("bonferroni"));
+
+  // Correct tolerance for probability bounds.
+  CHECK_NOTHROW(s.bound_tolerance(0));
+  CHECK_NOTHROW(s.bound_tolerance(0.5));
+  CHECK_NOTHROW(s.bound_tolerance(1));
 
   // Correct limit order for products.
   CHECK_NOTHROW(s.limit_order(1));
@@ -78,10 +107,61 @@ TEST_CASE("SettingsTest CorrectSetup", "[settings]") {
   CHECK_NOTHROW(s.cut_off(0));
   CHECK_NOTHROW(s.cut_off(0.5));
 
+  // Correct number of top products.
+  CHECK_NOTHROW(s.top_products(0));
+  CHECK_FALSE(s.probability_analysis());
+  CHECK_NOTHROW(s.top_products(10));
+  CHECK(s.probability_analysis());
+  CHECK_NOTHROW(s.probability_analysis(false));
+  CHECK(s.probability_analysis());
+  CHECK_NOTHROW(s.top_products(0));
+
+  // Correct number of threads.
+  CHECK_NOTHROW(s.num_threads(1));
+  CHECK_NOTHROW(s.num_threads(8));
+
+  // Correct preprocessing passes.
+  CHECK(s.preprocessing_passes().size() == 6);
+  CHECK_NOTHROW(s.preprocessing_passes(""));
+  CHECK(s.preprocessing_passes().empty());
+  CHECK_NOTHROW(s.preprocessing_passes("decomposition,coalescence"));
+  CHECK(s.preprocessing_passes() ==
+        std::vector<PreprocessingPass>{PreprocessingPass::kDecomposition,
+                                       PreprocessingPass::kCoalescence});
+  CHECK_NOTHROW(
+      s.preprocessing_passes("coalescence,merge-common-args,distributivity,"
+                             "boolean-optimization,decomposition"));
+  CHECK(s.preprocessing_passes().size() == 5);
+
+  // Correct preprocessing policy.
+  CHECK(s.preprocessing_policy() == PreprocessingPolicy::kAll);
+  CHECK_NOTHROW(s.preprocessing_policy("auto"));
+  CHECK(s.preprocessing_policy() == PreprocessingPolicy::kAuto);
+  CHECK_NOTHROW(s.preprocessing_policy("all"));
+  CHECK(s.preprocessing_policy() == PreprocessingPolicy::kAll);
+
+  // Correct sampling strategies.
+  CHECK(s.sampling() == Sampling::kMonteCarlo);
+  CHECK_NOTHROW(s.sampling("lhs"));
+  CHECK(s.sampling() == Sampling::kLatinHypercube);
+  CHECK_NOTHROW(s.sampling("sobol"));
+  CHECK(s.sampling() == Sampling::kSobol);
+  CHECK_NOTHROW(s.sampling("mc"));
+  CHECK(s.sampling() == Sampling::kMonteCarlo);
+
   // Correct number of trials.
   CHECK_NOTHROW(s.num_trials(1));
   CHECK_NOTHROW(s.num_trials(1e6));
 
+  // Correct target precision.
+  CHECK_NOTHROW(s.target_precision(0));
+  CHECK_NOTHROW(s.target_precision(0.05));
+  CHECK(s.sequential_sampling());
+
+  // Correct time budget.
+  CHECK_NOTHROW(s.time_budget(0));
+  CHECK_NOTHROW(s.time_budget(60));
+
   // Correct number of quantiles.
   CHECK_NOTHROW(s.num_quantiles(1));
   CHECK_NOTHROW(s.num_quantiles(10));
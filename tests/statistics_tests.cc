@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "statistics.h"
+
+#include <cmath>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace scram::core::test {
+
+TEST_CASE("SampleSummaryTest.SmallSample", "[statistics]") {
+  SampleSummary summary;
+  for (double value : {4.0, 1.0, 3.0, 2.0})
+    summary.Add(value);
+  CHECK(summary.count() == 4);
+  CHECK(summary.mean() == Approx(2.5));
+  CHECK(summary.variance() == Approx(5.0 / 3));
+  CHECK(summary.min() == 1);
+  CHECK(summary.max() == 4);
+  CHECK(summary.Quantile(0) == 1);
+  CHECK(summary.Quantile(0.5) == Approx(2.5));
+  CHECK(summary.Quantile(1) == 4);
+  CHECK(summary.Cdf(0) == 0);
+  CHECK(summary.Cdf(2.5) == Approx(0.5));
+  CHECK(summary.Cdf(4) == 1);
+}
+
+TEST_CASE("SampleSummaryTest.ConstantSample", "[statistics]") {
+  SampleSummary summary;
+  for (int i = 0; i < 10; ++i)
+    summary.Add(0.5);
+  CHECK(summary.variance() == 0);
+  CHECK(summary.Quantile(0.3) == 0.5);
+  auto histogram = summary.Histogram(4);
+  REQUIRE(histogram.size() == 5);
+  CHECK(histogram.front().second == 1);
+  CHECK(histogram.back().first == 0.5);
+}
+
+TEST_CASE("SampleSummaryTest.LargeSample", "[statistics]") {
+  std::mt19937 rng(42);
+  std::lognormal_distribution<double> distribution(-5, 1);
+  std::vector<double> values;
+  SampleSummary summary;
+  for (int i = 0; i < 100000; ++i) {
+    values.push_back(distribution(rng));
+    summary.Add(values.back());
+  }
+  std::sort(values.begin(), values.end());
+  for (double p : {0.01, 0.05, 0.5, 0.95, 0.99}) {
+    INFO("p: " << p);
+    CHECK(summary.Quantile(p) ==
+          Approx(values[p * values.size()]).epsilon(0.01));
+  }
+  double sum_fractions = 0;
+  for (const auto& bin : summary.Histogram(20))
+    sum_fractions += bin.second;
+  CHECK(sum_fractions == Approx(1));
+}
+
+TEST_CASE("SampleSummaryTest.Merge", "[statistics]") {
+  std::mt19937 rng(42);
+  std::normal_distribution<double> distribution(10, 2);
+  SampleSummary whole;
+  SampleSummary parts[3];
+  for (int i = 0; i < 30000; ++i) {
+    double value = distribution(rng);
+    whole.Add(value);
+    parts[i % 3].Add(value);
+  }
+  SampleSummary merged;
+  for (const SampleSummary& part : parts)
+    merged.Merge(part);
+  CHECK(merged.count() == whole.count());
+  CHECK(merged.mean() == Approx(whole.mean()));
+  CHECK(merged.variance() == Approx(whole.variance()));
+  CHECK(merged.min() == whole.min());
+  CHECK(merged.max() == whole.max());
+  for (double p : {0.05, 0.5, 0.95}) {
+    INFO("p: " << p);
+    CHECK(merged.Quantile(p) == Approx(whole.Quantile(p)).epsilon(0.005));
+  }
+}
+
+}  // namespace scram::core::test
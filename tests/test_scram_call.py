@@ -76,6 +76,12 @@ def test_fta_no_prob(tmpdir):
         (["--mcub"], True),
         # Test the uncertainty
         (["--uncertainty", "--num-bins", "20", "--num-quantiles", "20"], True),
+        (["--uncertainty", "--raw-samples"], True),
+        (["--uncertainty", "--target-precision", "0.05"], True),
+        (["--uncertainty", "--target-precision", "-1"], False),
+        # Test the preprocessing without optimization passes
+        (["--preprocessing", ""], True),
+        (["--preprocessing", "coalescence,unknown"], False),
         # Test calls for prime implicants
         (["--prime-implicants", "--mocus"], False),
         (["--prime-implicants", "--rare-event"], False),
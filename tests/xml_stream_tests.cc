@@ -18,6 +18,8 @@
 #include "xml_stream.h"
 
 #include <fstream>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <sstream>
 
@@ -25,6 +27,10 @@
 
 #include <catch2/catch.hpp>
 
+#include <zlib.h>
+
+#include "xml.h"
+
 namespace fs = boost::filesystem;
 
 namespace scram::xml::test {
@@ -156,4 +162,71 @@ TEST_CASE("XmlStreamTest.Full", "[xml_stream]") {
   fs::remove(temp_file);
 }
 
+TEST_CASE("XmlStreamTest.Numbers", "[xml_stream]") {
+  fs::path unique_name = "scram_xml_test-" + fs::unique_path().string();
+  fs::path temp_file = fs::temp_directory_path() / unique_name;
+  INFO("XML temp file: " + temp_file.string());
+  std::string long_text(detail::FileStream::kBufferSize + 42, 'x');
+  const std::string content =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<root int=\"-2147483648\" size=\"18446744073709551615\" zero=\"0\""
+      " double=\"0.1\" small=\"1e-05\" precise=\"0.30000000000000004\">\n"
+      "  <text>" +
+      long_text + " &amp; " + long_text +
+      "</text>\n"
+      "</root>\n";
+  {
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> fp(
+        std::fopen(temp_file.string().c_str(), "w"), &std::fclose);
+    Stream xml_stream(fp.get());
+    StreamElement root = xml_stream.root("root");
+    root.SetAttribute("int", std::numeric_limits<int>::min())
+        .SetAttribute("size", std::numeric_limits<std::size_t>::max())
+        .SetAttribute("zero", 0)
+        .SetAttribute("double", 0.1)
+        .SetAttribute("small", 1e-5)
+        .SetAttribute("precise", 0.1 + 0.2);
+    root.AddChild("text").AddText(long_text + " & " + long_text);
+  }
+  std::stringstream str_stream;
+  str_stream << std::fstream(temp_file.string()).rdbuf();
+  CHECK(str_stream.str() == content);
+  fs::remove(temp_file);
+}
+
+TEST_CASE("XmlStreamTest.Gzip", "[xml_stream]") {
+  CHECK(CompressionFromPath("report.xml") == Compression::kNone);
+  CHECK(CompressionFromPath("report.xml.gz") == Compression::kGzip);
+  CHECK(CompressionFromPath("report.xml.zst") == Compression::kZstd);
+
+  fs::path unique_name = "scram_xml_test-" + fs::unique_path().string();
+  fs::path temp_file = fs::temp_directory_path() / unique_name;
+  temp_file += ".gz";
+  INFO("XML temp file: " + temp_file.string());
+  const int kNumChildren = 100000;  // Multiple chunks of the buffer.
+  {
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> fp(
+        std::fopen(temp_file.string().c_str(), "wb"), &std::fclose);
+    Stream xml_stream(fp.get(), true, Compression::kGzip);
+    StreamElement root = xml_stream.root("root");
+    for (int i = 0; i < kNumChildren; ++i)
+      root.AddChild("child").SetAttribute("number", i);
+  }
+  {
+    std::unique_ptr<std::remove_pointer_t<gzFile>, decltype(&gzclose)> file(
+        gzopen(temp_file.string().c_str(), "rb"), &gzclose);
+    REQUIRE(file);
+    std::string header = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    std::string content(header.size(), '\0');
+    REQUIRE(gzread(file.get(), content.data(), content.size()) ==
+            content.size());
+    CHECK(content == header);
+  }
+  Document document(temp_file.string());
+  CHECK(document.root().name() == "root");
+  auto children = document.root().children();
+  CHECK(std::distance(children.begin(), children.end()) == kNumChildren);
+  fs::remove(temp_file);
+}
+
 }  // namespace scram::xml::test